@@ -26,6 +26,9 @@
  * @page addr_address Representation of an email address
  *
  * Representation of an email address
+ *
+ * The personal and mailbox strings are kept in the @ref strpool, so they
+ * must not be changed in place.
  */
 
 #include "config.h"
@@ -260,12 +263,12 @@ static const char *parse_address(const char *s, char *token, size_t *tokenlen,
   }
 
   terminate_string(token, *tokenlen, tokenmax);
-  addr->mailbox = mutt_str_strdup(token);
+  addr->mailbox = mutt_strpool_get(token);
 
   if (*commentlen && !addr->personal)
   {
     terminate_string(comment, *commentlen, commentmax);
-    addr->personal = mutt_str_strdup(comment);
+    addr->personal = mutt_strpool_get(comment);
   }
 
   return s;
@@ -321,7 +324,7 @@ static const char *parse_route_addr(const char *s, char *comment, size_t *commen
   }
 
   if (!addr->mailbox)
-    addr->mailbox = mutt_str_strdup("@");
+    addr->mailbox = mutt_strpool_get("@");
 
   s++;
   return s;
@@ -384,7 +387,7 @@ static bool add_addrspec(struct AddressList *al, const char *phrase,
  */
 struct Address *mutt_addr_new(void)
 {
-  return mutt_mem_calloc(1, sizeof(struct Address));
+  return mutt_arena_calloc(sizeof(struct Address));
 }
 
 /**
@@ -398,8 +401,8 @@ struct Address *mutt_addr_new(void)
 struct Address *mutt_addr_create(const char *personal, const char *mailbox)
 {
   struct Address *a = mutt_addr_new();
-  a->personal = mutt_str_strdup(personal);
-  a->mailbox = mutt_str_strdup(mailbox);
+  a->personal = mutt_strpool_get(personal);
+  a->mailbox = mutt_strpool_get(mailbox);
   return a;
 }
 
@@ -488,7 +491,7 @@ int mutt_addrlist_parse(struct AddressList *al, const char *s)
           if (last && !last->personal)
           {
             terminate_buffer(comment, commentlen);
-            last->personal = mutt_str_strdup(comment);
+            last->personal = mutt_strpool_get(comment);
           }
         }
 
@@ -529,7 +532,7 @@ int mutt_addrlist_parse(struct AddressList *al, const char *s)
       {
         struct Address *a = mutt_addr_new();
         terminate_buffer(phrase, phraselen);
-        a->mailbox = mutt_str_strdup(phrase);
+        a->mailbox = mutt_strpool_get(phrase);
         a->group = true;
         mutt_addrlist_append(al, a);
         phraselen = 0;
@@ -542,7 +545,7 @@ int mutt_addrlist_parse(struct AddressList *al, const char *s)
       {
         struct Address *a = mutt_addr_new();
         terminate_buffer(phrase, phraselen);
-        a->personal = mutt_str_strdup(phrase);
+        a->personal = mutt_strpool_get(phrase);
         s = parse_route_addr(s + 1, comment, &commentlen, sizeof(comment) - 1, a);
         if (!s)
         {
@@ -594,7 +597,7 @@ int mutt_addrlist_parse(struct AddressList *al, const char *s)
     if (last && !last->personal)
     {
       terminate_buffer(comment, commentlen);
-      last->personal = mutt_str_strdup(comment);
+      last->personal = mutt_strpool_get(comment);
     }
   }
 
@@ -717,8 +720,8 @@ struct Address *mutt_addr_copy(const struct Address *addr)
 
   struct Address *p = mutt_addr_new();
 
-  p->personal = mutt_str_strdup(addr->personal);
-  p->mailbox = mutt_str_strdup(addr->mailbox);
+  p->personal = mutt_strpool_get(addr->personal);
+  p->mailbox = mutt_strpool_get(addr->mailbox);
   p->group = addr->group;
   p->is_intl = addr->is_intl;
   p->intl_checked = addr->intl_checked;
@@ -864,6 +867,8 @@ bool mutt_addr_cmp(const struct Address *a, const struct Address *b)
     return false;
   if (!a->mailbox || !b->mailbox)
     return false;
+  if (a->mailbox == b->mailbox)
+    return true;
   if (mutt_str_strcasecmp(a->mailbox, b->mailbox) != 0)
     return false;
   return true;
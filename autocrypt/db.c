@@ -154,6 +154,20 @@ void mutt_autocrypt_db_close(void)
   AutocryptDB = NULL;
 }
 
+/**
+ * lower_mailbox - Lowercase the mailbox of an Address
+ * @param a Address
+ *
+ * The mailbox may be shared in the string pool, so it's copied first.
+ */
+static void lower_mailbox(struct Address *a)
+{
+  char *lower = mutt_str_strdup(a->mailbox);
+  mutt_str_strlower(lower);
+  FREE(&a->mailbox);
+  a->mailbox = lower;
+}
+
 /**
  * mutt_autocrypt_db_normalize_addr - Normalise an Email Address
  * @param a Address to normalise
@@ -161,7 +175,7 @@ void mutt_autocrypt_db_close(void)
 void mutt_autocrypt_db_normalize_addr(struct Address *a)
 {
   mutt_addr_to_local(a);
-  mutt_str_strlower(a->mailbox);
+  lower_mailbox(a);
   mutt_addr_to_intl(a);
 }
 
@@ -176,7 +190,7 @@ void mutt_autocrypt_db_normalize_addrlist(struct AddressList *al)
   struct Address *np = NULL;
   TAILQ_FOREACH(np, al, entries)
   {
-    mutt_str_strlower(np->mailbox);
+    lower_mailbox(np);
   }
 
   mutt_addrlist_to_intl(al, NULL);
@@ -59,6 +59,7 @@
 #include "mutt_mailbox.h"
 #include "mutt_menu.h"
 #include "mutt_parse.h"
+#include "mutt_thread.h"
 #include "muttlib.h"
 #include "mx.h"
 #include "options.h"
@@ -159,8 +160,7 @@ static void process_protected_headers(struct Email *e)
   if (C_CryptProtectedHeadersRead && prot_headers && prot_headers->subject &&
       mutt_str_strcmp(e->env->subject, prot_headers->subject))
   {
-    if (Context->mailbox->subj_hash && e->env->real_subj)
-      mutt_hash_delete(Context->mailbox->subj_hash, e->env->real_subj, e);
+    mutt_subj_hash_remove(Context->mailbox, e);
 
     mutt_str_replace(&e->env->subject, prot_headers->subject);
     FREE(&e->env->disp_subj);
@@ -169,8 +169,7 @@ static void process_protected_headers(struct Email *e)
     else
       e->env->real_subj = e->env->subject;
 
-    if (Context->mailbox->subj_hash)
-      mutt_hash_insert(Context->mailbox->subj_hash, e->env->real_subj, e);
+    mutt_subj_hash_add(Context->mailbox, e);
 
     mx_save_hcache(Context->mailbox, e);
 
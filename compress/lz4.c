@@ -104,9 +104,9 @@ static void *compr_lz4_compress(void *cctx, const char *data, size_t dlen, size_
 /**
  * compr_lz4_decompress - Implements ComprOps::decompress()
  */
-static void *compr_lz4_decompress(void *cctx, const char *cbuf, size_t clen)
+static void *compr_lz4_decompress(void *cctx, const char *cbuf, size_t clen, size_t *dlen)
 {
-  if (!cctx)
+  if (!cctx || !dlen)
     return NULL;
 
   struct ComprLz4Ctx *ctx = cctx;
@@ -115,7 +115,10 @@ static void *compr_lz4_decompress(void *cctx, const char *cbuf, size_t clen)
   const unsigned char *cs = (const unsigned char *) cbuf;
   size_t ulen = cs[0] + (cs[1] << 8) + (cs[2] << 16) + ((size_t) cs[3] << 24);
   if (ulen == 0)
+  {
+    *dlen = 0;
     return (void *) cbuf;
+  }
 
   mutt_mem_realloc(&ctx->buf, ulen);
   void *ubuf = ctx->buf;
@@ -124,6 +127,7 @@ static void *compr_lz4_decompress(void *cctx, const char *cbuf, size_t clen)
   if (ret < 0)
     return NULL;
 
+  *dlen = ret;
   return ubuf;
 }
 
@@ -104,9 +104,9 @@ static void *compr_zlib_compress(void *cctx, const char *data, size_t dlen, size
 /**
  * compr_zlib_decompress - Implements ComprOps::decompress()
  */
-static void *compr_zlib_decompress(void *cctx, const char *cbuf, size_t clen)
+static void *compr_zlib_decompress(void *cctx, const char *cbuf, size_t clen, size_t *dlen)
 {
-  if (!cctx)
+  if (!cctx || !dlen)
     return NULL;
 
   struct ComprZlibCtx *ctx = cctx;
@@ -124,6 +124,7 @@ static void *compr_zlib_decompress(void *cctx, const char *cbuf, size_t clen)
   if (ret != Z_OK)
     return NULL;
 
+  *dlen = ulen;
   return ubuf;
 }
 
@@ -109,11 +109,11 @@ static void *compr_zstd_compress(void *cctx, const char *data, size_t dlen, size
 /**
  * compr_zstd_decompress - Implements ComprOps::decompress()
  */
-static void *compr_zstd_decompress(void *cctx, const char *cbuf, size_t clen)
+static void *compr_zstd_decompress(void *cctx, const char *cbuf, size_t clen, size_t *dlen)
 {
   struct ComprZstdCtx *ctx = cctx;
 
-  if (!cctx)
+  if (!cctx || !dlen)
     return NULL;
 
   unsigned long long len = ZSTD_getFrameContentSize(cbuf, clen);
@@ -129,6 +129,7 @@ static void *compr_zstd_decompress(void *cctx, const char *cbuf, size_t clen)
   if (ZSTD_isError(ret))
     return NULL; // LCOV_EXCL_LINE
 
+  *dlen = ret;
   return ctx->buf;
 }
 
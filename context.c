@@ -38,6 +38,7 @@
 #include "mx.h"
 #include "pattern.h"
 #include "score.h"
+#include "search_index.h"
 #include "sort.h"
 #include "ncrypt/lib.h"
 
@@ -59,6 +60,7 @@ void ctx_free(struct Context **ptr)
     notify_observer_remove(ctx->mailbox->notify, ctx_mailbox_observer, ctx);
 
   mutt_hash_free(&ctx->thread_hash);
+  search_index_free(&ctx->search_index);
   notify_free(&ctx->notify);
 
   FREE(ptr);
@@ -101,6 +103,9 @@ static void ctx_cleanup(struct Context *ctx)
  * @param ctx          Mailbox
  *
  * this routine is called to update the counts in the context structure
+ *
+ * If the Emails that were already in the tables are all still there, only the
+ * new ones are added and threaded.  Otherwise, everything is rebuilt.
  */
 void ctx_update(struct Context *ctx)
 {
@@ -109,8 +114,19 @@ void ctx_update(struct Context *ctx)
 
   struct Mailbox *m = ctx->mailbox;
 
-  mutt_hash_free(&m->subj_hash);
-  mutt_hash_free(&m->id_hash);
+  int known = 0;
+  for (int msgno = 0; msgno < m->msg_count; msgno++)
+  {
+    if (m->emails[msgno] && m->emails[msgno]->in_ctx)
+      known++;
+  }
+  const bool append = (ctx->msg_in_ctx > 0) && (known == ctx->msg_in_ctx);
+
+  if (!append)
+  {
+    mutt_hash_free(&m->subj_hash);
+    mutt_hash_free(&m->id_hash);
+  }
 
   /* reset counters */
   m->msg_unread = 0;
@@ -120,8 +136,10 @@ void ctx_update(struct Context *ctx)
   m->msg_tagged = 0;
   m->vcount = 0;
   m->changed = false;
+  ctx->msg_in_ctx = 0;
 
-  mutt_clear_threads(ctx);
+  if (!append)
+    mutt_clear_threads(ctx);
 
   struct Email *e = NULL;
   for (int msgno = 0; msgno < m->msg_count; msgno++)
@@ -130,7 +148,11 @@ void ctx_update(struct Context *ctx)
     if (!e)
       continue;
 
-    if (WithCrypto)
+    const bool is_new = !append || !e->in_ctx;
+    e->in_ctx = true;
+    ctx->msg_in_ctx++;
+
+    if (WithCrypto && is_new)
     {
       /* NOTE: this _must_ be done before the check for mailcap! */
       e->security = crypt_query(e->content);
@@ -147,31 +169,34 @@ void ctx_update(struct Context *ctx)
     }
     e->msgno = msgno;
 
-    if (e->env->supersedes)
+    /* Emails that were already in the tables don't need adding again */
+    if (is_new)
     {
-      struct Email *e2 = NULL;
-
-      if (!m->id_hash)
-        m->id_hash = mutt_make_id_hash(m);
-
-      e2 = mutt_hash_find(m->id_hash, e->env->supersedes);
-      if (e2)
+      if (e->env->supersedes)
       {
-        e2->superseded = true;
-        if (C_Score)
-          mutt_score_message(ctx->mailbox, e2, true);
+        struct Email *e2 = NULL;
+
+        if (!m->id_hash)
+          m->id_hash = mutt_make_id_hash(m);
+
+        e2 = mutt_hash_find(m->id_hash, e->env->supersedes);
+        if (e2)
+        {
+          e2->superseded = true;
+          if (C_Score)
+            mutt_score_message(ctx->mailbox, e2, true);
+        }
       }
-    }
 
-    /* add this message to the hash tables */
-    if (m->id_hash && e->env->message_id)
-      mutt_hash_insert(m->id_hash, e->env->message_id, e);
-    if (m->subj_hash && e->env->real_subj)
-      mutt_hash_insert(m->subj_hash, e->env->real_subj, e);
-    mutt_label_hash_add(m, e);
+      /* add this message to the hash tables */
+      if (m->id_hash && e->env->message_id)
+        mutt_hash_insert(m->id_hash, e->env->message_id, e);
+      mutt_subj_hash_add(m, e);
+      mutt_label_hash_add(m, e);
 
-    if (C_Score)
-      mutt_score_message(ctx->mailbox, e, false);
+      if (C_Score)
+        mutt_score_message(ctx->mailbox, e, false);
+    }
 
     if (e->changed)
       m->changed = true;
@@ -189,7 +214,7 @@ void ctx_update(struct Context *ctx)
     }
   }
 
-  mutt_sort_headers(ctx, true); /* rethread from scratch */
+  mutt_sort_headers(ctx, !append); /* rethread from scratch, if necessary */
 }
 
 /**
@@ -215,6 +240,7 @@ void ctx_update_tables(struct Context *ctx, bool committing)
   m->msg_unread = 0;
   m->changed = false;
   m->msg_flagged = 0;
+  ctx->msg_in_ctx = 0;
   padding = mx_msg_padding_size(m);
   for (i = 0, j = 0; i < m->msg_count; i++)
   {
@@ -230,6 +256,8 @@ void ctx_update_tables(struct Context *ctx, bool committing)
         m->emails[i] = NULL;
       }
       m->emails[j]->msgno = j;
+      if (m->emails[j]->in_ctx)
+        ctx->msg_in_ctx++;
       if (m->emails[j]->vnum != -1)
       {
         m->v2r[m->vcount] = j;
@@ -273,8 +301,7 @@ void ctx_update_tables(struct Context *ctx, bool committing)
         mailbox_size_sub(m, m->emails[i]);
       }
       /* remove message from the hash tables */
-      if (m->subj_hash && m->emails[i]->env->real_subj)
-        mutt_hash_delete(m->subj_hash, m->emails[i]->env->real_subj, m->emails[i]);
+      mutt_subj_hash_remove(m, m->emails[i]);
       if (m->id_hash && m->emails[i]->env->message_id)
         mutt_hash_delete(m->id_hash, m->emails[i]->env->message_id, m->emails[i]);
       mutt_label_hash_remove(m, m->emails[i]);
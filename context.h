@@ -30,6 +30,7 @@ struct Email;
 struct EmailList;
 struct Mailbox;
 struct NotifyCallback;
+struct SearchIndex;
 
 /**
  * struct Context - The "current" mailbox
@@ -42,7 +43,9 @@ struct Context
   struct Email *last_tag;            ///< Last tagged msg (used to link threads)
   struct MuttThread *tree;           ///< Top of thread tree
   struct Hash *thread_hash;          ///< Hash table for threading
+  struct SearchIndex *search_index;  ///< Text of searched messages, see $search_index
   int msg_not_read_yet;              ///< Which msg "new" in pager, -1 if none
+  int msg_in_ctx;                    ///< Number of Emails added to the tables by ctx_update()
 
   struct Menu *menu;                 ///< Needed for pattern compilation
 
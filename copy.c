@@ -516,8 +516,8 @@ int mutt_copy_header(FILE *fp_in, struct Email *e, FILE *fp_out,
   if ((chflags & CH_UPDATE_SUBJECT) && e->env->subject)
   {
     temp_hdr = e->env->subject;
-    /* env->subject is directly referenced in Context->subj_hash, so we
-     * have to be careful not to encode (and thus free) that memory. */
+    /* env->subject is still referenced by the Email, so we have to be
+     * careful not to encode (and thus free) that memory. */
     if (!(chflags & CH_DECODE))
     {
       temp_hdr = mutt_str_strdup(temp_hdr);
@@ -1098,7 +1098,11 @@ static int address_header_decode(char **h)
   {
     if (a->personal)
     {
-      mutt_str_dequote_comment(a->personal);
+      /* The string is shared, so dequote a copy */
+      char *personal = mutt_str_strdup(a->personal);
+      mutt_str_dequote_comment(personal);
+      FREE(&a->personal);
+      a->personal = personal;
     }
   }
 
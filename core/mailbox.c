@@ -75,6 +75,7 @@ void mailbox_free(struct Mailbox **ptr)
   FREE(&m->realpath);
   FREE(&m->emails);
   FREE(&m->v2r);
+  mutt_arena_free(&m->arena);
   notify_free(&m->notify);
 
   FREE(ptr);
@@ -127,6 +127,7 @@ struct Mailbox
   struct Hash *id_hash;               ///< Hash table by msg id
   struct Hash *subj_hash;             ///< Hash table by subject
   struct Hash *label_hash;            ///< Hash table for x-labels
+  struct Arena *arena;                ///< Bulk storage for the Emails
 
   struct Account *account;            ///< Account that owns this Mailbox
   int opened;                         ///< Number of times mailbox is opened
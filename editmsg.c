@@ -45,6 +45,7 @@
 #include "muttlib.h"
 #include "mx.h"
 #include "protos.h"
+#include "search_index.h"
 
 /**
  * ev_message - Edit an email or view it in an external editor
@@ -235,6 +236,9 @@ bail:
 
   if (rc == 0)
   {
+    if (Context && (Context->mailbox == m))
+      search_index_forget(Context->search_index, m, e);
+
     mutt_set_flag(m, e, MUTT_DELETE, true);
     mutt_set_flag(m, e, MUTT_PURGE, true);
     mutt_set_flag(m, e, MUTT_READ, true);
@@ -42,7 +42,7 @@
  */
 struct Body *mutt_body_new(void)
 {
-  struct Body *p = mutt_mem_calloc(1, sizeof(struct Body));
+  struct Body *p = mutt_arena_calloc(sizeof(struct Body));
 
   p->disposition = DISP_ATTACH;
   p->use_disp = true;
@@ -67,7 +67,7 @@ void email_free(struct Email **ptr)
  */
 struct Email *email_new(void)
 {
-  struct Email *e = mutt_mem_calloc(1, sizeof(struct Email));
+  struct Email *e = mutt_arena_calloc(sizeof(struct Email));
 #ifdef MIXMASTER
   STAILQ_INIT(&e->chain);
 #endif
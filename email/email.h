@@ -58,6 +58,7 @@ struct Email
   bool recip_valid     : 1;    ///< Is_recipient is valid
   bool active          : 1;    ///< Message is not to be removed
   bool trash           : 1;    ///< Message is marked as trashed on disk (used by the maildir_trash option)
+  bool in_ctx          : 1;    ///< Email has been added to the Context's tables
 
   // timezone of the sender of this message
   unsigned int zhours   : 5;   ///< Hours away from UTC
@@ -41,7 +41,7 @@
  */
 struct Envelope *mutt_env_new(void)
 {
-  struct Envelope *e = mutt_mem_calloc(1, sizeof(struct Envelope));
+  struct Envelope *e = mutt_arena_calloc(sizeof(struct Envelope));
   TAILQ_INIT(&e->return_path);
   TAILQ_INIT(&e->from);
   TAILQ_INIT(&e->to);
@@ -137,9 +137,34 @@ void mutt_env_free(struct Envelope **ptr)
   mutt_autocrypthdr_free(&env->autocrypt_gossip);
 #endif
 
+  FREE(&env->lazy_data);
+
   FREE(ptr);
 }
 
+/**
+ * mutt_env_load - Restore any fields that were deferred by the header cache
+ * @param env Envelope
+ *
+ * To speed up opening a mailbox, the header cache only restores the fields
+ * needed to draw the index.  Rarely used fields (e.g. Return-Path, Sender,
+ * Mail-Followup-To) are kept encoded until this function is called.
+ *
+ * Call this before using any of those fields.  It's cheap if there's nothing
+ * to do.
+ */
+void mutt_env_load(struct Envelope *env)
+{
+  if (!env || !env->lazy_data)
+    return;
+
+  if (env->lazy_load)
+    env->lazy_load(env);
+
+  FREE(&env->lazy_data);
+  env->lazy_load = NULL;
+}
+
 /**
  * mutt_env_merge - Merge the headers of two Envelopes
  * @param[in]  base  Envelope destination for all the headers
@@ -153,6 +178,9 @@ void mutt_env_merge(struct Envelope *base, struct Envelope **extra)
   if (!base || !extra || !*extra)
     return;
 
+  mutt_env_load(base);
+  mutt_env_load(*extra);
+
 /* copies each existing element if necessary, and sets the element
  * to NULL in the source so that mutt_env_free doesn't leave us
  * with dangling pointers. */
@@ -242,6 +270,10 @@ bool mutt_env_cmp_strict(const struct Envelope *e1, const struct Envelope *e2)
 {
   if (e1 && e2)
   {
+    /* Restoring the deferred fields doesn't change the Envelope's meaning */
+    mutt_env_load((struct Envelope *) e1);
+    mutt_env_load((struct Envelope *) e2);
+
     if ((mutt_str_strcmp(e1->message_id, e2->message_id) != 0) ||
         (mutt_str_strcmp(e1->subject, e2->subject) != 0) ||
         !mutt_list_compare(&e1->references, &e2->references) ||
@@ -273,6 +305,7 @@ void mutt_env_to_local(struct Envelope *env)
   if (!env)
     return;
 
+  mutt_env_load(env);
   mutt_addrlist_to_local(&env->return_path);
   mutt_addrlist_to_local(&env->from);
   mutt_addrlist_to_local(&env->to);
@@ -311,6 +344,7 @@ int mutt_env_to_intl(struct Envelope *env, const char **tag, char **err)
   if (!env)
     return 1;
 
+  mutt_env_load(env);
   int e = 0;
   H_TO_INTL(return_path);
   H_TO_INTL(from);
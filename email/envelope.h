@@ -86,10 +86,13 @@ struct Envelope
   struct AutocryptHeader *autocrypt_gossip;
 #endif
   unsigned char changed;               ///< Changed fields, e.g. #MUTT_ENV_CHANGED_SUBJECT
+  void *lazy_data;                     ///< Encoded fields that haven't been restored yet
+  void (*lazy_load)(struct Envelope *env); ///< Restore the fields in Envelope.lazy_data
 };
 
 bool             mutt_env_cmp_strict(const struct Envelope *e1, const struct Envelope *e2);
 void             mutt_env_free      (struct Envelope **ptr);
+void             mutt_env_load      (struct Envelope *env);
 void             mutt_env_merge     (struct Envelope *base, struct Envelope **extra);
 struct Envelope *mutt_env_new       (void);
 int              mutt_env_to_intl   (struct Envelope *env, const char **tag, char **err);
@@ -750,6 +750,21 @@ void rfc2047_encode_addrlist(struct AddressList *al, const char *tag)
   }
 }
 
+/**
+ * decode_pooled - Decode a string that may be in the string pool
+ * @param[in,out] pd String to decode
+ *
+ * rfc2047_decode() works in place, so a shared string must be copied first.
+ */
+static void decode_pooled(char **pd)
+{
+  char *tmp = mutt_str_strdup(*pd);
+  rfc2047_decode(&tmp);
+  FREE(pd);
+  *pd = mutt_strpool_get(tmp);
+  FREE(&tmp);
+}
+
 /**
  * rfc2047_decode_addrlist - Decode any RFC2047 headers in an Address list
  * @param al AddressList
@@ -764,10 +779,10 @@ void rfc2047_decode_addrlist(struct AddressList *al)
   {
     if (a->personal && ((strstr(a->personal, "=?")) || C_AssumedCharset))
     {
-      rfc2047_decode(&a->personal);
+      decode_pooled(&a->personal);
     }
     else if (a->group && a->mailbox && strstr(a->mailbox, "=?"))
-      rfc2047_decode(&a->mailbox);
+      decode_pooled(&a->mailbox);
   }
 }
 
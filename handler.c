@@ -180,7 +180,7 @@ static void decode_xbit(struct State *s, long len, bool istext, iconv_t cd)
   int c;
   char bufi[BUFI_SIZE];
   size_t l = 0;
-  while (((c = fgetc(s->fp_in)) != EOF) && len--)
+  while (!s->stop && ((c = fgetc(s->fp_in)) != EOF) && len--)
   {
     if ((c == '\r') && len)
     {
@@ -314,7 +314,7 @@ static void decode_quoted(struct State *s, long len, bool istext, iconv_t cd)
   if (istext)
     state_set_prefix(s);
 
-  while (len > 0)
+  while ((len > 0) && !s->stop)
   {
     /* It's ok to use a fixed size buffer for input, even if the line turns
      * out to be longer than this.  Just process the line in chunks.  This
@@ -386,7 +386,7 @@ static void decode_uuencoded(struct State *s, long len, bool istext, iconv_t cd)
     if (mutt_str_startswith(tmps, "begin ", CASE_MATCH))
       break;
   }
-  while (len > 0)
+  while ((len > 0) && !s->stop)
   {
     if (!fgets(tmps, sizeof(tmps), s->fp_in))
       return;
@@ -476,18 +476,22 @@ static bool is_mmnoask(const char *buf)
 
 /**
  * is_autoview - Should email body be filtered by mailcap
- * @param b Body of the email
+ * @param b     Body of the email
+ * @param flags Flags, e.g. #MUTT_SEARCHING
  * @retval 1 body part should be filtered by a mailcap entry prior to viewing inline
  * @retval 0 otherwise
+ *
+ * When searching, $implicit_autoview only applies to text parts.
+ * Other types must be listed explicitly with auto_view.
  */
-static bool is_autoview(struct Body *b)
+static bool is_autoview(struct Body *b, StateFlags flags)
 {
   char type[256];
   bool is_av = false;
 
   snprintf(type, sizeof(type), "%s/%s", TYPE(b), b->subtype);
 
-  if (C_ImplicitAutoview)
+  if (C_ImplicitAutoview && (!(flags & MUTT_SEARCHING) || (b->type == TYPE_TEXT)))
   {
     /* $implicit_autoview is essentially the same as "auto_view *" */
     is_av = true;
@@ -675,7 +679,7 @@ static int text_plain_handler(struct Body *b, struct State *s)
   char *buf = NULL;
   size_t sz = 0;
 
-  while ((buf = mutt_file_read_line(buf, &sz, s->fp_in, NULL, 0)))
+  while (!s->stop && (buf = mutt_file_read_line(buf, &sz, s->fp_in, NULL, 0)))
   {
     if ((mutt_str_strcmp(buf, "-- ") != 0) && C_TextFlowed)
     {
@@ -994,7 +998,7 @@ static int alternative_handler(struct Body *a, struct State *s)
       b = a;
     while (b)
     {
-      if (is_autoview(b))
+      if (is_autoview(b, s->flags))
         choice = b;
       b = b->next;
     }
@@ -1246,6 +1250,8 @@ static int multipart_handler(struct Body *a, struct State *s)
     }
 
     rc = mutt_body_handler(p, s);
+    if (s->stop)
+      break;
     state_putc(s, '\n');
 
     if (rc != 0)
@@ -1496,7 +1502,7 @@ void mutt_decode_base64(struct State *s, size_t len, bool istext, iconv_t cd)
   if (istext)
     state_set_prefix(s);
 
-  while (len > 0)
+  while ((len > 0) && !s->stop)
   {
     for (i = 0; (i < 4) && (len > 0); len--)
     {
@@ -1587,6 +1593,9 @@ int mutt_body_handler(struct Body *b, struct State *s)
   if (!b || !s)
     return -1;
 
+  if (s->stop)
+    return 0;
+
   bool plaintext = false;
   handler_t handler = NULL;
   handler_t encrypted_handler = NULL;
@@ -1604,7 +1613,7 @@ int mutt_body_handler(struct Body *b, struct State *s)
 
   /* first determine which handler to use to process this part */
 
-  if (is_autoview(b))
+  if (is_autoview(b, s->flags))
   {
     handler = autoview_handler;
     s->flags &= ~MUTT_CHARCONV;
@@ -1626,6 +1635,11 @@ int mutt_body_handler(struct Body *b, struct State *s)
       {
         handler = rfc3676_handler;
       }
+      else if ((s->flags & MUTT_SEARCHING) && !C_TextFlowed)
+      {
+        /* decode straight to the search, so it can stop early */
+        plaintext = true;
+      }
       else
       {
         handler = text_plain_handler;
@@ -1796,7 +1810,7 @@ cleanup:
  */
 bool mutt_can_decode(struct Body *a)
 {
-  if (is_autoview(a))
+  if (is_autoview(a, MUTT_STATE_NO_FLAGS))
     return true;
   if (a->type == TYPE_TEXT)
     return true;
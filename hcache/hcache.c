@@ -90,92 +90,46 @@ static size_t header_size(void)
  * @retval ptr Binary blob representing the Email
  *
  * This function transforms an Email into a binary string so that it can be
- * saved to a database.
+ * saved to a database.  The uidvalidity and crc are followed by a
+ * self-describing record, see serial_dump_email().
  */
 static void *dump(header_cache_t *hc, const struct Email *e, int *off, uint32_t uidvalidity)
 {
-  struct Email e_dump;
-  bool convert = !CharsetIsUtf8;
+  size_t rlen = 0;
+  unsigned char *rec = serial_dump_email(e, &rlen, !CharsetIsUtf8);
 
   *off = 0;
-  unsigned char *d = mutt_mem_malloc(4096);
+  unsigned char *d = mutt_mem_malloc(header_size() + rlen);
 
   d = serial_dump_uint32_t((uidvalidity != 0) ? uidvalidity : mutt_date_epoch(), d, off);
   d = serial_dump_int(hc->crc, d, off);
 
   assert(*off == header_size());
 
-  lazy_realloc(&d, *off + sizeof(struct Email));
-  memcpy(&e_dump, e, sizeof(struct Email));
-
-  /* some fields are not safe to cache */
-  e_dump.tagged = false;
-  e_dump.changed = false;
-  e_dump.threaded = false;
-  e_dump.recip_valid = false;
-  e_dump.searched = false;
-  e_dump.matched = false;
-  e_dump.collapsed = false;
-  e_dump.limited = false;
-  e_dump.num_hidden = 0;
-  e_dump.recipient = 0;
-  e_dump.pair = 0;
-  e_dump.attach_valid = false;
-  e_dump.path = NULL;
-  e_dump.tree = NULL;
-  e_dump.thread = NULL;
-  STAILQ_INIT(&e_dump.tags);
-#ifdef MIXMASTER
-  STAILQ_INIT(&e_dump.chain);
-#endif
-  e_dump.edata = NULL;
-
-  memcpy(d + *off, &e_dump, sizeof(struct Email));
-  *off += sizeof(struct Email);
-
-  d = serial_dump_envelope(e_dump.env, d, off, convert);
-  d = serial_dump_body(e_dump.content, d, off, convert);
-  d = serial_dump_char(e_dump.maildir_flags, d, off, convert);
+  memcpy(d + *off, rec, rlen);
+  *off += rlen;
+  FREE(&rec);
 
   return d;
 }
 
 /**
  * restore - Restore an Email from data retrieved from the cache
- * @param d Data retrieved using mutt_hcache_dump
- * @retval ptr Success, the restored header (can't be NULL)
+ * @param d   Record, following the uidvalidity and crc
+ * @param len Length of the data
+ * @retval ptr  Success, the restored header
+ * @retval NULL The record is corrupt, or from an incompatible version
+ *
+ * Rarely used Envelope fields are restored on demand, see mutt_env_load().
  *
  * @note The returned Email must be free'd by caller code with
  *       email_free()
  */
-static struct Email *restore(const unsigned char *d)
+static struct Email *restore(const unsigned char *d, size_t len)
 {
-  int off = 0;
-  struct Email *e = email_new();
-  bool convert = !CharsetIsUtf8;
-
-  /* skip validate */
-  off += sizeof(uint32_t);
-
-  /* skip crc */
-  off += sizeof(unsigned int);
-
-  memcpy(e, d + off, sizeof(struct Email));
-  off += sizeof(struct Email);
-
-  STAILQ_INIT(&e->tags);
-#ifdef MIXMASTER
-  STAILQ_INIT(&e->chain);
-#endif
-
-  e->env = mutt_env_new();
-  serial_restore_envelope(e->env, d, &off, convert);
-
-  e->content = mutt_body_new();
-  serial_restore_body(e->content, d, &off, convert);
-
-  serial_restore_char(&e->maildir_flags, d, &off, convert);
-
+  struct Email *e = serial_restore_email(d, len, !CharsetIsUtf8, true);
+  if (!e)
+    mutt_debug(LL_DEBUG2, "Can't decode cache record\n");
   return e;
 }
 
@@ -427,6 +381,12 @@ void mutt_hcache_close(header_cache_t *hc)
   if (!hc || !ops)
     return;
 
+  if (hc->batch > 0)
+  {
+    hc->batch = 1;
+    mutt_hcache_commit(hc);
+  }
+
 #ifdef USE_HCACHE_COMPRESSION
   if (C_HeaderCacheCompressMethod)
     compr_get_ops()->close(&hc->cctx);
@@ -437,6 +397,46 @@ void mutt_hcache_close(header_cache_t *hc)
   FREE(&hc);
 }
 
+/**
+ * mutt_hcache_begin - Multiplexor for StoreOps::begin
+ */
+int mutt_hcache_begin(header_cache_t *hc)
+{
+  const struct StoreOps *ops = hcache_get_ops();
+  if (!hc || !ops)
+    return -1;
+
+  if (hc->batch++ > 0)
+    return 0;
+
+  int rc = ops->begin(hc->ctx);
+  if (rc != 0)
+  {
+    /* Carry on without a transaction */
+    mutt_debug(LL_DEBUG2, "Can't start a batch: %d\n", rc);
+    hc->batch = 0;
+  }
+  return rc;
+}
+
+/**
+ * mutt_hcache_commit - Multiplexor for StoreOps::commit
+ */
+int mutt_hcache_commit(header_cache_t *hc)
+{
+  const struct StoreOps *ops = hcache_get_ops();
+  if (!hc || !ops)
+    return -1;
+
+  if ((hc->batch == 0) || (--hc->batch > 0))
+    return 0;
+
+  int rc = ops->commit(hc->ctx);
+  if (rc != 0)
+    mutt_debug(LL_DEBUG2, "Can't commit a batch: %d\n", rc);
+  return rc;
+}
+
 /**
  * mutt_hcache_fetch - Multiplexor for StoreOps::fetch
  */
@@ -470,16 +470,18 @@ struct HCacheEntry mutt_hcache_fetch(header_cache_t *hc, const char *key,
   {
     const struct ComprOps *cops = compr_get_ops();
 
-    void *dblob = cops->decompress(hc->cctx, (char *) data + hlen, dlen - hlen);
+    size_t ulen = 0;
+    void *dblob = cops->decompress(hc->cctx, (char *) data + hlen, dlen - hlen, &ulen);
     if (!dblob)
     {
       goto end;
     }
-    data = (char *) dblob - hlen; /* restore skips uidvalidity and crc */
+    entry.email = restore(dblob, ulen);
+    goto end;
   }
 #endif
 
-  entry.email = restore(data);
+  entry.email = restore((unsigned char *) data + hlen, dlen - hlen);
 
 end:
   mutt_hcache_free_raw(hc, &to_free);
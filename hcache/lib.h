@@ -42,18 +42,18 @@
  * @sa Address Body Buffer Email Envelope ListNode Parameter
  *
  * To save the data, the Header Cache uses a set of 'dump' functions
- * (\ref hc_serial) to 'serialise' the structures.  The cache also stores a CRC
- * checksum of the C structs that were used.  When retrieving the data, the
+ * (\ref hc_serial) to 'serialise' the structures into self-describing records.
+ * Each field is tagged, so fields can be added, or the C structs changed,
+ * without invalidating existing cached data.  When retrieving the data, the
  * Header Cache uses a set of 'restore' functions to turn the data back into
- * structs.
+ * structs.  Records that can't be decoded are treated as cache misses.
  *
- * The CRC checksum is created by `hcache/hcachever.sh` during the build
- * process.  Whenever the definition of any of the structs changes, the CRC will
- * change, invalidating any existing cached data.
+ * The cache also stores a CRC made from `BASEVERSION` in
+ * `hcache/hcachever.sh` and the user's spam config.
  *
- * @note Adding or removing a field from the set of serialised fields will
- * **not** affect the CRC.  In this case, it is vital that you bump the
- * **`BASEVERSION`** variable in `hcache/hcachever.sh`
+ * @note If the meaning of an existing field changes, it is vital that you bump
+ * the **`BASEVERSION`** variable in `hcache/hcachever.sh`, or
+ * #SERIAL_FORMAT in `hcache/serialize.h`.
  *
  * ## Source
  *
@@ -87,6 +87,7 @@ struct EmailCache
   unsigned int crc;
   void *ctx;
   void *cctx;
+  int batch; ///< Nesting depth of mutt_hcache_begin()
 };
 
 typedef struct EmailCache header_cache_t;
@@ -97,7 +98,7 @@ typedef struct EmailCache header_cache_t;
 struct HCacheEntry
 {
   uint32_t uidvalidity; ///< IMAP-specific UIDVALIDITY
-  unsigned int crc;     ///< CRC of Email/Body/etc structs
+  unsigned int crc;     ///< CRC of the cache version and spam config
   struct Email *email;  ///< Retrieved email
 };
 
@@ -130,6 +131,28 @@ header_cache_t *mutt_hcache_open(const char *path, const char *folder, hcache_na
  */
 void mutt_hcache_close(header_cache_t *hc);
 
+/**
+ * mutt_hcache_begin - start a batch of writes
+ * @param hc Pointer to the header_cache_t structure got by mutt_hcache_open()
+ * @retval 0   Success
+ * @retval num Generic or backend-specific error code otherwise
+ *
+ * Stores and deletes up to the matching mutt_hcache_commit() may be grouped
+ * into a single backend transaction.  Batches may be nested; only the
+ * outermost pair has any effect.
+ */
+int mutt_hcache_begin(header_cache_t *hc);
+
+/**
+ * mutt_hcache_commit - finish a batch of writes
+ * @param hc Pointer to the header_cache_t structure got by mutt_hcache_open()
+ * @retval 0   Success
+ * @retval num Generic or backend-specific error code otherwise
+ *
+ * @note mutt_hcache_close() will commit any unfinished batch.
+ */
+int mutt_hcache_commit(header_cache_t *hc);
+
 /**
  * mutt_hcache_store - store a Header along with a validity datum
  * @param hc          Pointer to the header_cache_t structure got by mutt_hcache_open()
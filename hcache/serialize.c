@@ -27,10 +27,31 @@
  * @page hc_serial Email-object serialiser
  *
  * Email-object serialiser
+ *
+ * Each Email is stored as a self-describing record:
+ *
+ * | Item        | Encoding                                         |
+ * | :---------- | :----------------------------------------------- |
+ * | format      | varint, #SERIAL_FORMAT                           |
+ * | length      | varint, length of the rest of the record         |
+ * | num_strings | varint                                           |
+ * | strings     | num_strings * (varint length, bytes)             |
+ * | fields      | varint length, then a block of Email fields      |
+ *
+ * A block is a sequence of fields.  Each field starts with a varint tag,
+ * `(field << 2) | wire`, followed by its value (see #SerialWire).
+ * Strings are stored once in the record's string table and referenced by
+ * index, so repeated values (e.g. addresses, Message-IDs) cost one varint.
+ *
+ * Fields with a zero value are usually omitted.  Readers skip any fields
+ * they don't recognise, so new fields can be added without invalidating
+ * existing caches, and callers can decode just the fields they need.
  */
 
 #include "config.h"
 #include <stdbool.h>
+#include <limits.h>
+#include <stdint.h>
 #include <string.h>
 #include <sys/types.h>
 #include "mutt/lib.h"
@@ -112,467 +133,1367 @@ void serial_restore_uint32_t(uint32_t *s, const unsigned char *d, int *off)
 }
 
 /**
- * serial_dump_char_size - Pack a fixed-length string into a binary blob
- * @param c       String to pack
- * @param d       Binary blob to add to
- * @param size    Size of the string
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted to utf-8
- * @retval ptr End of the newly packed binary
+ * struct SerialBuf - Growable output buffer
+ */
+struct SerialBuf
+{
+  unsigned char *data; ///< Bytes written so far
+  size_t len;          ///< Number of bytes used
+  size_t size;         ///< Number of bytes allocated
+};
+
+/**
+ * struct SerialWriter - State for serialising one record
+ */
+struct SerialWriter
+{
+  struct SerialBuf strings; ///< Encoded string table
+  size_t num_strings;       ///< Number of strings in the table
+  struct Hash *dedup;       ///< String -> table index + 1
+  bool convert;             ///< Convert strings to utf-8
+};
+
+/**
+ * enum SerialShare - How a restored string may be shared
  */
-unsigned char *serial_dump_char_size(char *c, ssize_t size, unsigned char *d,
-                                     int *off, bool convert)
+enum SerialShare
 {
-  char *p = c;
+  SHARE_NONE,  ///< Private copy
+  SHARE_ARENA, ///< Shared with the same strings in the current Arena
+  SHARE_POOL,  ///< Shared with the same strings in the string pool
+};
 
-  if (!c)
+/**
+ * buf_append - Add some bytes to a SerialBuf
+ * @param sb  Buffer to add to
+ * @param src Bytes to add
+ * @param len Number of bytes
+ */
+static void buf_append(struct SerialBuf *sb, const void *src, size_t len)
+{
+  if ((sb->len + len) > sb->size)
   {
-    size = 0;
-    d = serial_dump_int(size, d, off);
-    return d;
+    size_t size = MAX(sb->size * 2, 256);
+    while (size < (sb->len + len))
+      size *= 2;
+    mutt_mem_realloc(&sb->data, size);
+    sb->size = size;
   }
 
-  if (convert && !mutt_str_is_ascii(c, size))
+  if (len > 0)
+    memcpy(sb->data + sb->len, src, len);
+  sb->len += len;
+}
+
+/**
+ * put_varint - Add an unsigned varint to a SerialBuf
+ * @param sb  Buffer to add to
+ * @param val Number to add
+ */
+static void put_varint(struct SerialBuf *sb, uint64_t val)
+{
+  unsigned char tmp[10];
+  size_t len = 0;
+
+  do
   {
-    p = mutt_str_substr_dup(c, c + size);
-    if (mutt_ch_convert_string(&p, C_Charset, "utf-8", 0) == 0)
-    {
-      size = mutt_str_strlen(p) + 1;
-    }
-  }
+    tmp[len] = val & 0x7f;
+    val >>= 7;
+    if (val)
+      tmp[len] |= 0x80;
+    len++;
+  } while (val);
+
+  buf_append(sb, tmp, len);
+}
+
+/**
+ * put_tag - Add a field tag to a SerialBuf
+ * @param sb    Buffer to add to
+ * @param field Field number
+ * @param wire  Encoding of the field's value
+ */
+static void put_tag(struct SerialBuf *sb, unsigned int field, enum SerialWire wire)
+{
+  put_varint(sb, ((uint64_t) field << 2) | wire);
+}
 
-  d = serial_dump_int(size, d, off);
-  lazy_realloc(&d, *off + size);
-  memcpy(d + *off, p, size);
-  *off += size;
+/**
+ * put_uint - Add an unsigned number field, unless it's zero
+ * @param sb    Buffer to add to
+ * @param field Field number
+ * @param val   Value of the field
+ */
+static void put_uint(struct SerialBuf *sb, unsigned int field, uint64_t val)
+{
+  if (val == 0)
+    return;
 
-  if (p != c)
-    FREE(&p);
+  put_tag(sb, field, SW_VARINT);
+  put_varint(sb, val);
+}
 
-  return d;
+/**
+ * put_sint - Add a signed number field, unless it's zero
+ * @param sb    Buffer to add to
+ * @param field Field number
+ * @param val   Value of the field
+ *
+ * The number is zig-zag encoded, so small negative numbers stay small.
+ */
+static void put_sint(struct SerialBuf *sb, unsigned int field, int64_t val)
+{
+  put_uint(sb, field, ((uint64_t) val << 1) ^ (uint64_t)(val >> 63));
 }
 
 /**
- * serial_dump_char - Pack a variable-length string into a binary blob
- * @param c       String to pack
- * @param d       Binary blob to add to
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted to utf-8
- * @retval ptr End of the newly packed binary
+ * put_block - Add a nested block field
+ * @param sb    Buffer to add to
+ * @param field Field number
+ * @param block Contents of the block (will be freed)
  */
-unsigned char *serial_dump_char(char *c, unsigned char *d, int *off, bool convert)
+static void put_block(struct SerialBuf *sb, unsigned int field, struct SerialBuf *block)
 {
-  return serial_dump_char_size(c, mutt_str_strlen(c) + 1, d, off, convert);
+  put_tag(sb, field, SW_BLOCK);
+  put_varint(sb, block->len);
+  buf_append(sb, block->data, block->len);
+  FREE(&block->data);
+  block->len = 0;
+  block->size = 0;
 }
 
 /**
- * serial_restore_char - Unpack a variable-length string from a binary blob
- * @param[out] c       Store the unpacked string here
- * @param[in]  d       Binary blob to read from
- * @param[out] off     Offset into the blob
- * @param[in]  convert If true, the strings will be converted to utf-8
+ * string_index - Find (or add) a string in the record's string table
+ * @param w       Record writer
+ * @param str     String
+ * @param convert If true, the string will be converted to utf-8
+ * @retval num Index of the string, plus one
  */
-void serial_restore_char(char **c, const unsigned char *d, int *off, bool convert)
+static size_t string_index(struct SerialWriter *w, const char *str, bool convert)
 {
-  unsigned int size;
-  serial_restore_int(&size, d, off);
+  char *conv = NULL;
 
-  if (size == 0)
+  if (convert && !mutt_str_is_ascii(str, mutt_str_strlen(str)))
   {
-    *c = NULL;
-    return;
+    conv = mutt_str_strdup(str);
+    if (mutt_ch_convert_string(&conv, C_Charset, "utf-8", 0) == 0)
+      str = conv;
   }
 
-  *c = mutt_mem_malloc(size);
-  memcpy(*c, d + *off, size);
-  if (convert && !mutt_str_is_ascii(*c, size))
+  size_t idx = (uintptr_t) mutt_hash_find(w->dedup, str);
+  if (idx == 0)
   {
-    char *tmp = mutt_str_strdup(*c);
-    if (mutt_ch_convert_string(&tmp, "utf-8", C_Charset, 0) == 0)
-    {
-      FREE(c);
-      *c = tmp;
-    }
-    else
-    {
-      FREE(&tmp);
-    }
+    size_t len = mutt_str_strlen(str);
+    put_varint(&w->strings, len);
+    buf_append(&w->strings, str, len);
+    idx = ++w->num_strings;
+    mutt_hash_insert(w->dedup, str, (void *) (uintptr_t) idx);
   }
-  *off += size;
+
+  FREE(&conv);
+  return idx;
 }
 
 /**
- * serial_dump_address - Pack an Address into a binary blob
- * @param al      AddressList to pack
- * @param d       Binary blob to add to
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted to utf-8
- * @retval ptr End of the newly packed binary
+ * put_string - Add a string field
+ * @param w       Record writer
+ * @param sb      Buffer to add to
+ * @param field   Field number
+ * @param str     String, may be NULL
+ * @param convert If true, the string will be converted to utf-8
+ *
+ * A NULL string is omitted, unless it's part of a repeated field.
  */
-unsigned char *serial_dump_address(struct AddressList *al, unsigned char *d,
-                                   int *off, bool convert)
+static void put_string(struct SerialWriter *w, struct SerialBuf *sb,
+                       unsigned int field, const char *str, bool convert)
 {
-  unsigned int counter = 0;
-  unsigned int start_off = *off;
+  if (!str)
+    return;
 
-  d = serial_dump_int(0xdeadbeef, d, off);
+  put_tag(sb, field, SW_STRING);
+  put_varint(sb, string_index(w, str, convert && w->convert));
+}
 
+/**
+ * dump_address - Pack an AddressList into a block field
+ * @param w     Record writer
+ * @param sb    Buffer to add to
+ * @param field Field number
+ * @param al    AddressList to pack
+ */
+static void dump_address(struct SerialWriter *w, struct SerialBuf *sb,
+                         unsigned int field, const struct AddressList *al)
+{
+  if (TAILQ_EMPTY(al))
+    return;
+
+  struct SerialBuf list = { 0 };
   struct Address *a = NULL;
   TAILQ_FOREACH(a, al, entries)
   {
-    d = serial_dump_char(a->personal, d, off, convert);
-    d = serial_dump_char(a->mailbox, d, off, false);
-    d = serial_dump_int(a->group, d, off);
-    counter++;
+    struct SerialBuf addr = { 0 };
+    put_string(w, &addr, SF_ADDR_PERSONAL, a->personal, true);
+    put_string(w, &addr, SF_ADDR_MAILBOX, a->mailbox, false);
+    put_uint(&addr, SF_ADDR_GROUP, a->group);
+    put_block(&list, SF_ADDR_ADDRESS, &addr);
   }
+  put_block(sb, field, &list);
+}
 
-  memcpy(d + start_off, &counter, sizeof(int));
-
-  return d;
+/**
+ * dump_stailq - Pack a STAILQ into a repeated string field
+ * @param w       Record writer
+ * @param sb      Buffer to add to
+ * @param field   Field number
+ * @param l       List to pack
+ * @param convert If true, the strings will be converted to utf-8
+ */
+static void dump_stailq(struct SerialWriter *w, struct SerialBuf *sb,
+                        unsigned int field, const struct ListHead *l, bool convert)
+{
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, l, entries)
+  {
+    put_tag(sb, field, SW_STRING);
+    put_varint(sb, np->data ? string_index(w, np->data, convert && w->convert) : 0);
+  }
 }
 
 /**
- * serial_restore_address - Unpack an Address from a binary blob
- * @param[out] al      Store the unpacked AddressList here
- * @param[in]  d       Binary blob to read from
- * @param[out] off     Offset into the blob
- * @param[in]  convert If true, the strings will be converted from utf-8
+ * dump_body - Pack a Body into a block field
+ * @param w     Record writer
+ * @param sb    Buffer to add to
+ * @param field Field number
+ * @param b     Body to pack
  */
-void serial_restore_address(struct AddressList *al, const unsigned char *d,
-                            int *off, bool convert)
+static void dump_body(struct SerialWriter *w, struct SerialBuf *sb,
+                      unsigned int field, const struct Body *b)
 {
-  unsigned int counter = 0;
-  unsigned int g = 0;
+  if (!b)
+    return;
 
-  serial_restore_int(&counter, d, off);
+  struct SerialBuf bb = { 0 };
 
-  while (counter)
+  put_string(w, &bb, SF_BODY_XTYPE, b->xtype, false);
+  put_string(w, &bb, SF_BODY_SUBTYPE, b->subtype, false);
+
+  struct Parameter *np = NULL;
+  TAILQ_FOREACH(np, &b->parameter, entries)
   {
-    struct Address *a = mutt_addr_new();
-    serial_restore_char(&a->personal, d, off, convert);
-    serial_restore_char(&a->mailbox, d, off, false);
-    serial_restore_int(&g, d, off);
-    a->group = !!g;
-    mutt_addrlist_append(al, a);
-    counter--;
+    struct SerialBuf param = { 0 };
+    put_string(w, &param, SF_PARAM_ATTRIBUTE, np->attribute, false);
+    put_string(w, &param, SF_PARAM_VALUE, np->value, true);
+    put_block(&bb, SF_BODY_PARAMETER, &param);
   }
+
+  put_string(w, &bb, SF_BODY_DESCRIPTION, b->description, true);
+  put_string(w, &bb, SF_BODY_FORM_NAME, b->form_name, true);
+  put_string(w, &bb, SF_BODY_FILENAME, b->filename, true);
+  put_string(w, &bb, SF_BODY_D_FILENAME, b->d_filename, true);
+
+  put_sint(&bb, SF_BODY_HDR_OFFSET, b->hdr_offset);
+  put_sint(&bb, SF_BODY_OFFSET, b->offset);
+  put_sint(&bb, SF_BODY_LENGTH, b->length);
+  put_uint(&bb, SF_BODY_TYPE, b->type);
+  put_uint(&bb, SF_BODY_ENCODING, b->encoding);
+
+  /* mutt_body_new() doesn't zero these, so always store them */
+  put_tag(&bb, SF_BODY_DISPOSITION, SW_VARINT);
+  put_varint(&bb, b->disposition);
+
+  uint64_t flags = 0;
+  if (b->use_disp)
+    flags |= SERIAL_BODY_USE_DISP;
+  if (b->unlink)
+    flags |= SERIAL_BODY_UNLINK;
+  if (b->noconv)
+    flags |= SERIAL_BODY_NOCONV;
+  if (b->force_charset)
+    flags |= SERIAL_BODY_FORCE_CHARSET;
+  if (b->goodsig)
+    flags |= SERIAL_BODY_GOODSIG;
+  if (b->warnsig)
+    flags |= SERIAL_BODY_WARNSIG;
+  if (b->badsig)
+    flags |= SERIAL_BODY_BADSIG;
+#ifdef USE_AUTOCRYPT
+  if (b->is_autocrypt)
+    flags |= SERIAL_BODY_IS_AUTOCRYPT;
+#endif
+  if (b->attach_qualifies)
+    flags |= SERIAL_BODY_ATTACH_QUALIFIES;
+  if (b->tagged)
+    flags |= SERIAL_BODY_TAGGED;
+  if (b->deleted)
+    flags |= SERIAL_BODY_DELETED;
+  if (b->collapsed)
+    flags |= SERIAL_BODY_COLLAPSED;
+  put_tag(&bb, SF_BODY_FLAGS, SW_VARINT);
+  put_varint(&bb, flags);
+
+  put_sint(&bb, SF_BODY_ATTACH_COUNT, b->attach_count);
+  put_sint(&bb, SF_BODY_STAMP, b->stamp);
+
+  put_block(sb, field, &bb);
 }
 
 /**
- * serial_dump_stailq - Pack a STAILQ into a binary blob
- * @param l       List to read from
- * @param d       Binary blob to add to
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted to utf-8
- * @retval ptr End of the newly packed binary
+ * dump_envelope - Pack an Envelope into a block field
+ * @param w     Record writer
+ * @param sb    Buffer to add to
+ * @param field Field number
+ * @param env   Envelope to pack
  */
-unsigned char *serial_dump_stailq(struct ListHead *l, unsigned char *d, int *off, bool convert)
+static void dump_envelope(struct SerialWriter *w, struct SerialBuf *sb,
+                          unsigned int field, const struct Envelope *env)
 {
-  unsigned int counter = 0;
-  unsigned int start_off = *off;
+  if (!env)
+    return;
 
-  d = serial_dump_int(0xdeadbeef, d, off);
+  struct SerialBuf eb = { 0 };
 
-  struct ListNode *np = NULL;
-  STAILQ_FOREACH(np, l, entries)
+  dump_address(w, &eb, SF_ENV_RETURN_PATH, &env->return_path);
+  dump_address(w, &eb, SF_ENV_FROM, &env->from);
+  dump_address(w, &eb, SF_ENV_TO, &env->to);
+  dump_address(w, &eb, SF_ENV_CC, &env->cc);
+  dump_address(w, &eb, SF_ENV_BCC, &env->bcc);
+  dump_address(w, &eb, SF_ENV_SENDER, &env->sender);
+  dump_address(w, &eb, SF_ENV_REPLY_TO, &env->reply_to);
+  dump_address(w, &eb, SF_ENV_MAIL_FOLLOWUP_TO, &env->mail_followup_to);
+
+  put_string(w, &eb, SF_ENV_LIST_POST, env->list_post, true);
+  put_string(w, &eb, SF_ENV_SUBJECT, env->subject, true);
+  if (env->subject && env->real_subj)
   {
-    d = serial_dump_char(np->data, d, off, convert);
-    counter++;
+    put_tag(&eb, SF_ENV_REAL_SUBJ, SW_VARINT);
+    put_varint(&eb, env->real_subj - env->subject);
   }
 
-  memcpy(d + start_off, &counter, sizeof(int));
+  put_string(w, &eb, SF_ENV_MESSAGE_ID, env->message_id, false);
+  put_string(w, &eb, SF_ENV_SUPERSEDES, env->supersedes, false);
+  put_string(w, &eb, SF_ENV_DATE, env->date, false);
+  put_string(w, &eb, SF_ENV_X_LABEL, env->x_label, true);
+  put_string(w, &eb, SF_ENV_ORGANIZATION, env->organization, true);
+  if (mutt_buffer_len(&env->spam) > 0)
+    put_string(w, &eb, SF_ENV_SPAM, mutt_b2s(&env->spam), true);
 
-  return d;
+  dump_stailq(w, &eb, SF_ENV_REFERENCES, &env->references, false);
+  dump_stailq(w, &eb, SF_ENV_IN_REPLY_TO, &env->in_reply_to, false);
+  dump_stailq(w, &eb, SF_ENV_USERHDRS, &env->userhdrs, true);
+
+#ifdef USE_NNTP
+  put_string(w, &eb, SF_ENV_XREF, env->xref, false);
+  put_string(w, &eb, SF_ENV_FOLLOWUP_TO, env->followup_to, false);
+  put_string(w, &eb, SF_ENV_X_COMMENT_TO, env->x_comment_to, true);
+#endif
+
+  put_block(sb, field, &eb);
 }
 
 /**
- * serial_restore_stailq - Unpack a STAILQ from a binary blob
- * @param l       List to add to
- * @param d       Binary blob to read from
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted from utf-8
+ * record_finish - Assemble a record from its string table and fields
+ * @param[in]  w      Record writer (will be emptied)
+ * @param[in]  fields Top-level fields (will be freed)
+ * @param[out] len    Length of the record
+ * @retval ptr Record, must be freed by the caller
  */
-void serial_restore_stailq(struct ListHead *l, const unsigned char *d, int *off, bool convert)
+static unsigned char *record_finish(struct SerialWriter *w, struct SerialBuf *fields, size_t *len)
 {
-  unsigned int counter;
-
-  serial_restore_int(&counter, d, off);
+  /* Everything after the length */
+  struct SerialBuf rest = { 0 };
+  put_varint(&rest, w->num_strings);
+  buf_append(&rest, w->strings.data, w->strings.len);
+  put_varint(&rest, fields->len);
+  buf_append(&rest, fields->data, fields->len);
+
+  struct SerialBuf rec = { 0 };
+  put_varint(&rec, SERIAL_FORMAT);
+  put_varint(&rec, rest.len);
+  buf_append(&rec, rest.data, rest.len);
+
+  FREE(&rest.data);
+  FREE(&fields->data);
+  FREE(&w->strings.data);
+  w->num_strings = 0;
+  mutt_hash_free(&w->dedup);
+
+  *len = rec.len;
+  return rec.data;
+}
 
-  struct ListNode *np = NULL;
-  while (counter)
-  {
-    np = mutt_list_insert_tail(l, NULL);
-    serial_restore_char(&np->data, d, off, convert);
-    counter--;
-  }
+/**
+ * serial_dump_email - Pack an Email into a self-describing record
+ * @param[in]  e       Email to pack
+ * @param[out] len     Length of the record
+ * @param[in]  convert If true, the strings will be converted to utf-8
+ * @retval ptr Record, must be freed by the caller
+ *
+ * Fields that only make sense while the Mailbox is open (tags, threading,
+ * colours, etc) are not stored.
+ */
+unsigned char *serial_dump_email(const struct Email *e, size_t *len, bool convert)
+{
+  struct SerialWriter w = { { 0 } };
+  w.dedup = mutt_hash_new(64, MUTT_HASH_STRDUP_KEYS);
+  w.convert = convert;
+
+  struct SerialBuf fields = { 0 };
+
+  /* Don't lose any fields the header cache hasn't restored yet */
+  mutt_env_load(e->env);
+
+  uint64_t flags = 0;
+  if (e->mime)
+    flags |= SERIAL_EMAIL_MIME;
+  if (e->flagged)
+    flags |= SERIAL_EMAIL_FLAGGED;
+  if (e->deleted)
+    flags |= SERIAL_EMAIL_DELETED;
+  if (e->purge)
+    flags |= SERIAL_EMAIL_PURGE;
+  if (e->quasi_deleted)
+    flags |= SERIAL_EMAIL_QUASI_DELETED;
+  if (e->attach_del)
+    flags |= SERIAL_EMAIL_ATTACH_DEL;
+  if (e->old)
+    flags |= SERIAL_EMAIL_OLD;
+  if (e->read)
+    flags |= SERIAL_EMAIL_READ;
+  if (e->expired)
+    flags |= SERIAL_EMAIL_EXPIRED;
+  if (e->superseded)
+    flags |= SERIAL_EMAIL_SUPERSEDED;
+  if (e->replied)
+    flags |= SERIAL_EMAIL_REPLIED;
+  if (e->subject_changed)
+    flags |= SERIAL_EMAIL_SUBJECT_CHANGED;
+  if (e->display_subject)
+    flags |= SERIAL_EMAIL_DISPLAY_SUBJECT;
+  if (e->active)
+    flags |= SERIAL_EMAIL_ACTIVE;
+  if (e->trash)
+    flags |= SERIAL_EMAIL_TRASH;
+  put_uint(&fields, SF_EMAIL_FLAGS, flags);
+
+  put_uint(&fields, SF_EMAIL_SECURITY, e->security);
+  put_uint(&fields, SF_EMAIL_TIMEZONE,
+           e->zhours | (e->zminutes << 5) | ((unsigned int) e->zoccident << 11));
+  put_sint(&fields, SF_EMAIL_DATE_SENT, e->date_sent);
+  put_sint(&fields, SF_EMAIL_RECEIVED, e->received);
+  put_sint(&fields, SF_EMAIL_OFFSET, e->offset);
+  put_sint(&fields, SF_EMAIL_LINES, e->lines);
+  put_sint(&fields, SF_EMAIL_INDEX, e->index);
+  put_sint(&fields, SF_EMAIL_SCORE, e->score);
+  put_sint(&fields, SF_EMAIL_MSGNO, e->msgno);
+  put_sint(&fields, SF_EMAIL_VNUM, e->vnum);
+
+  dump_envelope(&w, &fields, SF_EMAIL_ENVELOPE, e->env);
+  dump_body(&w, &fields, SF_EMAIL_BODY, e->content);
+  put_string(&w, &fields, SF_EMAIL_MAILDIR_FLAGS, e->maildir_flags, true);
+
+  return record_finish(&w, &fields, len);
 }
 
 /**
- * serial_dump_buffer - Pack a Buffer into a binary blob
- * @param buf     Buffer to pack
- * @param d       Binary blob to add to
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted to utf-8
- * @retval ptr End of the newly packed binary
+ * serial_get_varint - Read an unsigned varint
+ * @param[in]  r   Reader
+ * @param[out] val Number read
+ * @retval true  Success
+ * @retval false The data is truncated or corrupt
  */
-unsigned char *serial_dump_buffer(struct Buffer *buf, unsigned char *d, int *off, bool convert)
+bool serial_get_varint(struct SerialReader *r, uint64_t *val)
 {
-  if (!buf)
-  {
-    d = serial_dump_int(0, d, off);
-    return d;
-  }
+  uint64_t result = 0;
 
-  d = serial_dump_int(1, d, off);
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    if (r->off >= r->len)
+      break;
 
-  d = serial_dump_char_size(buf->data, buf->dsize + 1, d, off, convert);
-  d = serial_dump_int(buf->dptr - buf->data, d, off);
-  d = serial_dump_int(buf->dsize, d, off);
+    unsigned char c = r->data[r->off++];
+    result |= (uint64_t)(c & 0x7f) << shift;
+    if (!(c & 0x80))
+    {
+      *val = result;
+      return true;
+    }
+  }
 
-  return d;
+  r->error = true;
+  return false;
 }
 
 /**
- * serial_restore_buffer - Unpack a Buffer from a binary blob
- * @param[out] buf     Store the unpacked Buffer here
- * @param[in]  d       Binary blob to read from
- * @param[out] off     Offset into the blob
- * @param[in]  convert If true, the strings will be converted from utf-8
+ * serial_get_block - Read a nested block
+ * @param[in]  r     Reader
+ * @param[out] block Reader for the contents of the block
+ * @retval true  Success
+ * @retval false The data is truncated or corrupt
  */
-void serial_restore_buffer(struct Buffer *buf, const unsigned char *d, int *off, bool convert)
+bool serial_get_block(struct SerialReader *r, struct SerialReader *block)
 {
-  unsigned int used;
-  unsigned int offset;
-  serial_restore_int(&used, d, off);
-  if (!used)
+  uint64_t len = 0;
+  if (!serial_get_varint(r, &len))
+    return false;
+
+  if (len > (r->len - r->off))
   {
-    return;
+    r->error = true;
+    return false;
   }
 
-  serial_restore_char(&buf->data, d, off, convert);
-  serial_restore_int(&offset, d, off);
-  buf->dptr = buf->data + offset;
-  serial_restore_int(&used, d, off);
-  buf->dsize = used;
+  block->data = r->data + r->off;
+  block->len = len;
+  block->off = 0;
+  block->error = false;
+  r->off += len;
+  return true;
 }
 
 /**
- * serial_dump_parameter - Pack a Parameter into a binary blob
- * @param pl      Parameter to pack
- * @param d       Binary blob to add to
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted to utf-8
- * @retval ptr End of the newly packed binary
+ * serial_next_field - Read the tag of the next field in a block
+ * @param[in]  r     Reader
+ * @param[out] field Field number
+ * @param[out] wire  Encoding of the field's value
+ * @retval true  A field was read
+ * @retval false End of the block, or the data is corrupt
  */
-unsigned char *serial_dump_parameter(struct ParameterList *pl, unsigned char *d,
-                                     int *off, bool convert)
+bool serial_next_field(struct SerialReader *r, unsigned int *field, enum SerialWire *wire)
 {
-  unsigned int counter = 0;
-  unsigned int start_off = *off;
+  if (r->error || (r->off >= r->len))
+    return false;
 
-  d = serial_dump_int(0xdeadbeef, d, off);
+  uint64_t tag = 0;
+  if (!serial_get_varint(r, &tag))
+    return false;
 
-  struct Parameter *np = NULL;
-  TAILQ_FOREACH(np, pl, entries)
+  if (((tag & 3) > SW_BLOCK) || ((tag >> 2) == 0) || ((tag >> 2) > UINT_MAX))
   {
-    d = serial_dump_char(np->attribute, d, off, false);
-    d = serial_dump_char(np->value, d, off, convert);
-    counter++;
+    r->error = true;
+    return false;
   }
 
-  memcpy(d + start_off, &counter, sizeof(int));
+  *field = tag >> 2;
+  *wire = tag & 3;
+  return true;
+}
 
-  return d;
+/**
+ * serial_skip_field - Skip the value of a field
+ * @param r    Reader
+ * @param wire Encoding of the field's value
+ * @retval true  Success
+ * @retval false The data is truncated or corrupt
+ */
+bool serial_skip_field(struct SerialReader *r, enum SerialWire wire)
+{
+  uint64_t val = 0;
+  struct SerialReader block = { 0 };
+
+  if (wire == SW_BLOCK)
+    return serial_get_block(r, &block);
+  return serial_get_varint(r, &val);
 }
 
 /**
- * serial_restore_parameter - Unpack a Parameter from a binary blob
- * @param pl      Store the unpacked Parameter here
- * @param d       Binary blob to read from
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted from utf-8
+ * get_string - Read a string field
+ * @param rec     Record containing the string table
+ * @param r       Reader
+ * @param convert If true, the string will be converted from utf-8
+ * @param share   How the string may be shared (if so, it must not be changed)
+ * @retval ptr  New string, must be freed by the caller
+ * @retval NULL The string was NULL, or the data is corrupt (see SerialReader::error)
  */
-void serial_restore_parameter(struct ParameterList *pl, const unsigned char *d,
-                              int *off, bool convert)
+static char *get_string(const struct SerialRecord *rec, struct SerialReader *r,
+                        bool convert, enum SerialShare share)
 {
-  unsigned int counter;
+  uint64_t idx = 0;
+  if (!serial_get_varint(r, &idx) || (idx == 0))
+    return NULL;
 
-  serial_restore_int(&counter, d, off);
+  if (idx > rec->num_strings)
+  {
+    r->error = true;
+    return NULL;
+  }
 
-  struct Parameter *np = NULL;
-  while (counter)
+  const struct SerialString *ss = &rec->strings[idx - 1];
+  if (convert && rec->convert && !mutt_str_is_ascii(ss->str, ss->len))
+  {
+    char *tmp = mutt_str_substr_dup(ss->str, ss->str + ss->len);
+    if (mutt_ch_convert_string(&tmp, "utf-8", C_Charset, 0) == 0)
+    {
+      if (share != SHARE_POOL)
+        return tmp;
+      char *str = mutt_strpool_get(tmp);
+      FREE(&tmp);
+      return str;
+    }
+    FREE(&tmp);
+  }
+
+  switch (share)
   {
-    np = mutt_param_new();
-    serial_restore_char(&np->attribute, d, off, false);
-    serial_restore_char(&np->value, d, off, convert);
-    TAILQ_INSERT_TAIL(pl, np, entries);
-    counter--;
+    case SHARE_ARENA:
+      return mutt_arena_intern(ss->str, ss->len);
+    case SHARE_POOL:
+      return mutt_strpool_getn(ss->str, ss->len);
+    default:
+      return mutt_arena_strndup(ss->str, ss->len);
   }
 }
 
 /**
- * serial_dump_body - Pack an Body into a binary blob
- * @param c       Body to pack
- * @param d       Binary blob to add to
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted to utf-8
- * @retval ptr End of the newly packed binary
+ * serial_get_string - Read a string field
+ * @param rec     Record containing the string table
+ * @param r       Reader
+ * @param convert If true, the string will be converted from utf-8
+ * @retval ptr  New string, must be freed by the caller
+ * @retval NULL The string was NULL, or the data is corrupt (see SerialReader::error)
+ *
+ * If there's a current Arena, the string will be allocated from it.
  */
-unsigned char *serial_dump_body(struct Body *c, unsigned char *d, int *off, bool convert)
+char *serial_get_string(const struct SerialRecord *rec, struct SerialReader *r, bool convert)
 {
-  struct Body nb;
-
-  memcpy(&nb, c, sizeof(struct Body));
+  return get_string(rec, r, convert, SHARE_NONE);
+}
 
-  /* some fields are not safe to cache */
-  nb.content = NULL;
-  nb.charset = NULL;
-  nb.next = NULL;
-  nb.parts = NULL;
-  nb.email = NULL;
-  nb.aptr = NULL;
-  nb.mime_headers = NULL;
-  nb.language = NULL;
+/**
+ * serial_get_uint - Read a varint field of the expected type
+ * @param[in]  r    Reader
+ * @param[in]  wire Encoding of the field's value
+ * @param[out] val  Number read
+ * @retval true Success
+ * @retval false The field isn't a number, or the data is corrupt
+ */
+static bool serial_get_uint(struct SerialReader *r, enum SerialWire wire, uint64_t *val)
+{
+  if (wire != SW_VARINT)
+  {
+    serial_skip_field(r, wire);
+    return false;
+  }
+  return serial_get_varint(r, val);
+}
 
-  lazy_realloc(&d, *off + sizeof(struct Body));
-  memcpy(d + *off, &nb, sizeof(struct Body));
-  *off += sizeof(struct Body);
+/**
+ * serial_get_sint - Read a zig-zag varint field
+ * @param r    Reader
+ * @param wire Encoding of the field's value
+ * @retval num Number read (0 on error)
+ */
+static int64_t serial_get_sint(struct SerialReader *r, enum SerialWire wire)
+{
+  uint64_t val = 0;
+  if (!serial_get_uint(r, wire, &val))
+    return 0;
+  return (int64_t)(val >> 1) ^ -(int64_t)(val & 1);
+}
 
-  d = serial_dump_char(nb.xtype, d, off, false);
-  d = serial_dump_char(nb.subtype, d, off, false);
+/**
+ * serial_record_open - Parse the header and string table of a record
+ * @param rec     Record to fill in
+ * @param d       Record data
+ * @param len     Length of the data (may be larger than the record)
+ * @param convert If true, strings will be converted from utf-8
+ * @retval true  Success
+ * @retval false The record is corrupt, or uses an unknown format
+ *
+ * On success, the record must be released with serial_record_close().
+ */
+bool serial_record_open(struct SerialRecord *rec, const unsigned char *d,
+                        size_t len, bool convert)
+{
+  memset(rec, 0, sizeof(*rec));
+  rec->convert = convert;
+
+  if (!d)
+    return false;
+
+  struct SerialReader r = { d, len, 0, false };
+  uint64_t format = 0;
+  uint64_t rest = 0;
+  if (!serial_get_varint(&r, &format) || (format != SERIAL_FORMAT))
+    return false;
+  if (!serial_get_varint(&r, &rest) || (rest > (r.len - r.off)))
+    return false;
+  r.len = r.off + rest;
+
+  uint64_t num = 0;
+  if (!serial_get_varint(&r, &num) || (num > (r.len - r.off)))
+    return false;
+
+  if (num > 0)
+    rec->strings = mutt_mem_calloc(num, sizeof(struct SerialString));
+  rec->num_strings = num;
+
+  for (size_t i = 0; i < num; i++)
+  {
+    uint64_t slen = 0;
+    if (!serial_get_varint(&r, &slen) || (slen > (r.len - r.off)))
+      goto fail;
+    rec->strings[i].str = (const char *) r.data + r.off;
+    rec->strings[i].len = slen;
+    r.off += slen;
+  }
 
-  d = serial_dump_parameter(&nb.parameter, d, off, convert);
+  if (!serial_get_block(&r, &rec->fields))
+    goto fail;
 
-  d = serial_dump_char(nb.description, d, off, convert);
-  d = serial_dump_char(nb.form_name, d, off, convert);
-  d = serial_dump_char(nb.filename, d, off, convert);
-  d = serial_dump_char(nb.d_filename, d, off, convert);
+  return true;
 
-  return d;
+fail:
+  serial_record_close(rec);
+  return false;
 }
 
 /**
- * serial_restore_body - Unpack a Body from a binary blob
- * @param c       Store the unpacked Body here
- * @param d       Binary blob to read from
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted from utf-8
+ * serial_record_close - Release a parsed record
+ * @param rec Record
  */
-void serial_restore_body(struct Body *c, const unsigned char *d, int *off, bool convert)
+void serial_record_close(struct SerialRecord *rec)
 {
-  memcpy(c, d + *off, sizeof(struct Body));
-  *off += sizeof(struct Body);
-  c->language = NULL;
+  if (!rec)
+    return;
 
-  serial_restore_char(&c->xtype, d, off, false);
-  serial_restore_char(&c->subtype, d, off, false);
+  FREE(&rec->strings);
+  rec->num_strings = 0;
+}
 
-  TAILQ_INIT(&c->parameter);
-  serial_restore_parameter(&c->parameter, d, off, convert);
+/**
+ * struct SerialLazy - Envelope fields whose restoration has been deferred
+ */
+struct SerialLazy
+{
+  struct SerialWriter w;  ///< String table of the deferred fields
+  struct SerialBuf env;   ///< Deferred Envelope fields
+};
 
-  serial_restore_char(&c->description, d, off, convert);
-  serial_restore_char(&c->form_name, d, off, convert);
-  serial_restore_char(&c->filename, d, off, convert);
-  serial_restore_char(&c->d_filename, d, off, convert);
+/**
+ * is_lazy_field - Can the restoration of an Envelope field be deferred?
+ * @param field Envelope field, e.g. #SF_ENV_SENDER
+ * @retval true The field isn't needed to draw the index
+ *
+ * Fields needed by the index, threading, sorting and hooks must be restored
+ * immediately.
+ */
+static bool is_lazy_field(unsigned int field)
+{
+  switch (field)
+  {
+    case SF_ENV_RETURN_PATH:
+    case SF_ENV_SENDER:
+    case SF_ENV_MAIL_FOLLOWUP_TO:
+    case SF_ENV_USERHDRS:
+      return true;
+    default:
+      return false;
+  }
 }
 
 /**
- * serial_dump_envelope - Pack an Envelope into a binary blob
- * @param env     Envelope to pack
- * @param d       Binary blob to add to
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted to utf-8
- * @retval ptr End of the newly packed binary
+ * transcode_field - Copy a field into another record, without decoding it
+ * @param rec   Source record
+ * @param r     Reader, positioned after the field's tag
+ * @param w     Destination record writer
+ * @param sb    Buffer to add to
+ * @param field Field number
+ * @param wire  Encoding of the field's value
+ *
+ * String indexes are rewritten to point into the destination's string table.
  */
-unsigned char *serial_dump_envelope(struct Envelope *env, unsigned char *d,
-                                    int *off, bool convert)
+static void transcode_field(const struct SerialRecord *rec, struct SerialReader *r,
+                            struct SerialWriter *w, struct SerialBuf *sb,
+                            unsigned int field, enum SerialWire wire)
 {
-  d = serial_dump_address(&env->return_path, d, off, convert);
-  d = serial_dump_address(&env->from, d, off, convert);
-  d = serial_dump_address(&env->to, d, off, convert);
-  d = serial_dump_address(&env->cc, d, off, convert);
-  d = serial_dump_address(&env->bcc, d, off, convert);
-  d = serial_dump_address(&env->sender, d, off, convert);
-  d = serial_dump_address(&env->reply_to, d, off, convert);
-  d = serial_dump_address(&env->mail_followup_to, d, off, convert);
-
-  d = serial_dump_char(env->list_post, d, off, convert);
-  d = serial_dump_char(env->subject, d, off, convert);
+  uint64_t val = 0;
+  char *str = NULL;
+  struct SerialReader block = { 0 };
+  struct SerialBuf nested = { 0 };
+  unsigned int inner_field;
+  enum SerialWire inner_wire;
+
+  switch (wire)
+  {
+    case SW_VARINT:
+      if (!serial_get_varint(r, &val))
+        return;
+      put_tag(sb, field, SW_VARINT);
+      put_varint(sb, val);
+      break;
+
+    case SW_STRING:
+    {
+      /* The string is only needed briefly, keep it out of the Arena */
+      struct Arena *arena = mutt_arena_swap(NULL);
+      str = serial_get_string(rec, r, false);
+      mutt_arena_swap(arena);
+      if (r->error)
+        return;
+      put_tag(sb, field, SW_STRING);
+      put_varint(sb, str ? string_index(w, str, false) : 0);
+      FREE(&str);
+      break;
+    }
 
-  if (env->real_subj)
-    d = serial_dump_int(env->real_subj - env->subject, d, off);
-  else
-    d = serial_dump_int(-1, d, off);
+    case SW_BLOCK:
+      if (!serial_get_block(r, &block))
+        return;
+      while (serial_next_field(&block, &inner_field, &inner_wire))
+        transcode_field(rec, &block, w, &nested, inner_field, inner_wire);
+      if (block.error)
+        r->error = true;
+      put_block(sb, field, &nested);
+      break;
+  }
+}
 
-  d = serial_dump_char(env->message_id, d, off, false);
-  d = serial_dump_char(env->supersedes, d, off, false);
-  d = serial_dump_char(env->date, d, off, false);
-  d = serial_dump_char(env->x_label, d, off, convert);
-  d = serial_dump_char(env->organization, d, off, convert);
+/**
+ * restore_address - Unpack an AddressList from a block
+ * @param rec Record
+ * @param r   Reader for the block
+ * @param al  AddressList to add to
+ */
+static void restore_address(const struct SerialRecord *rec, struct SerialReader *r,
+                            struct AddressList *al)
+{
+  unsigned int field;
+  enum SerialWire wire;
+  while (serial_next_field(r, &field, &wire))
+  {
+    struct SerialReader ab = { 0 };
+    if ((field != SF_ADDR_ADDRESS) || (wire != SW_BLOCK))
+    {
+      serial_skip_field(r, wire);
+      continue;
+    }
+    if (!serial_get_block(r, &ab))
+      break;
 
-  d = serial_dump_buffer(&env->spam, d, off, convert);
+    struct Address *a = mutt_addr_new();
+    uint64_t val = 0;
+    while (serial_next_field(&ab, &field, &wire))
+    {
+      if ((field == SF_ADDR_PERSONAL) && (wire == SW_STRING))
+      {
+        FREE(&a->personal);
+        a->personal = get_string(rec, &ab, true, SHARE_POOL);
+      }
+      else if ((field == SF_ADDR_MAILBOX) && (wire == SW_STRING))
+      {
+        FREE(&a->mailbox);
+        a->mailbox = get_string(rec, &ab, false, SHARE_POOL);
+      }
+      else if (field == SF_ADDR_GROUP)
+      {
+        if (serial_get_uint(&ab, wire, &val))
+          a->group = (val != 0);
+      }
+      else
+        serial_skip_field(&ab, wire);
+    }
+    mutt_addrlist_append(al, a);
+    if (ab.error)
+      r->error = true;
+  }
+}
 
-  d = serial_dump_stailq(&env->references, d, off, false);
-  d = serial_dump_stailq(&env->in_reply_to, d, off, false);
-  d = serial_dump_stailq(&env->userhdrs, d, off, convert);
+/**
+ * restore_body - Unpack a Body from a block
+ * @param rec Record
+ * @param r   Reader for the block
+ * @param b   Body to fill in
+ */
+static void restore_body(const struct SerialRecord *rec, struct SerialReader *r, struct Body *b)
+{
+  unsigned int field;
+  enum SerialWire wire;
+  uint64_t val = 0;
+  char **str = NULL;
+  bool convert = false;
 
-#ifdef USE_NNTP
-  d = serial_dump_char(env->xref, d, off, false);
-  d = serial_dump_char(env->followup_to, d, off, false);
-  d = serial_dump_char(env->x_comment_to, d, off, convert);
+  while (serial_next_field(r, &field, &wire))
+  {
+    str = NULL;
+    convert = false;
+    switch (field)
+    {
+      case SF_BODY_XTYPE:
+        str = &b->xtype;
+        break;
+      case SF_BODY_SUBTYPE:
+        str = &b->subtype;
+        break;
+      case SF_BODY_DESCRIPTION:
+        str = &b->description;
+        convert = true;
+        break;
+      case SF_BODY_FORM_NAME:
+        str = &b->form_name;
+        convert = true;
+        break;
+      case SF_BODY_FILENAME:
+        str = &b->filename;
+        convert = true;
+        break;
+      case SF_BODY_D_FILENAME:
+        str = &b->d_filename;
+        convert = true;
+        break;
+      case SF_BODY_PARAMETER:
+      {
+        struct SerialReader pb = { 0 };
+        if (wire != SW_BLOCK)
+        {
+          serial_skip_field(r, wire);
+          break;
+        }
+        if (!serial_get_block(r, &pb))
+          break;
+        struct Parameter *np = mutt_param_new();
+        while (serial_next_field(&pb, &field, &wire))
+        {
+          if ((field == SF_PARAM_ATTRIBUTE) && (wire == SW_STRING))
+          {
+            FREE(&np->attribute);
+            np->attribute = serial_get_string(rec, &pb, false);
+          }
+          else if ((field == SF_PARAM_VALUE) && (wire == SW_STRING))
+          {
+            FREE(&np->value);
+            np->value = serial_get_string(rec, &pb, true);
+          }
+          else
+            serial_skip_field(&pb, wire);
+        }
+        TAILQ_INSERT_TAIL(&b->parameter, np, entries);
+        if (pb.error)
+          r->error = true;
+        break;
+      }
+      case SF_BODY_HDR_OFFSET:
+        b->hdr_offset = serial_get_sint(r, wire);
+        break;
+      case SF_BODY_OFFSET:
+        b->offset = serial_get_sint(r, wire);
+        break;
+      case SF_BODY_LENGTH:
+        b->length = serial_get_sint(r, wire);
+        break;
+      case SF_BODY_TYPE:
+        if (serial_get_uint(r, wire, &val))
+          b->type = val;
+        break;
+      case SF_BODY_ENCODING:
+        if (serial_get_uint(r, wire, &val))
+          b->encoding = val;
+        break;
+      case SF_BODY_DISPOSITION:
+        if (serial_get_uint(r, wire, &val))
+          b->disposition = val;
+        break;
+      case SF_BODY_FLAGS:
+        if (!serial_get_uint(r, wire, &val))
+          break;
+        b->use_disp = (val & SERIAL_BODY_USE_DISP);
+        b->unlink = (val & SERIAL_BODY_UNLINK);
+        b->noconv = (val & SERIAL_BODY_NOCONV);
+        b->force_charset = (val & SERIAL_BODY_FORCE_CHARSET);
+        b->goodsig = (val & SERIAL_BODY_GOODSIG);
+        b->warnsig = (val & SERIAL_BODY_WARNSIG);
+        b->badsig = (val & SERIAL_BODY_BADSIG);
+#ifdef USE_AUTOCRYPT
+        b->is_autocrypt = (val & SERIAL_BODY_IS_AUTOCRYPT);
 #endif
+        b->attach_qualifies = (val & SERIAL_BODY_ATTACH_QUALIFIES);
+        b->tagged = (val & SERIAL_BODY_TAGGED);
+        b->deleted = (val & SERIAL_BODY_DELETED);
+        b->collapsed = (val & SERIAL_BODY_COLLAPSED);
+        break;
+      case SF_BODY_ATTACH_COUNT:
+        b->attach_count = serial_get_sint(r, wire);
+        break;
+      case SF_BODY_STAMP:
+        b->stamp = serial_get_sint(r, wire);
+        break;
+      default:
+        serial_skip_field(r, wire);
+        break;
+    }
 
-  return d;
+    if (!str)
+      continue;
+    if (wire != SW_STRING)
+    {
+      serial_skip_field(r, wire);
+      continue;
+    }
+    FREE(str);
+    *str = serial_get_string(rec, r, convert);
+  }
 }
 
 /**
- * serial_restore_envelope - Unpack an Envelope from a binary blob
- * @param env     Store the unpacked Envelope here
- * @param d       Binary blob to read from
- * @param off     Offset into the blob
- * @param convert If true, the strings will be converted from utf-8
+ * restore_envelope - Unpack an Envelope from a block
+ * @param rec  Record
+ * @param r    Reader for the block
+ * @param env  Envelope to fill in
+ * @param lazy If not NULL, defer restoring the rarely used fields
  */
-void serial_restore_envelope(struct Envelope *env, const unsigned char *d, int *off, bool convert)
+static void restore_envelope(const struct SerialRecord *rec, struct SerialReader *r,
+                             struct Envelope *env, struct SerialLazy *lazy)
 {
-  int real_subj_off;
+  unsigned int field;
+  enum SerialWire wire;
+  uint64_t real_subj = 0;
+  bool has_real_subj = false;
+  struct AddressList *al = NULL;
+  struct ListHead *list = NULL;
+  char **str = NULL;
+  bool convert = false;
+  enum SerialShare share = SHARE_NONE;
+
+  while (serial_next_field(r, &field, &wire))
+  {
+    if (lazy && is_lazy_field(field))
+    {
+      if (!lazy->w.dedup)
+        lazy->w.dedup = mutt_hash_new(16, MUTT_HASH_STRDUP_KEYS);
+      transcode_field(rec, r, &lazy->w, &lazy->env, field, wire);
+      continue;
+    }
 
-  serial_restore_address(&env->return_path, d, off, convert);
-  serial_restore_address(&env->from, d, off, convert);
-  serial_restore_address(&env->to, d, off, convert);
-  serial_restore_address(&env->cc, d, off, convert);
-  serial_restore_address(&env->bcc, d, off, convert);
-  serial_restore_address(&env->sender, d, off, convert);
-  serial_restore_address(&env->reply_to, d, off, convert);
-  serial_restore_address(&env->mail_followup_to, d, off, convert);
+    al = NULL;
+    list = NULL;
+    str = NULL;
+    convert = false;
+    share = SHARE_NONE;
+    switch (field)
+    {
+      case SF_ENV_RETURN_PATH:
+        al = &env->return_path;
+        break;
+      case SF_ENV_FROM:
+        al = &env->from;
+        break;
+      case SF_ENV_TO:
+        al = &env->to;
+        break;
+      case SF_ENV_CC:
+        al = &env->cc;
+        break;
+      case SF_ENV_BCC:
+        al = &env->bcc;
+        break;
+      case SF_ENV_SENDER:
+        al = &env->sender;
+        break;
+      case SF_ENV_REPLY_TO:
+        al = &env->reply_to;
+        break;
+      case SF_ENV_MAIL_FOLLOWUP_TO:
+        al = &env->mail_followup_to;
+        break;
+      case SF_ENV_LIST_POST:
+        str = &env->list_post;
+        convert = true;
+        share = SHARE_POOL;
+        break;
+      case SF_ENV_SUBJECT:
+        str = &env->subject;
+        convert = true;
+        break;
+      case SF_ENV_REAL_SUBJ:
+        has_real_subj = serial_get_uint(r, wire, &real_subj);
+        break;
+      case SF_ENV_MESSAGE_ID:
+        str = &env->message_id;
+        break;
+      case SF_ENV_SUPERSEDES:
+        str = &env->supersedes;
+        break;
+      case SF_ENV_DATE:
+        str = &env->date;
+        break;
+      case SF_ENV_X_LABEL:
+        str = &env->x_label;
+        convert = true;
+        break;
+      case SF_ENV_ORGANIZATION:
+        str = &env->organization;
+        convert = true;
+        break;
+      case SF_ENV_SPAM:
+      {
+        if (wire != SW_STRING)
+        {
+          serial_skip_field(r, wire);
+          break;
+        }
+        char *spam = serial_get_string(rec, r, true);
+        if (spam)
+          mutt_buffer_strcpy(&env->spam, spam);
+        FREE(&spam);
+        break;
+      }
+      case SF_ENV_REFERENCES:
+        list = &env->references;
+        share = SHARE_ARENA;
+        break;
+      case SF_ENV_IN_REPLY_TO:
+        list = &env->in_reply_to;
+        share = SHARE_ARENA;
+        break;
+      case SF_ENV_USERHDRS:
+        list = &env->userhdrs;
+        convert = true;
+        break;
+#ifdef USE_NNTP
+      case SF_ENV_XREF:
+        str = &env->xref;
+        break;
+      case SF_ENV_FOLLOWUP_TO:
+        str = &env->followup_to;
+        break;
+      case SF_ENV_X_COMMENT_TO:
+        str = &env->x_comment_to;
+        convert = true;
+        break;
+#endif
+      default:
+        serial_skip_field(r, wire);
+        break;
+    }
 
-  serial_restore_char(&env->list_post, d, off, convert);
+    if (al)
+    {
+      struct SerialReader ab = { 0 };
+      if (wire != SW_BLOCK)
+        serial_skip_field(r, wire);
+      else if (serial_get_block(r, &ab))
+        restore_address(rec, &ab, al);
+      if (ab.error)
+        r->error = true;
+    }
+    else if (list || str)
+    {
+      if (wire != SW_STRING)
+      {
+        serial_skip_field(r, wire);
+        continue;
+      }
+      char *s = get_string(rec, r, convert, share);
+      if (list)
+      {
+        mutt_list_insert_tail(list, s);
+      }
+      else
+      {
+        FREE(str);
+        *str = s;
+      }
+    }
+  }
 
   if (C_AutoSubscribe)
     mutt_auto_subscribe(env->list_post);
 
-  serial_restore_char(&env->subject, d, off, convert);
-  serial_restore_int((unsigned int *) (&real_subj_off), d, off);
+  if (has_real_subj && env->subject && (real_subj <= mutt_str_strlen(env->subject)))
+    env->real_subj = env->subject + real_subj;
+}
 
-  if (real_subj_off >= 0)
-    env->real_subj = env->subject + real_subj_off;
-  else
-    env->real_subj = NULL;
+/**
+ * restore_lazy - Restore the deferred fields of an Envelope - Implements Envelope::lazy_load()
+ * @param env Envelope
+ *
+ * Fields that have been set since the Envelope was restored are left alone.
+ */
+static void restore_lazy(struct Envelope *env)
+{
+  struct SerialRecord rec;
+  if (!serial_record_open(&rec, env->lazy_data, SIZE_MAX, !CharsetIsUtf8))
+    return;
+
+  struct Envelope *tmp = mutt_env_new();
+  struct SerialReader block = { 0 };
+  unsigned int field;
+  enum SerialWire wire;
+  while (serial_next_field(&rec.fields, &field, &wire))
+  {
+    if ((field == SF_EMAIL_ENVELOPE) && (wire == SW_BLOCK) &&
+        serial_get_block(&rec.fields, &block))
+    {
+      restore_envelope(&rec, &block, tmp, NULL);
+    }
+    else
+    {
+      serial_skip_field(&rec.fields, wire);
+    }
+  }
+  serial_record_close(&rec);
+
+  if (TAILQ_EMPTY(&env->return_path))
+    TAILQ_SWAP(&env->return_path, &tmp->return_path, Address, entries);
+  if (TAILQ_EMPTY(&env->sender))
+    TAILQ_SWAP(&env->sender, &tmp->sender, Address, entries);
+  if (TAILQ_EMPTY(&env->mail_followup_to))
+    TAILQ_SWAP(&env->mail_followup_to, &tmp->mail_followup_to, Address, entries);
+  if (STAILQ_EMPTY(&env->userhdrs))
+    STAILQ_SWAP(&env->userhdrs, &tmp->userhdrs, ListNode);
+
+  mutt_env_free(&tmp);
+}
+
+/**
+ * serial_restore_email - Unpack an Email from a self-describing record
+ * @param d       Record data
+ * @param len     Length of the data (may be larger than the record)
+ * @param convert If true, the strings will be converted from utf-8
+ * @param lazy    If true, defer restoring rarely used Envelope fields
+ * @retval ptr  New Email, must be freed with email_free()
+ * @retval NULL The record is corrupt, or uses an unknown format
+ *
+ * If lazy is set, the rarely used fields are kept, still encoded, in
+ * Envelope.lazy_data.  They will be restored by mutt_env_load().
+ */
+struct Email *serial_restore_email(const unsigned char *d, size_t len, bool convert, bool lazy)
+{
+  struct SerialRecord rec;
+  if (!serial_record_open(&rec, d, len, convert))
+    return NULL;
+
+  struct Email *e = email_new();
+  struct SerialReader *r = &rec.fields;
+  struct SerialReader block = { 0 };
+  unsigned int field;
+  enum SerialWire wire;
+  uint64_t val = 0;
+  struct SerialLazy sl = { { { 0 } } };
+
+  while (serial_next_field(r, &field, &wire))
+  {
+    switch (field)
+    {
+      case SF_EMAIL_FLAGS:
+        if (!serial_get_uint(r, wire, &val))
+          break;
+        e->mime = (val & SERIAL_EMAIL_MIME);
+        e->flagged = (val & SERIAL_EMAIL_FLAGGED);
+        e->deleted = (val & SERIAL_EMAIL_DELETED);
+        e->purge = (val & SERIAL_EMAIL_PURGE);
+        e->quasi_deleted = (val & SERIAL_EMAIL_QUASI_DELETED);
+        e->attach_del = (val & SERIAL_EMAIL_ATTACH_DEL);
+        e->old = (val & SERIAL_EMAIL_OLD);
+        e->read = (val & SERIAL_EMAIL_READ);
+        e->expired = (val & SERIAL_EMAIL_EXPIRED);
+        e->superseded = (val & SERIAL_EMAIL_SUPERSEDED);
+        e->replied = (val & SERIAL_EMAIL_REPLIED);
+        e->subject_changed = (val & SERIAL_EMAIL_SUBJECT_CHANGED);
+        e->display_subject = (val & SERIAL_EMAIL_DISPLAY_SUBJECT);
+        e->active = (val & SERIAL_EMAIL_ACTIVE);
+        e->trash = (val & SERIAL_EMAIL_TRASH);
+        break;
+      case SF_EMAIL_SECURITY:
+        if (serial_get_uint(r, wire, &val))
+          e->security = val;
+        break;
+      case SF_EMAIL_TIMEZONE:
+        if (!serial_get_uint(r, wire, &val))
+          break;
+        e->zhours = val & 0x1f;
+        e->zminutes = (val >> 5) & 0x3f;
+        e->zoccident = (val >> 11) & 1;
+        break;
+      case SF_EMAIL_DATE_SENT:
+        e->date_sent = serial_get_sint(r, wire);
+        break;
+      case SF_EMAIL_RECEIVED:
+        e->received = serial_get_sint(r, wire);
+        break;
+      case SF_EMAIL_OFFSET:
+        e->offset = serial_get_sint(r, wire);
+        break;
+      case SF_EMAIL_LINES:
+        e->lines = serial_get_sint(r, wire);
+        break;
+      case SF_EMAIL_INDEX:
+        e->index = serial_get_sint(r, wire);
+        break;
+      case SF_EMAIL_SCORE:
+        e->score = serial_get_sint(r, wire);
+        break;
+      case SF_EMAIL_MSGNO:
+        e->msgno = serial_get_sint(r, wire);
+        break;
+      case SF_EMAIL_VNUM:
+        e->vnum = serial_get_sint(r, wire);
+        break;
+      case SF_EMAIL_ENVELOPE:
+        if ((wire != SW_BLOCK) || e->env)
+        {
+          serial_skip_field(r, wire);
+          break;
+        }
+        if (!serial_get_block(r, &block))
+          break;
+        e->env = mutt_env_new();
+        restore_envelope(&rec, &block, e->env, lazy ? &sl : NULL);
+        if (block.error)
+          r->error = true;
+        break;
+      case SF_EMAIL_BODY:
+        if ((wire != SW_BLOCK) || e->content)
+        {
+          serial_skip_field(r, wire);
+          break;
+        }
+        if (!serial_get_block(r, &block))
+          break;
+        e->content = mutt_body_new();
+        restore_body(&rec, &block, e->content);
+        if (block.error)
+          r->error = true;
+        break;
+      case SF_EMAIL_MAILDIR_FLAGS:
+        if (wire != SW_STRING)
+        {
+          serial_skip_field(r, wire);
+          break;
+        }
+        FREE(&e->maildir_flags);
+        e->maildir_flags = serial_get_string(&rec, r, true);
+        break;
+      default:
+        serial_skip_field(r, wire);
+        break;
+    }
+  }
 
-  serial_restore_char(&env->message_id, d, off, false);
-  serial_restore_char(&env->supersedes, d, off, false);
-  serial_restore_char(&env->date, d, off, false);
-  serial_restore_char(&env->x_label, d, off, convert);
-  serial_restore_char(&env->organization, d, off, convert);
+  bool error = r->error;
+  serial_record_close(&rec);
 
-  serial_restore_buffer(&env->spam, d, off, convert);
+  if (!error && e->env && (sl.env.len > 0))
+  {
+    struct SerialBuf fields = { 0 };
+    size_t lazy_len = 0;
+    put_block(&fields, SF_EMAIL_ENVELOPE, &sl.env);
+    e->env->lazy_data = record_finish(&sl.w, &fields, &lazy_len);
+    e->env->lazy_load = restore_lazy;
+  }
+  FREE(&sl.env.data);
+  FREE(&sl.w.strings.data);
+  mutt_hash_free(&sl.w.dedup);
 
-  serial_restore_stailq(&env->references, d, off, false);
-  serial_restore_stailq(&env->in_reply_to, d, off, false);
-  serial_restore_stailq(&env->userhdrs, d, off, convert);
+  if (error)
+  {
+    email_free(&e);
+    return NULL;
+  }
 
-#ifdef USE_NNTP
-  serial_restore_char(&env->xref, d, off, false);
-  serial_restore_char(&env->followup_to, d, off, false);
-  serial_restore_char(&env->x_comment_to, d, off, convert);
-#endif
+  if (!e->env)
+    e->env = mutt_env_new();
+  if (!e->content)
+    e->content = mutt_body_new();
+
+  return e;
 }
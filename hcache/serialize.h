@@ -31,33 +31,191 @@
 #include <stdint.h>
 #include <sys/types.h>
 
-struct AddressList;
-struct Body;
-struct Buffer;
-struct Envelope;
-struct ListHead;
-struct ParameterList;
-
-unsigned char *serial_dump_address  (struct AddressList *al,   unsigned char *d, int *off, bool convert);
-unsigned char *serial_dump_body     (struct Body *c,           unsigned char *d, int *off, bool convert);
-unsigned char *serial_dump_buffer   (struct Buffer *buf,       unsigned char *d, int *off, bool convert);
-unsigned char *serial_dump_char     (char *c,                  unsigned char *d, int *off, bool convert);
-unsigned char *serial_dump_char_size(char *c, ssize_t size,    unsigned char *d, int *off, bool convert);
-unsigned char *serial_dump_envelope (struct Envelope *e,       unsigned char *d, int *off, bool convert);
-unsigned char *serial_dump_int      (unsigned int i,           unsigned char *d, int *off);
-unsigned char *serial_dump_uint32_t (uint32_t s,               unsigned char *d, int *off);
-unsigned char *serial_dump_parameter(struct ParameterList *pl, unsigned char *d, int *off, bool convert);
-unsigned char *serial_dump_stailq   (struct ListHead *l,       unsigned char *d, int *off, bool convert);
-
-void serial_restore_address  (struct AddressList *al,   const unsigned char *d, int *off, bool convert);
-void serial_restore_body     (struct Body *c,           const unsigned char *d, int *off, bool convert);
-void serial_restore_buffer   (struct Buffer *buf,       const unsigned char *d, int *off, bool convert);
-void serial_restore_char     (char **c,                 const unsigned char *d, int *off, bool convert);
-void serial_restore_envelope (struct Envelope *e,       const unsigned char *d, int *off, bool convert);
-void serial_restore_int      (unsigned int *i,          const unsigned char *d, int *off);
-void serial_restore_uint32_t (uint32_t *s,              const unsigned char *d, int *off);
-void serial_restore_parameter(struct ParameterList *pl, const unsigned char *d, int *off, bool convert);
-void serial_restore_stailq   (struct ListHead *l,       const unsigned char *d, int *off, bool convert);
+struct Email;
+
+/// Version of the record layout, stored at the start of every record
+#define SERIAL_FORMAT 1
+
+/**
+ * enum SerialWire - How a field's value is encoded
+ */
+enum SerialWire
+{
+  SW_VARINT = 0, ///< Unsigned LEB128 integer
+  SW_STRING = 1, ///< Varint index into the record's string table (0 is NULL)
+  SW_BLOCK  = 2, ///< Varint length, followed by nested fields
+};
+
+/* Each field is preceded by a varint tag: (field << 2) | wire.
+ * Decoders skip fields they don't recognise, so fields may be added freely.
+ * Never reuse or renumber a field. */
+
+/**
+ * enum SerialEmailField - Fields of a serialised Email
+ */
+enum SerialEmailField
+{
+  SF_EMAIL_FLAGS = 1,     ///< Bitmask of #SERIAL_EMAIL_MIME, etc
+  SF_EMAIL_SECURITY,      ///< Email.security
+  SF_EMAIL_TIMEZONE,      ///< Email.zhours | zminutes << 5 | zoccident << 11
+  SF_EMAIL_DATE_SENT,     ///< Email.date_sent (zig-zag)
+  SF_EMAIL_RECEIVED,      ///< Email.received (zig-zag)
+  SF_EMAIL_OFFSET,        ///< Email.offset (zig-zag)
+  SF_EMAIL_LINES,         ///< Email.lines (zig-zag)
+  SF_EMAIL_INDEX,         ///< Email.index (zig-zag)
+  SF_EMAIL_SCORE,         ///< Email.score (zig-zag)
+  SF_EMAIL_ENVELOPE,      ///< Block: Envelope
+  SF_EMAIL_BODY,          ///< Block: Body
+  SF_EMAIL_MAILDIR_FLAGS, ///< Email.maildir_flags
+  SF_EMAIL_MSGNO,         ///< Email.msgno (zig-zag)
+  SF_EMAIL_VNUM,          ///< Email.vnum (zig-zag)
+};
+
+/**
+ * enum SerialEnvelopeField - Fields of a serialised Envelope
+ */
+enum SerialEnvelopeField
+{
+  SF_ENV_RETURN_PATH = 1,   ///< Block: AddressList
+  SF_ENV_FROM,              ///< Block: AddressList
+  SF_ENV_TO,                ///< Block: AddressList
+  SF_ENV_CC,                ///< Block: AddressList
+  SF_ENV_BCC,               ///< Block: AddressList
+  SF_ENV_SENDER,            ///< Block: AddressList
+  SF_ENV_REPLY_TO,          ///< Block: AddressList
+  SF_ENV_MAIL_FOLLOWUP_TO,  ///< Block: AddressList
+  SF_ENV_LIST_POST,         ///< Envelope.list_post
+  SF_ENV_SUBJECT,           ///< Envelope.subject
+  SF_ENV_REAL_SUBJ,         ///< Offset of Envelope.real_subj into the subject
+  SF_ENV_MESSAGE_ID,        ///< Envelope.message_id
+  SF_ENV_SUPERSEDES,        ///< Envelope.supersedes
+  SF_ENV_DATE,              ///< Envelope.date
+  SF_ENV_X_LABEL,           ///< Envelope.x_label
+  SF_ENV_ORGANIZATION,      ///< Envelope.organization
+  SF_ENV_SPAM,              ///< Envelope.spam
+  SF_ENV_REFERENCES,        ///< One per entry of Envelope.references
+  SF_ENV_IN_REPLY_TO,       ///< One per entry of Envelope.in_reply_to
+  SF_ENV_USERHDRS,          ///< One per entry of Envelope.userhdrs
+  SF_ENV_XREF,              ///< Envelope.xref (NNTP)
+  SF_ENV_FOLLOWUP_TO,       ///< Envelope.followup_to (NNTP)
+  SF_ENV_X_COMMENT_TO,      ///< Envelope.x_comment_to (NNTP)
+};
+
+/**
+ * enum SerialAddressField - Fields of a serialised AddressList
+ */
+enum SerialAddressField
+{
+  SF_ADDR_ADDRESS = 1, ///< Block: one Address
+  SF_ADDR_PERSONAL,    ///< Address.personal
+  SF_ADDR_MAILBOX,     ///< Address.mailbox
+  SF_ADDR_GROUP,       ///< Address.group
+};
+
+/**
+ * enum SerialBodyField - Fields of a serialised Body
+ */
+enum SerialBodyField
+{
+  SF_BODY_XTYPE = 1,      ///< Body.xtype
+  SF_BODY_SUBTYPE,        ///< Body.subtype
+  SF_BODY_PARAMETER,      ///< Block: one Parameter
+  SF_BODY_DESCRIPTION,    ///< Body.description
+  SF_BODY_FORM_NAME,      ///< Body.form_name
+  SF_BODY_FILENAME,       ///< Body.filename
+  SF_BODY_D_FILENAME,     ///< Body.d_filename
+  SF_BODY_HDR_OFFSET,     ///< Body.hdr_offset (zig-zag)
+  SF_BODY_OFFSET,         ///< Body.offset (zig-zag)
+  SF_BODY_LENGTH,         ///< Body.length (zig-zag)
+  SF_BODY_TYPE,           ///< Body.type
+  SF_BODY_ENCODING,       ///< Body.encoding
+  SF_BODY_DISPOSITION,    ///< Body.disposition
+  SF_BODY_FLAGS,          ///< Bitmask of #SERIAL_BODY_USE_DISP, etc
+  SF_BODY_ATTACH_COUNT,   ///< Body.attach_count (zig-zag)
+  SF_BODY_STAMP,          ///< Body.stamp (zig-zag)
+  SF_PARAM_ATTRIBUTE,     ///< Parameter.attribute
+  SF_PARAM_VALUE,         ///< Parameter.value
+};
+
+/* Bits of SF_EMAIL_FLAGS */
+#define SERIAL_EMAIL_MIME            (1 << 0)
+#define SERIAL_EMAIL_FLAGGED         (1 << 1)
+#define SERIAL_EMAIL_DELETED         (1 << 2)
+#define SERIAL_EMAIL_PURGE           (1 << 3)
+#define SERIAL_EMAIL_QUASI_DELETED   (1 << 4)
+#define SERIAL_EMAIL_ATTACH_DEL      (1 << 5)
+#define SERIAL_EMAIL_OLD             (1 << 6)
+#define SERIAL_EMAIL_READ            (1 << 7)
+#define SERIAL_EMAIL_EXPIRED         (1 << 8)
+#define SERIAL_EMAIL_SUPERSEDED      (1 << 9)
+#define SERIAL_EMAIL_REPLIED         (1 << 10)
+#define SERIAL_EMAIL_SUBJECT_CHANGED (1 << 11)
+#define SERIAL_EMAIL_DISPLAY_SUBJECT (1 << 12)
+#define SERIAL_EMAIL_ACTIVE          (1 << 13)
+#define SERIAL_EMAIL_TRASH           (1 << 14)
+
+/* Bits of SF_BODY_FLAGS */
+#define SERIAL_BODY_USE_DISP         (1 << 0)
+#define SERIAL_BODY_UNLINK           (1 << 1)
+#define SERIAL_BODY_NOCONV           (1 << 2)
+#define SERIAL_BODY_FORCE_CHARSET    (1 << 3)
+#define SERIAL_BODY_GOODSIG          (1 << 4)
+#define SERIAL_BODY_WARNSIG          (1 << 5)
+#define SERIAL_BODY_BADSIG           (1 << 6)
+#define SERIAL_BODY_IS_AUTOCRYPT     (1 << 7)
+#define SERIAL_BODY_ATTACH_QUALIFIES (1 << 8)
+#define SERIAL_BODY_TAGGED           (1 << 9)
+#define SERIAL_BODY_DELETED          (1 << 10)
+#define SERIAL_BODY_COLLAPSED        (1 << 11)
+
+/**
+ * struct SerialReader - Cursor over a block of serialised fields
+ */
+struct SerialReader
+{
+  const unsigned char *data; ///< Start of the block
+  size_t len;                ///< Length of the block
+  size_t off;                ///< Current offset into the block
+  bool error;                ///< The data is truncated or corrupt
+};
+
+/**
+ * struct SerialString - Entry in a record's string table
+ */
+struct SerialString
+{
+  const char *str; ///< Points into the record, NOT NUL-terminated
+  size_t len;      ///< Length of the string
+};
+
+/**
+ * struct SerialRecord - A decoded record header
+ *
+ * The strings and fields point into the record; nothing is copied.
+ */
+struct SerialRecord
+{
+  struct SerialString *strings; ///< String table
+  size_t num_strings;           ///< Number of strings
+  struct SerialReader fields;   ///< Top-level (Email) fields
+  bool convert;                 ///< Convert strings from utf-8
+};
+
+unsigned char *serial_dump_email   (const struct Email *e, size_t *len, bool convert);
+struct Email * serial_restore_email(const unsigned char *d, size_t len, bool convert, bool lazy);
+
+bool  serial_record_open (struct SerialRecord *rec, const unsigned char *d, size_t len, bool convert);
+void  serial_record_close(struct SerialRecord *rec);
+bool  serial_next_field  (struct SerialReader *r, unsigned int *field, enum SerialWire *wire);
+bool  serial_get_varint  (struct SerialReader *r, uint64_t *val);
+bool  serial_get_block   (struct SerialReader *r, struct SerialReader *block);
+char *serial_get_string  (const struct SerialRecord *rec, struct SerialReader *r, bool convert);
+bool  serial_skip_field  (struct SerialReader *r, enum SerialWire wire);
+
+unsigned char *serial_dump_int      (unsigned int i, unsigned char *d, int *off);
+unsigned char *serial_dump_uint32_t (uint32_t s,     unsigned char *d, int *off);
+void           serial_restore_int     (unsigned int *i, const unsigned char *d, int *off);
+void           serial_restore_uint32_t(uint32_t *s,     const unsigned char *d, int *off);
 
 void lazy_realloc(void *ptr, size_t size);
 
@@ -81,6 +81,8 @@ static const char *const Capabilities[] = {
   "LIST-EXTENDED",
   "COMPRESS=DEFLATE",
   "X-GM-EXT-1",
+  "LIST-STATUS",
+  "NOTIFY",
   NULL,
 };
 
@@ -840,8 +842,11 @@ static void cmd_parse_status(struct ImapAccountData *adata, char *s)
     mutt_debug(LL_DEBUG3, "Received status for an unexpected mailbox: %s\n", mailbox);
     return;
   }
+  if (adata->list_status)
+    mdata->status_listed = true;
   uint32_t olduv = mdata->uidvalidity;
   unsigned int oldun = mdata->uid_next;
+  bool has_unseen = false;
 
   if (*s++ != '(')
   {
@@ -870,12 +875,28 @@ static void cmd_parse_status(struct ImapAccountData *adata, char *s)
     else if (mutt_str_startswith(s, "UIDVALIDITY", CASE_MATCH))
       mdata->uidvalidity = count;
     else if (mutt_str_startswith(s, "UNSEEN", CASE_MATCH))
+    {
       mdata->unseen = count;
+      has_unseen = true;
+    }
 
     s = value;
     if ((s[0] != '\0') && (*s != ')'))
       s = imap_next_word(s);
   }
+
+  /* A STATUS we didn't ask for, e.g. from NOTIFY, may not say how many
+   * messages are unseen.  Don't judge new mail by the old count; keep the
+   * old state and ask for the whole STATUS when the Mailbox is checked. */
+  if (!has_unseen)
+  {
+    mutt_debug(LL_DEBUG3, "STATUS of %s has no UNSEEN\n", mdata->name);
+    mdata->uidvalidity = olduv;
+    mdata->uid_next = oldun;
+    mdata->status_stale = true;
+    return;
+  }
+  mdata->status_stale = false;
   mutt_debug(LL_DEBUG3, "%s (UIDVALIDITY: %u, UIDNEXT: %u) %d messages, %d recent, %d unseen\n",
              mdata->name, mdata->uidvalidity, mdata->uid_next, mdata->messages,
              mdata->recent, mdata->unseen);
@@ -1023,6 +1044,13 @@ static int cmd_handle_untagged(struct ImapAccountData *adata)
     cmd_parse_status(adata, s);
   else if (mutt_str_startswith(s, "ENABLED", CASE_IGNORE))
     cmd_parse_enabled(adata, s);
+  else if (mutt_str_startswith(s, "OK [NOTIFICATIONOVERFLOW]", CASE_IGNORE))
+  {
+    /* The server has stopped sending events, go back to polling */
+    mutt_debug(LL_DEBUG1, "NOTIFY overflowed, disabling it\n");
+    adata->notify = false;
+    adata->capabilities &= ~IMAP_CAP_NOTIFY;
+  }
   else if (mutt_str_startswith(s, "BYE", CASE_IGNORE))
   {
     mutt_debug(LL_DEBUG2, "Handling BYE\n");
@@ -1190,6 +1218,54 @@ int imap_cmd_step(struct ImapAccountData *adata)
   return rc;
 }
 
+/**
+ * imap_cmd_running - Count the commands still waiting for a response
+ * @param adata Imap Account data
+ * @retval num Number of commands in progress
+ */
+int imap_cmd_running(struct ImapAccountData *adata)
+{
+  if (!adata || !adata->cmds)
+    return 0;
+
+  int running = 0;
+  for (int c = adata->lastcmd; c != adata->nextcmd; c = (c + 1) % adata->cmdslots)
+  {
+    if (adata->cmds[c].state == IMAP_RES_NEW)
+      running++;
+  }
+
+  return running;
+}
+
+/**
+ * imap_cmd_completed - Get the command whose tagged response was just read
+ * @param adata Imap Account data
+ * @retval ptr  Completed command
+ * @retval NULL The last response wasn't tagged
+ *
+ * While other commands are still running, imap_cmd_step() returns
+ * #IMAP_RES_CONTINUE, even if the command that completed has failed.  This
+ * lets a caller that pipelines commands check each result.
+ */
+struct ImapCommand *imap_cmd_completed(struct ImapAccountData *adata)
+{
+  if (!adata || !adata->cmds || !adata->buf || ((unsigned char) adata->buf[0] != adata->seqid))
+    return NULL;
+
+  for (int c = 0; c < adata->cmdslots; c++)
+  {
+    struct ImapCommand *cmd = &adata->cmds[c];
+    if ((cmd->state != IMAP_RES_NEW) && (cmd->seq[0] != '\0') &&
+        mutt_str_startswith(adata->buf, cmd->seq, CASE_MATCH))
+    {
+      return cmd;
+    }
+  }
+
+  return NULL;
+}
+
 /**
  * imap_code - Was the command successful
  * @param s IMAP command status
@@ -1400,3 +1476,53 @@ int imap_cmd_idle(struct ImapAccountData *adata)
 
   return 0;
 }
+
+/**
+ * imap_cmd_notify - Ask the server to report changes to the Mailboxes
+ * @param adata Imap Account data
+ * @retval  0 Success
+ * @retval -1 Failure, NOTIFY has been disabled
+ *
+ * Use NOTIFY (RFC5465) to hear about new, expunged and changed messages in
+ * the selected Mailbox, and in all the other Mailboxes of the Account.  The
+ * server sends the current STATUS of the other Mailboxes straight away.
+ */
+int imap_cmd_notify(struct ImapAccountData *adata)
+{
+  struct Buffer *cmd = mutt_buffer_pool_get();
+  mutt_buffer_strcpy(cmd, "NOTIFY SET STATUS (selected (MessageNew MessageExpunge FlagChange))");
+
+  int count = 0;
+  struct MailboxNode *np = NULL;
+  STAILQ_FOREACH(np, &adata->account->mailboxes, entries)
+  {
+    struct ImapMboxData *mdata = imap_mdata_get(np->mailbox);
+    if (!mdata || (np->mailbox->flags & MB_HIDDEN))
+      continue;
+
+    mutt_buffer_add_printf(cmd, "%s%s", (count == 0) ? " (mailboxes (" : " ", mdata->munge_name);
+    count++;
+  }
+  if (count != 0)
+    mutt_buffer_addstr(cmd, ") (MessageNew MessageExpunge FlagChange))");
+
+  int rc = imap_exec(adata, mutt_b2s(cmd), IMAP_CMD_POLL);
+  mutt_buffer_pool_release(&cmd);
+  if (rc != IMAP_EXEC_SUCCESS)
+  {
+    mutt_debug(LL_DEBUG1, "NOTIFY failed, disabling it\n");
+    adata->notify = false;
+    adata->capabilities &= ~IMAP_CAP_NOTIFY;
+    return -1;
+  }
+
+  STAILQ_FOREACH(np, &adata->account->mailboxes, entries)
+  {
+    struct ImapMboxData *mdata = imap_mdata_get(np->mailbox);
+    if (mdata && !(np->mailbox->flags & MB_HIDDEN))
+      mdata->notify = true;
+  }
+  adata->notify = true;
+
+  return 0;
+}
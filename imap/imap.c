@@ -68,6 +68,8 @@ struct stat;
 bool C_ImapDeflate; ///< Config: (imap) Compress network traffic
 #endif
 bool C_ImapIdle; ///< Config: (imap) Use the IMAP IDLE extension to check for new mail
+bool C_ImapListStatus; ///< Config: (imap) Use the IMAP LIST-STATUS extension to check mailboxes
+bool C_ImapNotify; ///< Config: (imap) Use the IMAP NOTIFY extension to check mailboxes
 bool C_ImapRfc5161; ///< Config: (imap) Use the IMAP ENABLE extension to select capabilities
 
 /**
@@ -709,6 +711,7 @@ int imap_open_connection(struct ImapAccountData *adata)
     return -1;
 
   adata->state = IMAP_CONNECTED;
+  adata->notify = false;
 
   if (imap_cmd_step(adata) != IMAP_RES_OK)
   {
@@ -1131,6 +1134,17 @@ static int imap_status(struct ImapAccountData *adata, struct ImapMboxData *mdata
     return mdata->messages;
   }
 
+  /* NOTIFY keeps it up to date, unless a change came without UNSEEN */
+  if (adata->notify && mdata->notify && !mdata->status_stale)
+    return mdata->messages;
+
+  /* imap_list_status() has just fetched it */
+  if (mdata->status_listed)
+  {
+    mdata->status_listed = false;
+    return mdata->messages;
+  }
+
   if (adata->capabilities & IMAP_CAP_IMAP4REV1)
     uidvalidity_flag = "UIDVALIDITY";
   else if (adata->capabilities & IMAP_CAP_STATUS)
@@ -1202,6 +1216,132 @@ int imap_mailbox_status(struct Mailbox *m, bool queue)
   return imap_status(adata, mdata, queue);
 }
 
+/**
+ * imap_notify_check - Keep up with changes to all Mailboxes using NOTIFY
+ *
+ * If the server supports NOTIFY (RFC5465), register all the Mailboxes of an
+ * Account, then just read the STATUS responses the server sends when they
+ * change.  imap_status() doesn't need to poll these Mailboxes.
+ *
+ * The server needn't say how many messages are unseen.  If it doesn't, the
+ * whole STATUS is fetched straight away.
+ */
+void imap_notify_check(void)
+{
+  if (!C_ImapNotify)
+    return;
+
+  struct Account *np = NULL;
+  TAILQ_FOREACH(np, &NeoMutt->accounts, entries)
+  {
+    if (np->type != MUTT_IMAP)
+      continue;
+
+    struct ImapAccountData *adata = np->adata;
+    if (!adata || (adata->state < IMAP_AUTHENTICATED) ||
+        !(adata->capabilities & IMAP_CAP_NOTIFY))
+    {
+      continue;
+    }
+
+    /* Register again if there's a new Mailbox */
+    bool registered = adata->notify;
+    struct MailboxNode *mn = NULL;
+    STAILQ_FOREACH(mn, &np->mailboxes, entries)
+    {
+      struct ImapMboxData *mdata = imap_mdata_get(mn->mailbox);
+      if (mdata && !mdata->notify && !(mn->mailbox->flags & MB_HIDDEN))
+        registered = false;
+    }
+
+    if (!registered)
+    {
+      imap_cmd_notify(adata);
+      continue;
+    }
+
+    /* Handle the events the server has sent */
+    while (mutt_socket_poll(adata->conn, 0) > 0)
+    {
+      if (imap_cmd_step(adata) == IMAP_RES_BAD)
+        break;
+    }
+
+    /* Ask for the whole STATUS if an event didn't include UNSEEN */
+    bool queued = false;
+    STAILQ_FOREACH(mn, &np->mailboxes, entries)
+    {
+      struct ImapMboxData *mdata = imap_mdata_get(mn->mailbox);
+      if (mdata && mdata->notify && mdata->status_stale && (adata->mailbox != mn->mailbox))
+      {
+        imap_status(adata, mdata, true);
+        queued = true;
+      }
+    }
+    if (queued)
+      imap_exec(adata, NULL, IMAP_CMD_POLL);
+  }
+}
+
+/**
+ * imap_list_status - Refresh the number of total and new messages of all Mailboxes
+ *
+ * If the server supports LIST-STATUS (RFC5819), ask for the STATUS of every
+ * Mailbox of an Account with a single LIST command, rather than one STATUS
+ * command each.  imap_status() then uses the results instead of asking again.
+ */
+void imap_list_status(void)
+{
+  if (!C_ImapListStatus)
+    return;
+
+  struct Buffer *cmd = mutt_buffer_pool_get();
+  struct Account *np = NULL;
+  TAILQ_FOREACH(np, &NeoMutt->accounts, entries)
+  {
+    if (np->type != MUTT_IMAP)
+      continue;
+
+    struct ImapAccountData *adata = np->adata;
+    if (!adata || (adata->state < IMAP_AUTHENTICATED) ||
+        !(adata->capabilities & IMAP_CAP_LIST_EXTENDED) ||
+        !(adata->capabilities & IMAP_CAP_LIST_STATUS))
+    {
+      continue;
+    }
+
+    int count = 0;
+    mutt_buffer_strcpy(cmd, "LIST \"\" (");
+    struct MailboxNode *mn = NULL;
+    STAILQ_FOREACH(mn, &np->mailboxes, entries)
+    {
+      struct Mailbox *m = mn->mailbox;
+      struct ImapMboxData *mdata = imap_mdata_get(m);
+      if (!mdata || (m->flags & MB_HIDDEN) || (adata->mailbox == m) ||
+          (adata->notify && mdata->notify && !mdata->status_stale))
+      {
+        continue;
+      }
+
+      mdata->status_listed = false;
+      mutt_buffer_add_printf(cmd, "%s%s", (count == 0) ? "" : " ", mdata->munge_name);
+      count++;
+    }
+
+    /* A single STATUS is just as quick */
+    if (count < 2)
+      continue;
+
+    mutt_buffer_addstr(cmd, ") RETURN (STATUS (MESSAGES RECENT UIDNEXT UIDVALIDITY UNSEEN))");
+
+    adata->list_status = true;
+    if (imap_exec(adata, mutt_b2s(cmd), IMAP_CMD_POLL) != IMAP_EXEC_SUCCESS)
+      mutt_debug(LL_DEBUG1, "LIST-STATUS failed, falling back to STATUS\n");
+    adata->list_status = false;
+  }
+  mutt_buffer_pool_release(&cmd);
+}
+
 /**
  * imap_subscribe - Subscribe to a mailbox
  * @param path      Mailbox path
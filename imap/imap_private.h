@@ -137,8 +137,10 @@ typedef uint32_t ImapCapFlags;              ///< Flags, e.g. #IMAP_CAP_IMAP4
 #define IMAP_CAP_LIST_EXTENDED    (1 << 16) ///< RFC5258: IMAP4 LIST Command Extensions
 #define IMAP_CAP_COMPRESS         (1 << 17) ///< RFC4978: COMPRESS=DEFLATE
 #define IMAP_CAP_X_GM_EXT_1       (1 << 18) ///< https://developers.google.com/gmail/imap/imap-extensions
+#define IMAP_CAP_LIST_STATUS      (1 << 19) ///< RFC5819: LIST-STATUS
+#define IMAP_CAP_NOTIFY           (1 << 20) ///< RFC5465: NOTIFY
 
-#define IMAP_CAP_ALL             ((1 << 19) - 1)
+#define IMAP_CAP_ALL             ((1 << 21) - 1)
 
 /**
  * struct ImapList - Items in an IMAP browser
@@ -190,6 +192,8 @@ struct ImapAccountData
 
   bool unicode; /* If true, we can send UTF-8, and the server will use UTF8 rather than mUTF7 */
   bool qresync; /* true, if QRESYNC is successfully ENABLE'd */
+  bool list_status; /* true, while a LIST ... RETURN (STATUS) is running */
+  bool notify; /* true, if the server is reporting changes with NOTIFY */
 
   /* if set, the response parser will store results for complicated commands
    * here. */
@@ -231,6 +235,9 @@ struct ImapMboxData
   unsigned int messages;
   unsigned int recent;
   unsigned int unseen;
+  bool status_listed;  ///< STATUS arrived with the last LIST-STATUS
+  bool notify;         ///< Changes are reported by NOTIFY
+  bool status_stale;   ///< A STATUS arrived without UNSEEN, ask for all of it
 
   // Cached data used only when the mailbox is opened
   struct Hash *uid_hash;
@@ -238,6 +245,8 @@ struct ImapMboxData
   size_t msn_index_size;       ///< allocation size
   unsigned int max_msn;        ///< the largest MSN fetched so far
   struct BodyCache *bcache;
+  long prefetch_bytes;         ///< Size of the message bodies fetched in the background
+  bool prefetch_done;          ///< Nothing left to download in the background
 
   header_cache_t *hcache;
 };
@@ -283,6 +292,9 @@ bool imap_code(const char *s);
 const char *imap_cmd_trailer(struct ImapAccountData *adata);
 int imap_exec(struct ImapAccountData *adata, const char *cmdstr, ImapCmdFlags flags);
 int imap_cmd_idle(struct ImapAccountData *adata);
+int imap_cmd_notify(struct ImapAccountData *adata);
+int imap_cmd_running(struct ImapAccountData *adata);
+struct ImapCommand *imap_cmd_completed(struct ImapAccountData *adata);
 
 /* message.c */
 void imap_edata_free(void **ptr);
@@ -71,11 +71,14 @@ extern struct Slist *C_ImapAuthenticators;
 extern bool C_ImapDeflate;
 #endif
 extern bool C_ImapIdle;
+extern bool C_ImapListStatus;
+extern bool C_ImapNotify;
 extern bool C_ImapRfc5161;
 
 /* These Config Variables are only used in imap/message.c */
 extern char *C_ImapHeaders;
 extern long C_ImapFetchChunkSize;
+extern long C_ImapPrefetchSize;
 
 /* These Config Variables are only used in imap/command.c */
 extern bool C_ImapServernoise;
@@ -94,6 +97,8 @@ int imap_delete_mailbox(struct Mailbox *m, char *path);
 int imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close);
 int imap_path_status(const char *path, bool queue);
 int imap_mailbox_status(struct Mailbox *m, bool queue);
+void imap_list_status(void);
+void imap_notify_check(void);
 int imap_subscribe(char *path, bool subscribe);
 int imap_complete(char *buf, size_t buflen, const char *path);
 int imap_fast_trash(struct Mailbox *m, char *dest);
@@ -109,6 +114,7 @@ int imap_mailbox_rename(const char *path);
 
 /* message.c */
 int imap_copy_messages(struct Mailbox *m, struct EmailList *el, const char *dest, bool delete_original);
+bool imap_prefetch(bool fetch);
 
 /* socket.c */
 void imap_logout_all(void);
@@ -66,6 +66,9 @@ struct BodyCache;
 /* These Config Variables are only used in imap/message.c */
 char *C_ImapHeaders; ///< Config: (imap) Additional email headers to download when getting index
 long C_ImapFetchChunkSize; ///< Config: (imap) Download headers in blocks of this size
+long C_ImapPrefetchSize; ///< Config: (imap) Download this many bytes of message bodies in the background
+
+#define PREFETCH_BATCH_BYTES (128 * 1024) ///< Prefetch about this much between checks for a key
 
 /**
  * imap_edata_free - free ImapHeader structure
@@ -1112,155 +1115,192 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
 
   buf = mutt_buffer_pool_get();
 
-  /* NOTE:
-   *   The (fetch_msn_end < msn_end) used to be important to prevent
-   *   an infinite loop, in the event the server did not return all
-   *   the headers (due to a pending expunge, for example).
-   *
-   *   I believe the new chunking imap_fetch_msn_seqset()
-   *   implementation and "msn_begin = fetch_msn_end + 1" assignment
-   *   at the end of the loop makes the comparison unneeded, but to be
-   *   cautious I'm keeping it.
-   */
-  while ((fetch_msn_end < msn_end) &&
-         imap_fetch_msn_seqset(buf, adata, evalhc, msn_begin, msn_end, &fetch_msn_end))
+  /* Keep several chunks in flight, so that a high-latency link isn't idle
+   * while we wait for each FETCH to complete.  The responses are parsed as
+   * they arrive, whichever command they belong to.  Stay within the
+   * connection's pipeline, so that queueing never has to drain it. */
+  const int depth = MAX(adata->cmdslots - 2, 1);
+  int running = 0;
+  int msgno = msn_begin;
+
+#ifdef USE_HCACHE
+  /* Write the headers of each chunk to the cache in a single batch */
+  mutt_hcache_begin(mdata->hcache);
+#endif
+
+  while (true)
   {
-    char *cmd = NULL;
-    mutt_str_asprintf(&cmd, "FETCH %s (UID FLAGS INTERNALDATE RFC822.SIZE %s)",
-                      mutt_b2s(buf), hdrreq);
-    imap_cmd_start(adata, cmd);
-    FREE(&cmd);
-
-    rc = IMAP_RES_CONTINUE;
-    for (int msgno = msn_begin; rc == IMAP_RES_CONTINUE; msgno++)
+    /* In case we get new mail while fetching the headers. */
+    if (mdata->reopen & IMAP_NEWMAIL_PENDING)
     {
-      if (initial_download && SigInt && query_abort_header_download(adata))
-        goto bail;
+      msn_end = mdata->new_mail_count;
+      while (msn_end > m->email_max)
+        mx_alloc_memory(m);
+      alloc_msn_index(adata, msn_end);
+      mdata->reopen &= ~IMAP_NEWMAIL_PENDING;
+      mdata->new_mail_count = 0;
+    }
 
-      if (m->verbose)
-        mutt_progress_update(&progress, msgno, -1);
+    /* NOTE:
+     *   The (fetch_msn_end < msn_end) used to be important to prevent
+     *   an infinite loop, in the event the server did not return all
+     *   the headers (due to a pending expunge, for example).
+     *
+     *   I believe the new chunking imap_fetch_msn_seqset()
+     *   implementation and "msn_begin = fetch_msn_end + 1" assignment
+     *   makes the comparison unneeded, but to be cautious I'm keeping it.
+     *
+     * Note: RFC3501 section 7.4.1 and RFC7162 section 3.2.10.2 say we
+     * must not get any EXPUNGE/VANISHED responses in the middle of a
+     * FETCH, nor when no command is in progress (e.g. between the
+     * chunked FETCH commands).  We previously tried to be robust by
+     * setting:
+     *   msn_begin = mdata->max_msn + 1;
+     * but with chunking (and the mythical header cache holes) this
+     * may not be correct.  So here we must assume the msn values have
+     * not been altered during or after the fetch.  */
+    running = imap_cmd_running(adata);
+    while ((running < depth) && (fetch_msn_end < msn_end) &&
+           imap_fetch_msn_seqset(buf, adata, evalhc, msn_begin, msn_end, &fetch_msn_end))
+    {
+      char *cmd = NULL;
+      mutt_str_asprintf(&cmd, "FETCH %s (UID FLAGS INTERNALDATE RFC822.SIZE %s)",
+                        mutt_b2s(buf), hdrreq);
+      imap_cmd_start(adata, cmd);
+      FREE(&cmd);
+      msn_begin = fetch_msn_end + 1;
+      running++;
+    }
 
-      rewind(fp);
-      memset(&h, 0, sizeof(h));
-      h.edata = imap_edata_new();
+    if (running == 0)
+      break;
+
+    if (initial_download && SigInt && query_abort_header_download(adata))
+      goto bail;
 
-      /* this DO loop does two things:
-       * 1. handles untagged messages, so we can try again on the same msg
-       * 2. fetches the tagged response at the end of the last message.  */
-      do
+    if (m->verbose)
+      mutt_progress_update(&progress, msgno, -1);
+
+    rewind(fp);
+    memset(&h, 0, sizeof(h));
+    h.edata = imap_edata_new();
+
+    /* this DO loop does two things:
+     * 1. handles untagged messages, so we can try again on the same msg
+     * 2. fetches the tagged response at the end of the last message.  */
+    do
+    {
+      rc = imap_cmd_step(adata);
+
+      /* Check each command as it completes, not just the last one */
+      struct ImapCommand *cmd = imap_cmd_completed(adata);
+      if (cmd && ((cmd->state == IMAP_RES_NO) || (cmd->state == IMAP_RES_BAD)))
       {
-        rc = imap_cmd_step(adata);
-        if (rc != IMAP_RES_CONTINUE)
-          break;
+        rc = cmd->state;
+        break;
+      }
 
-        mfhrc = msg_fetch_header(m, &h, adata->buf, fp);
-        if (mfhrc < 0)
-          continue;
+      if (rc != IMAP_RES_CONTINUE)
+        break;
 
-        if (!ftello(fp))
-        {
-          mutt_debug(LL_DEBUG2, "ignoring fetch response with no body\n");
-          continue;
-        }
+      mfhrc = msg_fetch_header(m, &h, adata->buf, fp);
+      if (mfhrc < 0)
+        continue;
 
-        /* make sure we don't get remnants from older larger message headers */
-        fputs("\n\n", fp);
+      if (!ftello(fp))
+      {
+        mutt_debug(LL_DEBUG2, "ignoring fetch response with no body\n");
+        continue;
+      }
 
-        if ((h.edata->msn < 1) || (h.edata->msn > fetch_msn_end))
-        {
-          mutt_debug(LL_DEBUG1, "skipping FETCH response for unknown message number %d\n",
-                     h.edata->msn);
-          continue;
-        }
+      /* make sure we don't get remnants from older larger message headers */
+      fputs("\n\n", fp);
 
-        /* May receive FLAGS updates in a separate untagged response */
-        if (mdata->msn_index[h.edata->msn - 1])
-        {
-          mutt_debug(LL_DEBUG2, "skipping FETCH response for duplicate message %d\n",
-                     h.edata->msn);
-          continue;
-        }
+      if ((h.edata->msn < 1) || (h.edata->msn > fetch_msn_end))
+      {
+        mutt_debug(LL_DEBUG1, "skipping FETCH response for unknown message number %d\n",
+                   h.edata->msn);
+        continue;
+      }
 
-        struct Email *e = email_new();
-        m->emails[idx] = e;
+      /* May receive FLAGS updates in a separate untagged response */
+      if (mdata->msn_index[h.edata->msn - 1])
+      {
+        mutt_debug(LL_DEBUG2, "skipping FETCH response for duplicate message %d\n",
+                   h.edata->msn);
+        continue;
+      }
 
-        mdata->max_msn = MAX(mdata->max_msn, h.edata->msn);
-        mdata->msn_index[h.edata->msn - 1] = e;
-        mutt_hash_int_insert(mdata->uid_hash, h.edata->uid, e);
+      struct Email *e = email_new();
+      m->emails[idx] = e;
 
-        e->index = idx;
-        /* messages which have not been expunged are ACTIVE (borrowed from mh
-         * folders) */
-        e->active = true;
-        e->changed = false;
-        e->read = h.edata->read;
-        e->old = h.edata->old;
-        e->deleted = h.edata->deleted;
-        e->flagged = h.edata->flagged;
-        e->replied = h.edata->replied;
-        e->received = h.received;
-        e->edata = (void *) (h.edata);
-        e->edata_free = imap_edata_free;
-        STAILQ_INIT(&e->tags);
+      mdata->max_msn = MAX(mdata->max_msn, h.edata->msn);
+      mdata->msn_index[h.edata->msn - 1] = e;
+      mutt_hash_int_insert(mdata->uid_hash, h.edata->uid, e);
 
-        /* We take a copy of the tags so we can split the string */
-        char *tags_copy = mutt_str_strdup(h.edata->flags_remote);
-        driver_tags_replace(&e->tags, tags_copy);
-        FREE(&tags_copy);
+      e->index = idx;
+      /* messages which have not been expunged are ACTIVE (borrowed from mh
+       * folders) */
+      e->active = true;
+      e->changed = false;
+      e->read = h.edata->read;
+      e->old = h.edata->old;
+      e->deleted = h.edata->deleted;
+      e->flagged = h.edata->flagged;
+      e->replied = h.edata->replied;
+      e->received = h.received;
+      e->edata = (void *) (h.edata);
+      e->edata_free = imap_edata_free;
+      STAILQ_INIT(&e->tags);
 
-        if (*maxuid < h.edata->uid)
-          *maxuid = h.edata->uid;
+      /* We take a copy of the tags so we can split the string */
+      char *tags_copy = mutt_str_strdup(h.edata->flags_remote);
+      driver_tags_replace(&e->tags, tags_copy);
+      FREE(&tags_copy);
 
-        rewind(fp);
-        /* NOTE: if Date: header is missing, mutt_rfc822_read_header depends
-         *   on h.received being set */
-        e->env = mutt_rfc822_read_header(fp, e, false, false);
-        /* content built as a side-effect of mutt_rfc822_read_header */
-        e->content->length = h.content_length;
-        mailbox_size_add(m, e);
+      if (*maxuid < h.edata->uid)
+        *maxuid = h.edata->uid;
+
+      rewind(fp);
+      /* NOTE: if Date: header is missing, mutt_rfc822_read_header depends
+       *   on h.received being set */
+      e->env = mutt_rfc822_read_header(fp, e, false, false);
+      /* content built as a side-effect of mutt_rfc822_read_header */
+      e->content->length = h.content_length;
+      mailbox_size_add(m, e);
 
 #ifdef USE_HCACHE
-        imap_hcache_put(mdata, e);
+      imap_hcache_put(mdata, e);
 #endif /* USE_HCACHE */
 
-        m->msg_count++;
+      m->msg_count++;
 
-        h.edata = NULL;
-        idx++;
-      } while (mfhrc == -1);
+      h.edata = NULL;
+      idx++;
+      msgno++;
+    } while (mfhrc == -1);
 
-      imap_edata_free((void **) &h.edata);
+    imap_edata_free((void **) &h.edata);
 
-      if ((mfhrc < -1) || ((rc != IMAP_RES_CONTINUE) && (rc != IMAP_RES_OK)))
-        goto bail;
-    }
+    if ((mfhrc < -1) || ((rc != IMAP_RES_CONTINUE) && (rc != IMAP_RES_OK)))
+      goto bail;
 
-    /* In case we get new mail while fetching the headers. */
-    if (mdata->reopen & IMAP_NEWMAIL_PENDING)
+#ifdef USE_HCACHE
+    /* A chunk has finished */
+    if (imap_cmd_running(adata) < running)
     {
-      msn_end = mdata->new_mail_count;
-      while (msn_end > m->email_max)
-        mx_alloc_memory(m);
-      alloc_msn_index(adata, msn_end);
-      mdata->reopen &= ~IMAP_NEWMAIL_PENDING;
-      mdata->new_mail_count = 0;
+      mutt_hcache_commit(mdata->hcache);
+      mutt_hcache_begin(mdata->hcache);
     }
-
-    /* Note: RFC3501 section 7.4.1 and RFC7162 section 3.2.10.2 say we
-     * must not get any EXPUNGE/VANISHED responses in the middle of a
-     * FETCH, nor when no command is in progress (e.g. between the
-     * chunked FETCH commands).  We previously tried to be robust by
-     * setting:
-     *   msn_begin = mdata->max_msn + 1;
-     * but with chunking (and the mythical header cache holes) this
-     * may not be correct.  So here we must assume the msn values have
-     * not been altered during or after the fetch.  */
-    msn_begin = fetch_msn_end + 1;
+#endif
   }
 
   retval = 0;
 
 bail:
+#ifdef USE_HCACHE
+  mutt_hcache_commit(mdata->hcache);
+#endif
   mutt_buffer_pool_release(&hdr_list);
   mutt_buffer_pool_release(&buf);
   mutt_buffer_pool_release(&tempfile);
@@ -1318,6 +1358,7 @@ int imap_read_headers(struct Mailbox *m, unsigned int msn_begin,
   oldmsgcount = m->msg_count;
   mdata->reopen &= ~(IMAP_REOPEN_ALLOW | IMAP_NEWMAIL_PENDING);
   mdata->new_mail_count = 0;
+  mdata->prefetch_done = false;
 
 #ifdef USE_HCACHE
   mdata->hcache = imap_hcache_open(adata, mdata);
@@ -2127,3 +2168,216 @@ int imap_msg_save_hcache(struct Mailbox *m, struct Email *e)
 #endif
   return rc;
 }
+
+/**
+ * prefetch_read_body - Save a body from a FETCH response to the message cache
+ * @param m     Selected Imap Mailbox
+ * @param msn   Message Sequence Number from the response
+ * @param bytes Size of the literal that follows
+ * @retval  0 Success
+ * @retval -1 Failure, the connection is unusable
+ */
+static int prefetch_read_body(struct Mailbox *m, unsigned int msn, unsigned int bytes)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  struct Email *e = NULL;
+  if ((msn >= 1) && (msn <= mdata->max_msn))
+    e = mdata->msn_index[msn - 1];
+
+  FILE *fp = e ? msg_cache_put(m, e) : NULL;
+  const bool cache = (fp != NULL);
+  if (!fp)
+    fp = mutt_file_fopen("/dev/null", "w");
+  if (!fp)
+    return -1;
+
+  int rc = imap_read_literal(fp, adata, bytes, NULL);
+  if (cache)
+  {
+    fflush(fp);
+    if ((rc == 0) && !ferror(fp))
+      msg_cache_commit(m, e);
+  }
+  mutt_file_fclose(&fp);
+
+  return rc;
+}
+
+/**
+ * imap_prefetch_bodies - Download a batch of message bodies into the message cache
+ * @param m Selected Imap Mailbox
+ * @retval true There may be more bodies to download
+ *
+ * Unread messages are fetched first, then the rest, in the order of the index.
+ * One FETCH per message is pipelined, up to the connection's pipeline depth,
+ * until the batch holds about #PREFETCH_BATCH_BYTES.  The keyboard isn't read
+ * while a batch downloads, so it's kept small; a message that's larger than
+ * that is fetched on its own.  Messages are never marked as read.
+ *
+ * The sizes are those in the index, both for the batch and $imap_prefetch_size.
+ */
+static bool imap_prefetch_bodies(struct Mailbox *m)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  if (!adata || (adata->mailbox != m) || (adata->state < IMAP_SELECTED) ||
+      (adata->status == IMAP_FATAL) || mdata->prefetch_done)
+  {
+    return false;
+  }
+
+  /* Don't interrupt a command that's already running */
+  if (imap_cmd_running(adata) != 0)
+    return false;
+
+  mdata->bcache = msg_cache_open(m);
+  if (!mdata->bcache || !(adata->capabilities & IMAP_CAP_IMAP4REV1))
+  {
+    mdata->prefetch_done = true;
+    return false;
+  }
+
+  const int depth = MAX(adata->cmdslots - 2, 1);
+  long batch = 0;
+  int queued = 0;
+  char buf[64];
+
+  for (int pass = 0; (pass < 2) && (queued < depth) && (batch < PREFETCH_BATCH_BYTES); pass++)
+  {
+    for (int i = 0; (i < m->vcount) && (queued < depth) && (batch < PREFETCH_BATCH_BYTES); i++)
+    {
+      struct Email *e = m->emails[m->v2r[i]];
+      if (!e || !e->active || e->deleted || ((pass == 0) && e->read))
+        continue;
+
+      struct ImapEmailData *edata = imap_edata_get(e);
+      if (edata->prefetched)
+        continue;
+
+      snprintf(buf, sizeof(buf), "%u-%u", mdata->uidvalidity, edata->uid);
+      if (mutt_bcache_exists(mdata->bcache, buf) == 0)
+      {
+        edata->prefetched = true;
+        continue;
+      }
+
+      if (e->content->length > (C_ImapPrefetchSize - mdata->prefetch_bytes))
+        continue;
+
+      edata->prefetched = true;
+      mdata->prefetch_bytes += e->content->length;
+      batch += e->content->length;
+
+      snprintf(buf, sizeof(buf), "UID FETCH %u BODY.PEEK[]", edata->uid);
+      if (imap_exec(adata, buf, IMAP_CMD_QUEUE) != IMAP_EXEC_SUCCESS)
+        return false;
+      queued++;
+    }
+  }
+
+  if (queued == 0)
+  {
+    mdata->prefetch_done = true;
+    return false;
+  }
+
+  mutt_debug(LL_DEBUG2, "prefetching %d message bodies\n", queued);
+  if (imap_cmd_start(adata, NULL) < 0)
+    return false;
+
+  int rc;
+  do
+  {
+    rc = imap_cmd_step(adata);
+    if (rc != IMAP_RES_CONTINUE)
+      break;
+
+    char *pc = imap_next_word(adata->buf);
+    unsigned int msn = 0;
+    if (!mutt_str_startswith(adata->buf, "* ", CASE_MATCH) ||
+        (mutt_str_atoui(pc, &msn) < 0))
+    {
+      continue;
+    }
+
+    pc = imap_next_word(pc);
+    if (!mutt_str_startswith(pc, "FETCH", CASE_IGNORE))
+      continue;
+
+    while (*pc)
+    {
+      pc = imap_next_word(pc);
+      if (pc[0] == '(')
+        pc++;
+      if (mutt_str_startswith(pc, "BODY[]", CASE_IGNORE))
+      {
+        unsigned int bytes;
+        pc = imap_next_word(pc);
+        if ((imap_get_literal_count(pc, &bytes) < 0) ||
+            (prefetch_read_body(m, msn, bytes) < 0))
+        {
+          mdata->prefetch_done = true;
+          return false;
+        }
+        /* pick up trailing line */
+        rc = imap_cmd_step(adata);
+        if (rc != IMAP_RES_CONTINUE)
+          break;
+        pc = adata->buf;
+      }
+    }
+  } while (rc == IMAP_RES_CONTINUE);
+
+  if (rc != IMAP_RES_OK)
+  {
+    mdata->prefetch_done = true;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * imap_prefetch - Download message bodies while the user is idle
+ * @param fetch If false, only check whether there's anything to download
+ * @retval true There may be more bodies to download
+ *
+ * Each call downloads one batch of bodies for the selected mailbox of the
+ * first IMAP Account that has anything left to fetch, until
+ * $imap_prefetch_size bytes have been downloaded.  An Account that's idling
+ * or still running a command is skipped.
+ */
+bool imap_prefetch(bool fetch)
+{
+  if (C_ImapPrefetchSize <= 0)
+    return false;
+
+  struct Account *np = NULL;
+  TAILQ_FOREACH(np, &NeoMutt->accounts, entries)
+  {
+    if (np->type != MUTT_IMAP)
+      continue;
+
+    struct ImapAccountData *adata = np->adata;
+    if (!adata || !adata->mailbox || (adata->state < IMAP_SELECTED))
+      continue;
+
+    struct ImapMboxData *mdata = imap_mdata_get(adata->mailbox);
+    if (!mdata || mdata->prefetch_done)
+      continue;
+
+    /* Don't interrupt IDLE, or a command that's already running */
+    if ((adata->state == IMAP_IDLE) || (imap_cmd_running(adata) != 0))
+      continue;
+
+    if (!fetch)
+      return true;
+
+    return imap_prefetch_bodies(adata->mailbox);
+  }
+
+  return false;
+}
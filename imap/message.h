@@ -40,6 +40,7 @@ struct ImapEmailData
   bool replied : 1;
 
   bool parsed : 1;
+  bool prefetched : 1;
 
   unsigned int uid; ///< 32-bit Message UID
   unsigned int msn; ///< Message Sequence Number
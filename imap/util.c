@@ -225,6 +225,8 @@ void imap_mdata_cache_reset(struct ImapMboxData *mdata)
   mdata->msn_index_size = 0;
   mdata->max_msn = 0;
   mutt_bcache_close(&mdata->bcache);
+  mdata->prefetch_bytes = 0;
+  mdata->prefetch_done = false;
 }
 
 /**
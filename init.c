@@ -1735,6 +1735,24 @@ int reply_validator(const struct ConfigSet *cs, const struct ConfigDef *cdef,
   return CSR_ERR_INVALID;
 }
 
+#ifdef USE_PTHREAD
+/**
+ * threads_validator - Validate a config variable holding a number of threads - Implements ConfigDef::validator()
+ */
+int threads_validator(const struct ConfigSet *cs, const struct ConfigDef *cdef,
+                      intptr_t value, struct Buffer *err)
+{
+  const int max_threads = 32;
+
+  if ((value >= 0) && (value <= max_threads))
+    return CSR_SUCCESS;
+
+  mutt_buffer_printf(err, _("Option %s must be between %d and %d inclusive"),
+                     cdef->name, 0, max_threads);
+  return CSR_ERR_INVALID;
+}
+#endif
+
 /**
  * wrapheaders_validator - Validate the "wrap_headers" config variable - Implements ConfigDef::validator()
  */
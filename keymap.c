@@ -30,6 +30,7 @@
 #include <ctype.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -631,6 +632,33 @@ int km_dokey(enum MenuType menu)
   {
     int i = (C_Timeout > 0) ? C_Timeout : 60;
 #ifdef USE_IMAP
+    /* After a second without a key, download message bodies, a batch at a
+     * time.  Stop after $timeout seconds, so the caller can check for mail. */
+    int prefetch_wait = 1000;
+    const uint64_t prefetch_start = mutt_date_epoch_ms();
+    while ((menu != MENU_EDITOR) && imap_prefetch(false))
+    {
+      mutt_getch_timeout(prefetch_wait);
+      tmp = mutt_getch();
+      mutt_getch_timeout(-1);
+      if ((tmp.ch != -2) || SigWinch)
+        goto gotkey;
+#ifdef USE_INOTIFY
+      if (MonitorFilesChanged)
+        goto gotkey;
+#endif
+      if (!imap_prefetch(true))
+        break;
+      prefetch_wait = 0;
+
+      const uint64_t elapsed = mutt_date_epoch_ms() - prefetch_start;
+      if (elapsed >= (uint64_t) i * 1000)
+        goto gotkey;
+    }
+    i -= (mutt_date_epoch_ms() - prefetch_start) / 1000;
+    if (i < 1)
+      i = 1;
+
     /* keepalive may need to run more frequently than C_Timeout allows */
     if (C_ImapKeepalive)
     {
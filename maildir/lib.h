@@ -25,11 +25,12 @@
  *
  * Maildir local mailbox type
  *
- * | File              | Description              |
- * | :---------------- | :----------------------- |
- * | maildir/maildir.c | @subpage maildir_maildir |
- * | maildir/mh.c      | @subpage maildir_mh      |
- * | maildir/shared.c  | @subpage maildir_shared  |
+ * | File               | Description               |
+ * | :----------------- | :------------------------ |
+ * | maildir/maildir.c  | @subpage maildir_maildir  |
+ * | maildir/mh.c       | @subpage maildir_mh       |
+ * | maildir/prefetch.c | @subpage maildir_prefetch |
+ * | maildir/shared.c   | @subpage maildir_shared   |
  */
 
 #ifndef MUTT_MAILDIR_LIB_H
@@ -54,6 +55,9 @@ extern char *C_MhSeqFlagged;
 extern char *C_MhSeqReplied;
 extern char *C_MhSeqUnseen;
 
+/* These Config Variables are only used in maildir/prefetch.c */
+extern short C_MaildirReadThreads;
+
 extern struct MxOps MxMaildirOps;
 extern struct MxOps MxMhOps;
 
@@ -33,6 +33,7 @@ struct Account;
 struct Buffer;
 struct Email;
 struct Mailbox;
+struct MaildirPrefetch;
 struct Message;
 struct Progress;
 
@@ -106,6 +107,11 @@ void                    mh_update_maildir      (struct Maildir *md, struct MhSeq
 void                    mh_update_sequences    (struct Mailbox *m);
 bool                    mh_valid_message       (const char *s);
 
+/* Read-ahead of message files */
+void                    maildir_prefetch_advance(struct MaildirPrefetch *pf, size_t pos);
+void                    maildir_prefetch_free   (struct MaildirPrefetch **ptr);
+struct MaildirPrefetch *maildir_prefetch_new    (const char *folder, struct Maildir **mds, size_t num, int threads);
+
 int mh_sync_message(struct Mailbox *m, int msgno);
 int maildir_sync_message(struct Mailbox *m, int msgno);
 int mh_rewrite_message(struct Mailbox *m, int msgno);
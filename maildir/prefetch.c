@@ -0,0 +1,266 @@
+/**
+ * @file
+ * Read-ahead of Maildir/MH message files
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page maildir_prefetch Read-ahead of Maildir/MH message files
+ *
+ * When a large Maildir/MH mailbox is opened with a cold header cache, every
+ * message file has to be opened and its headers parsed.  The parsing code
+ * relies on global state (buffer pool, charset conversion, logging), so it
+ * must run on the main thread.  Most of the time, though, is spent waiting
+ * for the disk.
+ *
+ * This pool of worker threads runs a little way ahead of the parser, reading
+ * the header block of each file into the page cache.  By the time the main
+ * thread opens the file, the data is already in memory.
+ *
+ * The workers only use system calls; they never touch the Email objects.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "maildir_private.h"
+#include "mutt/lib.h"
+#include "email/lib.h"
+#ifdef USE_PTHREAD
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
+/* These Config Variables are only used in maildir/prefetch.c */
+short C_MaildirReadThreads; ///< Config: (maildir,mh) Number of threads used to read ahead when opening a mailbox
+
+#ifdef USE_PTHREAD
+
+#define PREFETCH_WINDOW 256            ///< Maximum number of files to read ahead of the parser
+#define PREFETCH_MAX_HEADER (256 * 1024) ///< Stop reading a file after this many bytes
+
+/**
+ * struct MaildirPrefetch - Pool of threads reading message files ahead of the parser
+ */
+struct MaildirPrefetch
+{
+  char **paths;          ///< Full paths of the message files
+  size_t num_paths;      ///< Number of paths
+  size_t next;           ///< Next file a worker should read
+  size_t cursor;         ///< File the main thread is parsing
+  bool stop;             ///< Tell the workers to finish
+  int num_threads;       ///< Number of running workers
+  pthread_t *threads;    ///< Worker threads
+  pthread_mutex_t lock;  ///< Protects next, cursor and stop
+  pthread_cond_t cond;   ///< Signalled when the cursor moves, or on stop
+};
+
+/**
+ * prefetch_read - Read the header block of a message file
+ * @param path Path to the message file
+ *
+ * The data is discarded, we only want it in the page cache.
+ */
+static void prefetch_read(const char *path)
+{
+  char buf[4096];
+  size_t total = 0;
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return;
+
+  while (total < PREFETCH_MAX_HEADER)
+  {
+    ssize_t len = read(fd, buf, sizeof(buf));
+    if (len <= 0)
+      break;
+    total += len;
+    if (memmem(buf, len, "\n\n", 2))
+      break;
+  }
+
+  close(fd);
+}
+
+/**
+ * prefetch_worker - Worker thread reading files ahead of the main thread
+ * @param arg Prefetch pool
+ * @retval NULL Always
+ */
+static void *prefetch_worker(void *arg)
+{
+  struct MaildirPrefetch *pf = arg;
+
+  pthread_mutex_lock(&pf->lock);
+  while (true)
+  {
+    /* Don't bother with files the main thread has already reached */
+    if (pf->next <= pf->cursor)
+      pf->next = pf->cursor + 1;
+
+    if (pf->stop || (pf->next >= pf->num_paths))
+      break;
+
+    if (pf->next >= (pf->cursor + PREFETCH_WINDOW))
+    {
+      pthread_cond_wait(&pf->cond, &pf->lock);
+      continue;
+    }
+
+    const char *path = pf->paths[pf->next++];
+    pthread_mutex_unlock(&pf->lock);
+    prefetch_read(path);
+    pthread_mutex_lock(&pf->lock);
+  }
+  pthread_mutex_unlock(&pf->lock);
+
+  return NULL;
+}
+
+/**
+ * maildir_prefetch_new - Start reading message files in the background
+ * @param folder  Path to the mailbox
+ * @param mds     Maildir entries that will be parsed, in order
+ * @param num     Number of entries
+ * @param threads Number of worker threads to use
+ * @retval ptr  Prefetch pool
+ * @retval NULL Prefetching is disabled, or not worthwhile
+ *
+ * The caller must tell the pool about its progress with
+ * maildir_prefetch_advance() and free it with maildir_prefetch_free().
+ */
+struct MaildirPrefetch *maildir_prefetch_new(const char *folder, struct Maildir **mds,
+                                             size_t num, int threads)
+{
+  if (!folder || !mds || (num < 2) || (threads < 1))
+    return NULL;
+
+  struct MaildirPrefetch *pf = mutt_mem_calloc(1, sizeof(*pf));
+  pf->paths = mutt_mem_calloc(num, sizeof(char *));
+  pf->num_paths = num;
+  for (size_t i = 0; i < num; i++)
+    mutt_str_asprintf(&pf->paths[i], "%s/%s", folder, mds[i]->email->path);
+
+  pthread_mutex_init(&pf->lock, NULL);
+  pthread_cond_init(&pf->cond, NULL);
+  pf->threads = mutt_mem_calloc(threads, sizeof(pthread_t));
+
+  /* Signals must be handled by the main thread */
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_BLOCK, &all, &old);
+  for (int i = 0; i < threads; i++)
+  {
+    if (pthread_create(&pf->threads[pf->num_threads], NULL, prefetch_worker, pf) != 0)
+      break;
+    pf->num_threads++;
+  }
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  mutt_debug(LL_DEBUG2, "maildir: %d threads reading ahead of %zu files\n",
+             pf->num_threads, num);
+
+  if (pf->num_threads == 0)
+    maildir_prefetch_free(&pf);
+
+  return pf;
+}
+
+/**
+ * maildir_prefetch_advance - Tell the workers which file is being parsed
+ * @param pf  Prefetch pool
+ * @param pos Index of the file the main thread is about to parse
+ */
+void maildir_prefetch_advance(struct MaildirPrefetch *pf, size_t pos)
+{
+  if (!pf)
+    return;
+
+  pthread_mutex_lock(&pf->lock);
+  pf->cursor = pos;
+  pthread_cond_broadcast(&pf->cond);
+  pthread_mutex_unlock(&pf->lock);
+}
+
+/**
+ * maildir_prefetch_free - Stop the worker threads and free the pool
+ * @param[out] ptr Prefetch pool to free
+ */
+void maildir_prefetch_free(struct MaildirPrefetch **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct MaildirPrefetch *pf = *ptr;
+
+  pthread_mutex_lock(&pf->lock);
+  pf->stop = true;
+  pthread_cond_broadcast(&pf->cond);
+  pthread_mutex_unlock(&pf->lock);
+
+  for (int i = 0; i < pf->num_threads; i++)
+    pthread_join(pf->threads[i], NULL);
+
+  pthread_cond_destroy(&pf->cond);
+  pthread_mutex_destroy(&pf->lock);
+
+  for (size_t i = 0; i < pf->num_paths; i++)
+    FREE(&pf->paths[i]);
+  FREE(&pf->paths);
+  FREE(&pf->threads);
+  FREE(ptr);
+}
+
+#else
+
+/**
+ * maildir_prefetch_new - Start reading message files in the background
+ * @param folder  Path to the mailbox
+ * @param mds     Maildir entries that will be parsed, in order
+ * @param num     Number of entries
+ * @param threads Number of worker threads to use
+ * @retval NULL Prefetching isn't supported in this build
+ */
+struct MaildirPrefetch *maildir_prefetch_new(const char *folder, struct Maildir **mds,
+                                             size_t num, int threads)
+{
+  return NULL;
+}
+
+/**
+ * maildir_prefetch_advance - Tell the workers which file is being parsed
+ * @param pf  Prefetch pool
+ * @param pos Index of the file the main thread is about to parse
+ */
+void maildir_prefetch_advance(struct MaildirPrefetch *pf, size_t pos)
+{
+}
+
+/**
+ * maildir_prefetch_free - Stop the worker threads and free the pool
+ * @param[out] ptr Prefetch pool to free
+ */
+void maildir_prefetch_free(struct MaildirPrefetch **ptr)
+{
+}
+
+#endif
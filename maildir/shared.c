@@ -676,19 +676,30 @@ static struct Maildir *skip_duplicates(struct Maildir *p, struct Maildir **last)
  * @param[in]  m  Mailbox
  * @param[out] md Maildir to parse
  * @param[in]  progress Progress bar
+ *
+ * The Emails are first looked up in the header cache.  The remaining Emails
+ * are parsed, in order, from their files.  If `$maildir_read_threads` is set,
+ * a pool of threads will read the files ahead of the parser.
+ *
+ * The new header cache entries are written in a single batch.
  */
 void maildir_delayed_parsing(struct Mailbox *m, struct Maildir **md, struct Progress *progress)
 {
   struct Maildir *p = NULL, *last = NULL;
   char fn[PATH_MAX];
-  int count;
+  int done = 0;
   bool sort = false;
 
+  /* Emails that aren't in the header cache */
+  struct Maildir **misses = NULL;
+  size_t num_misses = 0;
+  size_t max_misses = 0;
+
 #ifdef USE_HCACHE
   header_cache_t *hc = mutt_hcache_open(C_HeaderCache, mailbox_path(m), NULL);
 #endif
 
-  for (p = *md, count = 0; p; p = p->next, count++)
+  for (p = *md; p; p = p->next)
   {
     if (!(p && p->email && !p->header_parsed))
     {
@@ -696,9 +707,6 @@ void maildir_delayed_parsing(struct Mailbox *m, struct Maildir **md, struct Prog
       continue;
     }
 
-    if (m->verbose && progress)
-      mutt_progress_update(progress, count, -1);
-
     if (!sort)
     {
       mutt_debug(LL_DEBUG3, "maildir: need to sort %s by inode\n", mailbox_path(m));
@@ -709,12 +717,11 @@ void maildir_delayed_parsing(struct Mailbox *m, struct Maildir **md, struct Prog
         *md = p;
       sort = true;
       p = skip_duplicates(p, &last);
-      snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), p->email->path);
     }
 
+#ifdef USE_HCACHE
     snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), p->email->path);
 
-#ifdef USE_HCACHE
     struct stat lastchanged = { 0 };
     int rc = 0;
     if (C_MaildirHeaderCacheVerify)
@@ -738,39 +745,71 @@ void maildir_delayed_parsing(struct Mailbox *m, struct Maildir **md, struct Prog
 
     if (hce.email && (rc == 0) && (lastchanged.st_mtime <= hce.uidvalidity))
     {
+      if (m->verbose && progress)
+        mutt_progress_update(progress, ++done, -1);
+
       hce.email->old = p->email->old;
       hce.email->path = mutt_str_strdup(p->email->path);
       email_free(&p->email);
       p->email = hce.email;
       if (m->type == MUTT_MAILDIR)
         maildir_parse_flags(p->email, fn);
+      last = p;
+      continue;
     }
-    else
 #endif
+
+    if (num_misses == max_misses)
     {
-      if (maildir_parse_message(m->type, fn, p->email->old, p->email))
-      {
-        p->header_parsed = 1;
+      max_misses += 256;
+      mutt_mem_realloc(&misses, max_misses * sizeof(struct Maildir *));
+    }
+    misses[num_misses++] = p;
+    last = p;
+  }
+
+  struct MaildirPrefetch *pf =
+      maildir_prefetch_new(mailbox_path(m), misses, num_misses, C_MaildirReadThreads);
 #ifdef USE_HCACHE
-        if (m->type == MUTT_MH)
-        {
-          key = p->email->path;
-          keylen = strlen(key);
-        }
-        else
-        {
-          key = p->email->path + 3;
-          keylen = maildir_hcache_keylen(key);
-        }
-        mutt_hcache_store(hc, key, keylen, p->email, 0);
+  mutt_hcache_begin(hc);
 #endif
+
+  for (size_t i = 0; i < num_misses; i++)
+  {
+    p = misses[i];
+    maildir_prefetch_advance(pf, i);
+
+    if (m->verbose && progress)
+      mutt_progress_update(progress, ++done, -1);
+
+    snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), p->email->path);
+    if (maildir_parse_message(m->type, fn, p->email->old, p->email))
+    {
+      p->header_parsed = 1;
+#ifdef USE_HCACHE
+      const char *key = NULL;
+      size_t keylen = 0;
+      if (m->type == MUTT_MH)
+      {
+        key = p->email->path;
+        keylen = strlen(key);
       }
       else
-        email_free(&p->email);
+      {
+        key = p->email->path + 3;
+        keylen = maildir_hcache_keylen(key);
+      }
+      mutt_hcache_store(hc, key, keylen, p->email, 0);
+#endif
     }
-    last = p;
+    else
+      email_free(&p->email);
   }
+
+  maildir_prefetch_free(&pf);
+  FREE(&misses);
 #ifdef USE_HCACHE
+  mutt_hcache_commit(hc);
   mutt_hcache_close(hc);
 #endif
 
@@ -1718,7 +1757,10 @@ int mh_mbox_sync(struct Mailbox *m, int *index_hint)
 
 #ifdef USE_HCACHE
   if ((m->type == MUTT_MAILDIR) || (m->type == MUTT_MH))
+  {
     hc = mutt_hcache_open(C_HeaderCache, mailbox_path(m), NULL);
+    mutt_hcache_begin(hc);
+  }
 #endif
 
   if (m->verbose)
@@ -1739,7 +1781,10 @@ int mh_mbox_sync(struct Mailbox *m, int *index_hint)
 
 #ifdef USE_HCACHE
   if ((m->type == MUTT_MAILDIR) || (m->type == MUTT_MH))
+  {
+    mutt_hcache_commit(hc);
     mutt_hcache_close(hc);
+  }
 #endif
 
   if (m->type == MUTT_MH)
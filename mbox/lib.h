@@ -42,6 +42,19 @@
 
 struct stat;
 
+#define MBOX_MAX_ANCHORS 32 ///< Maximum number of checksums of a mailbox file
+
+/**
+ * struct MboxAnchor - Checksum of the start of a mailbox file
+ *
+ * The region [0, end) held complete messages when the mailbox was read.
+ */
+struct MboxAnchor
+{
+  LOFF_T end;               ///< Offset of the first message after the region
+  unsigned char digest[16]; ///< Sampled checksum of the region
+};
+
 /**
  * struct MboxAccountData - Mbox-specific Account data - @extends Account
  */
@@ -49,6 +62,8 @@ struct MboxAccountData
 {
   FILE *fp;              ///< Mailbox file
   struct timespec atime; ///< File's last-access time
+  struct MboxAnchor anchors[MBOX_MAX_ANCHORS]; ///< Checksums of the start of the file, longest first
+  int num_anchors;       ///< Number of anchors
 
   bool locked : 1; ///< is the mailbox locked?
   bool append : 1; ///< mailbox is opened in append mode
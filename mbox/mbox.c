@@ -31,12 +31,15 @@
  */
 
 #include "config.h"
+#include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h> // IWYU pragma: keep
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -56,6 +59,36 @@
 #include "progress.h"
 #include "protos.h"
 #include "sort.h"
+#ifdef USE_HCACHE
+#include "hcache/lib.h"
+#endif
+
+#define MBOX_SAMPLE_EDGE (64 * 1024)        ///< Bytes hashed at each end of a region
+#define MBOX_SAMPLE_SIZE 4096               ///< Bytes hashed in each interior sample
+#define MBOX_SAMPLE_COUNT 16                ///< Number of interior samples
+
+#ifdef USE_HCACHE
+#define MBOX_HCACHE_STATE_VERSION 1         ///< Layout of struct MboxCacheState
+
+/**
+ * struct MboxCacheState - Description of the file covered by the header cache
+ *
+ * This is stored, raw, under the key "/MBOXSTATE".  The Emails are stored
+ * under "/<index>", using the generation as their validity datum.
+ */
+struct MboxCacheState
+{
+  uint32_t version;         ///< Layout of this record, #MBOX_HCACHE_STATE_VERSION
+  uint32_t generation;      ///< Validity datum of the cached Emails
+  uint32_t type;            ///< Mailbox type, #MUTT_MBOX or #MUTT_MMDF
+  uint32_t mark_old;        ///< Value of $mark_old when the Emails were parsed
+  uint32_t msg_count;       ///< Number of cached Emails
+  int64_t size;             ///< Size of the file that was parsed
+  int64_t mtime_sec;        ///< Modification time of the file (seconds)
+  int64_t mtime_nsec;       ///< Modification time of the file (nanoseconds)
+  unsigned char digest[16]; ///< Sampled checksum of the file, see mbox_fingerprint()
+};
+#endif
 
 /**
  * struct MUpdate - Store of new offsets, used by mutt_sync_mailbox()
@@ -334,6 +367,246 @@ static int mmdf_parse_mailbox(struct Mailbox *m)
   return 0;
 }
 
+/**
+ * count_lines - Count the newlines in a block of memory
+ * @param p   Start of the block
+ * @param len Length of the block
+ * @retval num Number of newlines
+ */
+static int count_lines(const char *p, size_t len)
+{
+  const char *end = p + len;
+  int lines = 0;
+
+  while ((p < end) && (p = memchr(p, '\n', end - p)))
+  {
+    lines++;
+    p++;
+  }
+
+  return lines;
+}
+
+/**
+ * mapped_is_from - Is a line of a mapped mailbox a message separator?
+ * @param[in]  line    Start of the line
+ * @param[in]  len     Length of the line, including the newline
+ * @param[out] path    Buffer for the return path
+ * @param[in]  pathlen Length of the buffer
+ * @param[out] tp      Time from the separator
+ * @retval true The line is a valid "From " line
+ */
+static bool mapped_is_from(const char *line, size_t len, char *path,
+                           size_t pathlen, time_t *tp)
+{
+  char buf[8192];
+
+  if ((len < 5) || (memcmp(line, "From ", 5) != 0))
+    return false;
+
+  len = MIN(len, sizeof(buf) - 1);
+  memcpy(buf, line, len);
+  buf[len] = '\0';
+  return is_from(buf, path, pathlen, tp);
+}
+
+/**
+ * mbox_parse_mapped - Read a mailbox using a memory mapping
+ * @param m        Mailbox
+ * @param progress Progress bar, if the Mailbox is verbose
+ * @retval  1 The file couldn't be mapped, the caller should read it normally
+ * @retval  0 Success
+ * @retval -2 Aborted
+ *
+ * This behaves like the fgets() loop in mbox_parse_mailbox(), but it doesn't
+ * read every line.  The separators are found using memchr() on the mapping.
+ * If a message has a valid Content-Length, its body is skipped entirely,
+ * unless its lines need counting.
+ *
+ * The headers are parsed from the mapping if fmemopen() is available,
+ * otherwise they're read from the Mailbox's file.
+ */
+static int mbox_parse_mapped(struct Mailbox *m, struct Progress *progress)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  struct stat sb;
+
+  LOFF_T pos = ftello(adata->fp);
+  if ((pos < 0) || (fstat(fileno(adata->fp), &sb) != 0) || (sb.st_size <= pos) ||
+      ((uintmax_t) sb.st_size > SIZE_MAX))
+  {
+    return 1;
+  }
+
+  const size_t size = sb.st_size;
+  char *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fileno(adata->fp), 0);
+  if (data == MAP_FAILED)
+  {
+    mutt_debug(LL_DEBUG1, "mmap() failed: %s\n", strerror(errno));
+    return 1;
+  }
+#ifdef MADV_SEQUENTIAL
+  madvise(data, size, MADV_SEQUENTIAL);
+#endif
+
+  FILE *fp_hdr = adata->fp;
+#ifdef USE_FMEMOPEN
+  /* Offsets in the memory stream are the same as in the file */
+  FILE *fp_mem = fmemopen(data, size, "r");
+  if (fp_mem)
+    fp_hdr = fp_mem;
+#endif
+
+  char return_path[256];
+  struct Email *e_cur = NULL;
+  time_t t;
+  int count = 0, lines = 0;
+  const char *end = data + size;
+
+  while ((pos < size) && (SigInt != 1))
+  {
+    const char *line = data + pos;
+    const char *eol = memchr(line, '\n', end - line);
+    size_t llen = eol ? (eol - line + 1) : (end - line);
+
+    if (!mapped_is_from(line, llen, return_path, sizeof(return_path), &t))
+    {
+      /* Count lines up to the next one that looks like a separator */
+      const char *p = line;
+      while (p < end)
+      {
+        const char *nl = memchr(p, '\n', end - p);
+        lines++;
+        if (!nl)
+        {
+          p = end;
+          break;
+        }
+        p = nl + 1;
+        if (((end - p) >= 5) && (memcmp(p, "From ", 5) == 0))
+          break;
+      }
+      pos = p - data;
+      continue;
+    }
+
+    /* Save the Content-Length of the previous message */
+    if (count > 0)
+    {
+      struct Email *e = m->emails[m->msg_count - 1];
+      if (e->content->length < 0)
+      {
+        e->content->length = pos - e->content->offset - 1;
+        if (e->content->length < 0)
+          e->content->length = 0;
+      }
+      if (!e->lines)
+        e->lines = lines ? lines - 1 : 0;
+    }
+
+    count++;
+
+    if (m->verbose)
+      mutt_progress_update(progress, count, (int) (pos / (m->size / 100 + 1)));
+
+    if (m->msg_count == m->email_max)
+      mx_alloc_memory(m);
+
+    m->emails[m->msg_count] = email_new();
+    e_cur = m->emails[m->msg_count];
+    e_cur->received = t - mutt_date_local_tz(t);
+    e_cur->offset = pos;
+    e_cur->index = m->msg_count;
+
+    if (fseeko(fp_hdr, pos + llen, SEEK_SET) != 0)
+      mutt_debug(LL_DEBUG1, "#1 fseek() failed\n");
+    e_cur->env = mutt_rfc822_read_header(fp_hdr, e_cur, false, false);
+
+    /* The body follows the headers */
+    LOFF_T body = e_cur->content->offset;
+    if ((body < pos) || (body > size))
+      body = size;
+    pos = body;
+
+    /* if we know how long this message is, skip over the body, counting its
+     * lines if necessary.  The Content-Length is only trusted if it points at
+     * the next message separator. */
+    if (e_cur->content->length > 0)
+    {
+      /* The test below avoids a potential integer overflow if the
+       * content-length is huge (thus necessarily invalid).  */
+      LOFF_T tmploc = (e_cur->content->length < m->size) ?
+                          (body + e_cur->content->length + 1) :
+                          -1;
+
+      if ((tmploc > 0) && (tmploc < size))
+      {
+        if (((size - tmploc) < 5) || (memcmp(data + tmploc, "From ", 5) != 0))
+        {
+          mutt_debug(LL_DEBUG1, "bad content-length in message %d (cl=" OFF_T_FMT ")\n",
+                     e_cur->index, e_cur->content->length);
+          e_cur->content->length = -1;
+        }
+      }
+      else if (tmploc != size)
+      {
+        /* content-length would put us past the end of the file, so it
+         * must be wrong */
+        e_cur->content->length = -1;
+      }
+
+      if (e_cur->content->length != -1)
+      {
+        if (e_cur->lines == 0)
+          e_cur->lines = count_lines(data + body, e_cur->content->length);
+        pos = tmploc;
+      }
+    }
+
+    m->msg_count++;
+
+    if (TAILQ_EMPTY(&e_cur->env->return_path) && return_path[0])
+      mutt_addrlist_parse(&e_cur->env->return_path, return_path);
+
+    if (TAILQ_EMPTY(&e_cur->env->from))
+      mutt_addrlist_copy(&e_cur->env->from, &e_cur->env->return_path, false);
+
+    lines = 0;
+  }
+
+  /* See the note in mbox_parse_mailbox() */
+  if (count > 0)
+  {
+    struct Email *e = m->emails[m->msg_count - 1];
+    if (e->content->length < 0)
+    {
+      e->content->length = pos - e->content->offset - 1;
+      if (e->content->length < 0)
+        e->content->length = 0;
+    }
+
+    if (!e->lines)
+      e->lines = lines ? lines - 1 : 0;
+  }
+
+#ifdef USE_FMEMOPEN
+  mutt_file_fclose(&fp_mem);
+#endif
+  munmap(data, size);
+
+  /* Leave the file where the stdio loop would have */
+  if (fseeko(adata->fp, pos, SEEK_SET) != 0)
+    mutt_debug(LL_DEBUG1, "#2 fseek() failed\n");
+
+  if (SigInt == 1)
+  {
+    SigInt = 0;
+    return -2; /* action aborted */
+  }
+
+  return 0;
+}
+
 /**
  * mbox_parse_mailbox - Read a mailbox from disk
  * @param m Mailbox
@@ -385,6 +658,10 @@ static int mbox_parse_mailbox(struct Mailbox *m)
     mutt_progress_init(&progress, msg, MUTT_PROGRESS_READ, 0);
   }
 
+  int rc = mbox_parse_mapped(m, &progress);
+  if (rc <= 0)
+    return rc;
+
   loc = ftello(adata->fp);
   while ((fgets(buf, sizeof(buf), adata->fp)) && (SigInt != 1))
   {
@@ -533,6 +810,530 @@ static int mbox_parse_mailbox(struct Mailbox *m)
   return 0;
 }
 
+/**
+ * fingerprint_range - Add part of a file to a checksum
+ * @param fd     File descriptor
+ * @param start  Offset of the data
+ * @param len    Length of the data
+ * @param md5ctx Checksum context
+ * @retval true  Success
+ * @retval false The data couldn't be read
+ */
+static bool fingerprint_range(int fd, LOFF_T start, LOFF_T len, struct Md5Ctx *md5ctx)
+{
+  char buf[MBOX_SAMPLE_SIZE];
+
+  while (len > 0)
+  {
+    size_t want = (len < sizeof(buf)) ? len : sizeof(buf);
+    ssize_t got = pread(fd, buf, want, start);
+    if (got <= 0)
+      return false;
+    mutt_md5_process_bytes(buf, got, md5ctx);
+    start += got;
+    len -= got;
+  }
+
+  return true;
+}
+
+/**
+ * mbox_fingerprint - Calculate a sampled checksum of part of a file
+ * @param[in]  fd     File descriptor
+ * @param[in]  start  Start of the region
+ * @param[in]  end    End of the region
+ * @param[out] digest Buffer for the 16-byte checksum
+ * @retval true  Success
+ * @retval false The region couldn't be read
+ *
+ * Reading a whole mailbox to check it hasn't changed would cost as much as
+ * parsing it.  Instead, hash the length of the region, its first and last
+ * #MBOX_SAMPLE_EDGE bytes, and #MBOX_SAMPLE_COUNT blocks spread evenly
+ * between them.
+ */
+static bool mbox_fingerprint(int fd, LOFF_T start, LOFF_T end, unsigned char *digest)
+{
+  struct Md5Ctx md5ctx;
+  LOFF_T len = end - start;
+
+  if (len < 0)
+    return false;
+
+  mutt_md5_init_ctx(&md5ctx);
+  int64_t len64 = len;
+  mutt_md5_process_bytes(&len64, sizeof(len64), &md5ctx);
+
+  if (len <= (2 * MBOX_SAMPLE_EDGE))
+  {
+    if (!fingerprint_range(fd, start, len, &md5ctx))
+      return false;
+  }
+  else
+  {
+    if (!fingerprint_range(fd, start, MBOX_SAMPLE_EDGE, &md5ctx) ||
+        !fingerprint_range(fd, end - MBOX_SAMPLE_EDGE, MBOX_SAMPLE_EDGE, &md5ctx))
+    {
+      return false;
+    }
+
+    const LOFF_T inner = len - (2 * MBOX_SAMPLE_EDGE) - MBOX_SAMPLE_SIZE;
+    for (int i = 0; i < MBOX_SAMPLE_COUNT; i++)
+    {
+      LOFF_T off = start + MBOX_SAMPLE_EDGE + (inner / (MBOX_SAMPLE_COUNT - 1)) * i;
+      if (!fingerprint_range(fd, off, MBOX_SAMPLE_SIZE, &md5ctx))
+        return false;
+    }
+  }
+
+  mutt_md5_finish_ctx(&md5ctx, digest);
+  return true;
+}
+
+/**
+ * mbox_msg_start - Get the offset of the separator before a message
+ * @param m Mailbox
+ * @param e Email
+ * @retval num Offset of the start of the message
+ */
+static LOFF_T mbox_msg_start(struct Mailbox *m, struct Email *e)
+{
+  /* The offset stored in an MMDF Email doesn't include the MMDF_SEP */
+  if (m->type == MUTT_MMDF)
+    return e->offset - (sizeof(MMDF_SEP) - 1);
+  return e->offset;
+}
+
+/**
+ * mbox_update_anchors - Checksum the start of a mailbox file
+ * @param m Mailbox
+ *
+ * If the mailbox is later modified, rather than appended to, the anchors let
+ * reopen_mailbox() find which messages are unchanged.
+ *
+ * The anchors end at message boundaries: before the last message, then
+ * roughly #MBOX_SAMPLE_EDGE bytes from the end of the file, doubling each
+ * time.  Changes near the end of a big mailbox only need the tail to be
+ * parsed again, while keeping the cost of this function low.
+ */
+static void mbox_update_anchors(struct Mailbox *m)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata)
+    return;
+
+  adata->num_anchors = 0;
+  if (!adata->fp)
+    return;
+
+  const int fd = fileno(adata->fp);
+  LOFF_T target = m->size - 1;
+  LOFF_T step = MBOX_SAMPLE_EDGE;
+
+  while ((target > 0) && (adata->num_anchors < MBOX_MAX_ANCHORS))
+  {
+    /* Find the last message that starts at or before the target.  Deleted
+     * Emails are skipped; after a sync, their offsets are stale. */
+    LOFF_T end = 0;
+    for (int i = 0; i < m->msg_count; i++)
+    {
+      struct Email *e = m->emails[i];
+      if (!e || e->deleted)
+        continue;
+      LOFF_T start = mbox_msg_start(m, e);
+      if ((start <= target) && (start > end))
+        end = start;
+    }
+
+    if (end <= 0)
+      break;
+
+    struct MboxAnchor *prev =
+        (adata->num_anchors > 0) ? &adata->anchors[adata->num_anchors - 1] : NULL;
+    if (!prev || (end < prev->end))
+    {
+      struct MboxAnchor *a = &adata->anchors[adata->num_anchors];
+      if (!mbox_fingerprint(fd, 0, end, a->digest))
+        break;
+      a->end = end;
+      adata->num_anchors++;
+    }
+
+    target = m->size - step;
+    step *= 2;
+  }
+}
+
+/**
+ * mbox_keep_unchanged - Keep the Emails from the unchanged start of a mailbox
+ * @param m         Mailbox, with no Emails
+ * @param e_old     Emails from before the mailbox was modified, in file order
+ * @param old_count Number of old Emails
+ * @retval num Number of Emails kept
+ *
+ * The longest anchor whose region still matches the file is used.  The Emails
+ * in that region are moved from e_old to the Mailbox, and the file is
+ * positioned after them, ready to parse the rest.
+ */
+static int mbox_keep_unchanged(struct Mailbox *m, struct Email **e_old, int old_count)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata || !adata->fp || !e_old || (m->msg_count != 0))
+    return 0;
+
+  const int fd = fileno(adata->fp);
+  struct stat sb;
+  if (fstat(fd, &sb) != 0)
+    return 0;
+
+  const char *sep = (m->type == MUTT_MMDF) ? MMDF_SEP : "From ";
+  const size_t seplen = strlen(sep);
+
+  for (int i = 0; i < adata->num_anchors; i++)
+  {
+    const struct MboxAnchor *a = &adata->anchors[i];
+    if (a->end > sb.st_size)
+      continue;
+
+    /* The rest of the file must start with a new message */
+    char buf[16];
+    if ((a->end < sb.st_size) &&
+        ((pread(fd, buf, seplen, a->end) != seplen) || (memcmp(buf, sep, seplen) != 0)))
+    {
+      continue;
+    }
+
+    unsigned char digest[16];
+    if (!mbox_fingerprint(fd, 0, a->end, digest) ||
+        (memcmp(digest, a->digest, sizeof(digest)) != 0))
+    {
+      continue;
+    }
+
+    /* The Emails in the region must come first */
+    int num = 0;
+    while ((num < old_count) && e_old[num] && (mbox_msg_start(m, e_old[num]) < a->end))
+      num++;
+    for (int j = num; j < old_count; j++)
+    {
+      if (e_old[j] && (mbox_msg_start(m, e_old[j]) < a->end))
+        return 0;
+    }
+
+    if (fseeko(adata->fp, a->end, SEEK_SET) != 0)
+      return 0;
+
+    for (int j = 0; j < num; j++)
+    {
+      if (m->msg_count == m->email_max)
+        mx_alloc_memory(m);
+      e_old[j]->index = m->msg_count;
+      m->emails[m->msg_count++] = e_old[j];
+      e_old[j] = NULL;
+    }
+
+    mutt_debug(LL_DEBUG2, "%s: first " OFF_T_FMT " bytes unchanged, kept %d messages\n",
+               mailbox_path(m), a->end, m->msg_count);
+    return m->msg_count;
+  }
+
+  return 0;
+}
+
+#ifdef USE_HCACHE
+/**
+ * mbox_hcache_key - Create the header cache key of an Email
+ * @param index  Index of the Email in the Mailbox
+ * @param buf    Buffer for the key
+ * @param buflen Length of the buffer
+ * @retval num Length of the key
+ */
+static size_t mbox_hcache_key(int index, char *buf, size_t buflen)
+{
+  return snprintf(buf, buflen, "/%d", index);
+}
+
+/**
+ * mbox_hcache_state - Read the cached state of a Mailbox and check it
+ * @param[in]  m  Mailbox
+ * @param[in]  hc Header cache
+ * @param[out] st Cached state
+ * @retval true The cached Emails describe the start of the Mailbox's file
+ *
+ * The file may have grown since it was cached, as long as the new data
+ * starts with a message separator.
+ */
+static bool mbox_hcache_state(struct Mailbox *m, header_cache_t *hc,
+                              struct MboxCacheState *st)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata || !adata->fp)
+    return false;
+
+  size_t dlen = 0;
+  void *data = mutt_hcache_fetch_raw(hc, "/MBOXSTATE", 10, &dlen);
+  if (!data)
+    return false;
+
+  bool valid = (dlen == sizeof(*st));
+  if (valid)
+    memcpy(st, data, sizeof(*st));
+  mutt_hcache_free_raw(hc, &data);
+
+  if (!valid || (st->version != MBOX_HCACHE_STATE_VERSION) ||
+      (st->type != m->type) || (st->mark_old != C_MarkOld) || (st->generation == 0))
+  {
+    return false;
+  }
+
+  const int fd = fileno(adata->fp);
+  struct stat sb;
+  if ((fstat(fd, &sb) != 0) || (sb.st_size < st->size))
+    return false;
+
+  if (sb.st_size == st->size)
+  {
+    struct timespec mtime = { 0 };
+    mutt_file_get_stat_timespec(&mtime, &sb, MUTT_STAT_MTIME);
+    if ((mtime.tv_sec != st->mtime_sec) || (mtime.tv_nsec != st->mtime_nsec))
+      return false;
+  }
+  else if (st->size > 0)
+  {
+    /* Anything after the cached data must be new messages */
+    const char *sep = (m->type == MUTT_MMDF) ? MMDF_SEP : "From ";
+    const size_t seplen = strlen(sep);
+    char buf[16];
+    if ((pread(fd, buf, seplen, st->size) != seplen) || (memcmp(buf, sep, seplen) != 0))
+    {
+      mutt_debug(LL_DEBUG2, "%s: no message separator at " OFF_T_FMT "\n",
+                 mailbox_path(m), (LOFF_T) st->size);
+      return false;
+    }
+  }
+
+  unsigned char digest[16];
+  if (!mbox_fingerprint(fd, 0, st->size, digest) ||
+      (memcmp(digest, st->digest, sizeof(digest)) != 0))
+  {
+    mutt_debug(LL_DEBUG2, "%s: checksum mismatch\n", mailbox_path(m));
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * mbox_hcache_generation - Is the header cache up to date with a Mailbox?
+ * @param m Mailbox
+ * @retval num Generation of the cache, if it covers every Email in the Mailbox
+ * @retval 0   The cache is missing, stale or incomplete
+ */
+static uint32_t mbox_hcache_generation(struct Mailbox *m)
+{
+  if (m->compress_info)
+    return 0;
+
+  header_cache_t *hc = mutt_hcache_open(C_HeaderCache, mailbox_path(m), NULL);
+  if (!hc)
+    return 0;
+
+  struct MboxCacheState st = { 0 };
+  uint32_t generation = 0;
+  if (mbox_hcache_state(m, hc, &st) && (st.msg_count == m->msg_count))
+    generation = st.generation;
+
+  mutt_hcache_close(hc);
+  return generation;
+}
+
+/**
+ * mbox_hcache_restore - Read the Emails of a Mailbox from the header cache
+ * @param m Mailbox, with no Emails
+ * @retval num Generation of the cache, the file is positioned after the cached data
+ * @retval 0   Nothing was restored
+ *
+ * The Emails are only used if all of them can be restored.
+ */
+static uint32_t mbox_hcache_restore(struct Mailbox *m)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata || (m->msg_count != 0) || m->compress_info)
+    return 0;
+
+  header_cache_t *hc = mutt_hcache_open(C_HeaderCache, mailbox_path(m), NULL);
+  if (!hc)
+    return 0;
+
+  struct MboxCacheState st = { 0 };
+  if (!mbox_hcache_state(m, hc, &st))
+  {
+    mutt_hcache_close(hc);
+    return 0;
+  }
+
+  char key[32];
+  LOFF_T end = 0;
+  bool ok = true;
+
+  for (uint32_t i = 0; i < st.msg_count; i++)
+  {
+    size_t keylen = mbox_hcache_key(i, key, sizeof(key));
+    struct HCacheEntry hce = mutt_hcache_fetch(hc, key, keylen, st.generation);
+    struct Email *e = hce.email;
+
+    /* The messages must be in order, and inside the cached part of the file */
+    if (!e || !e->content || (e->offset < end) || (e->content->offset < e->offset) ||
+        (e->content->length < 0) || ((e->content->offset + e->content->length) > st.size))
+    {
+      mutt_debug(LL_DEBUG1, "%s: bad cache entry for message %u\n", mailbox_path(m), i);
+      email_free(&e);
+      ok = false;
+      break;
+    }
+    end = e->content->offset + e->content->length;
+
+    if (m->msg_count == m->email_max)
+      mx_alloc_memory(m);
+    e->index = m->msg_count;
+    m->emails[m->msg_count++] = e;
+  }
+
+  mutt_hcache_close(hc);
+
+  if (ok && (fseeko(adata->fp, st.size, SEEK_SET) != 0))
+    ok = false;
+
+  if (!ok)
+  {
+    for (int i = 0; i < m->msg_count; i++)
+      email_free(&m->emails[i]);
+    m->msg_count = 0;
+    rewind(adata->fp);
+    return 0;
+  }
+
+  mutt_debug(LL_DEBUG2, "%s: restored %d messages (" OFF_T_FMT " bytes)\n",
+             mailbox_path(m), m->msg_count, (LOFF_T) st.size);
+  return st.generation;
+}
+
+/**
+ * mbox_hcache_save - Save the Emails of a Mailbox to the header cache
+ * @param m          Mailbox
+ * @param first      Index of the first Email to save
+ * @param count      Number of Emails the cache will describe
+ * @param size       Length of the file the cache will describe
+ * @param generation Generation of the Emails already in the cache, or 0
+ *
+ * The Emails from first up to count are stored; they must match the first
+ * size bytes of the file.  If generation is 0, the cache is rebuilt from
+ * scratch.  The state is saved last, so an interrupted save leaves the cache
+ * invalid, rather than wrong.
+ */
+static void mbox_hcache_save(struct Mailbox *m, int first, int count,
+                             LOFF_T size, uint32_t generation)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata || !adata->fp || m->compress_info)
+    return;
+
+  const int fd = fileno(adata->fp);
+  struct stat sb;
+  if ((fstat(fd, &sb) != 0) || (sb.st_size < size))
+    return;
+
+  header_cache_t *hc = mutt_hcache_open(C_HeaderCache, mailbox_path(m), NULL);
+  if (!hc)
+    return;
+
+  if (generation == 0)
+  {
+    first = 0;
+    do
+    {
+      generation = mutt_rand32();
+    } while (generation == 0);
+  }
+
+  struct MboxCacheState st = { 0 };
+  st.version = MBOX_HCACHE_STATE_VERSION;
+  st.generation = generation;
+  st.type = m->type;
+  st.mark_old = C_MarkOld;
+  st.msg_count = count;
+  st.size = size;
+
+  /* The time is only checked if the file hasn't grown */
+  struct timespec mtime = { 0 };
+  mutt_file_get_stat_timespec(&mtime, &sb, MUTT_STAT_MTIME);
+  st.mtime_sec = mtime.tv_sec;
+  st.mtime_nsec = mtime.tv_nsec;
+
+  if (!mbox_fingerprint(fd, 0, st.size, st.digest))
+  {
+    mutt_hcache_delete_header(hc, "/MBOXSTATE", 10);
+    mutt_hcache_close(hc);
+    return;
+  }
+
+  char key[32];
+  mutt_hcache_begin(hc);
+  for (int i = first; i < count; i++)
+  {
+    size_t keylen = mbox_hcache_key(i, key, sizeof(key));
+    mutt_hcache_store(hc, key, keylen, m->emails[i], generation);
+  }
+  mutt_hcache_store_raw(hc, "/MBOXSTATE", 10, &st, sizeof(st));
+  mutt_hcache_commit(hc);
+  mutt_hcache_close(hc);
+
+  mutt_debug(LL_DEBUG2, "%s: cached %d messages (" OFF_T_FMT " bytes) from %d\n",
+             mailbox_path(m), count, size, first);
+}
+#endif
+
+/**
+ * mbox_parse_cached - Read a mailbox, using the header cache if possible
+ * @param m Mailbox
+ * @retval  0 Success
+ * @retval -1 Error
+ * @retval -2 Aborted
+ *
+ * If the Mailbox is empty, the Emails are restored from the header cache and
+ * only the messages appended since then are parsed.  Otherwise, the file must
+ * be positioned at the start of the new messages.
+ *
+ * The new Emails are added to the cache.
+ */
+static int mbox_parse_cached(struct Mailbox *m)
+{
+#ifdef USE_HCACHE
+  uint32_t generation;
+  if (m->msg_count == 0)
+    generation = mbox_hcache_restore(m);
+  else
+    generation = mbox_hcache_generation(m);
+  const int first = m->msg_count;
+#endif
+
+  int rc;
+  if (m->type == MUTT_MBOX)
+    rc = mbox_parse_mailbox(m);
+  else if (m->type == MUTT_MMDF)
+    rc = mmdf_parse_mailbox(m);
+  else
+    rc = -1;
+
+#ifdef USE_HCACHE
+  /* Without a valid cache, the old Emails can't be saved; the user may have
+   * changed them */
+  if ((rc == 0) && (((generation != 0) && (m->msg_count > first)) || (first == 0)))
+    mbox_hcache_save(m, first, m->msg_count, m->size, generation);
+#endif
+
+  return rc;
+}
+
 /**
  * reopen_mailbox - Close and reopen a mailbox
  * @param m          Mailbox
@@ -552,6 +1353,7 @@ static int reopen_mailbox(struct Mailbox *m, int *index_hint)
   bool (*cmp_headers)(const struct Email *, const struct Email *) = NULL;
   struct Email **e_old = NULL;
   int old_msg_count;
+  int kept = 0;
   bool msg_mod = false;
   int rc = -1;
 
@@ -575,19 +1377,11 @@ static int reopen_mailbox(struct Mailbox *m, int *index_hint)
   mutt_hash_free(&m->subj_hash);
   mutt_hash_free(&m->label_hash);
   FREE(&m->v2r);
-  if (m->readonly)
-  {
-    for (int i = 0; i < m->msg_count; i++)
-      email_free(&(m->emails[i])); /* nothing to do! */
-    FREE(&m->emails);
-  }
-  else
-  {
-    /* save the old headers */
-    old_msg_count = m->msg_count;
-    e_old = m->emails;
-    m->emails = NULL;
-  }
+
+  /* save the old headers */
+  old_msg_count = m->msg_count;
+  e_old = m->emails;
+  m->emails = NULL;
 
   m->email_max = 0; /* force allocation of new headers */
   m->msg_count = 0;
@@ -611,10 +1405,12 @@ static int reopen_mailbox(struct Mailbox *m, int *index_hint)
       adata->fp = mutt_file_fopen(mailbox_path(m), "r");
       if (!adata->fp)
         rc = -1;
-      else if (m->type == MUTT_MBOX)
-        rc = mbox_parse_mailbox(m);
       else
-        rc = mmdf_parse_mailbox(m);
+      {
+        /* Only parse the part of the file that has changed */
+        kept = mbox_keep_unchanged(m, e_old, old_msg_count);
+        rc = mbox_parse_cached(m);
+      }
       break;
 
     default:
@@ -634,12 +1430,20 @@ static int reopen_mailbox(struct Mailbox *m, int *index_hint)
   }
 
   mutt_file_touch_atime(fileno(adata->fp));
+  mbox_update_anchors(m);
 
   /* now try to recover the old flags */
 
-  if (!m->readonly)
+  if (m->readonly)
   {
-    for (int i = 0; i < m->msg_count; i++)
+    for (int i = 0; i < old_msg_count; i++)
+      email_free(&(e_old[i])); /* nothing to do! */
+    FREE(&e_old);
+  }
+  else
+  {
+    /* the Emails that were kept still have their flags */
+    for (int i = kept; i < m->msg_count; i++)
     {
       bool found = false;
 
@@ -961,13 +1765,9 @@ static int mbox_mbox_open(struct Mailbox *m)
   }
 
   m->has_new = true;
-  int rc;
-  if (m->type == MUTT_MBOX)
-    rc = mbox_parse_mailbox(m);
-  else if (m->type == MUTT_MMDF)
-    rc = mmdf_parse_mailbox(m);
-  else
-    rc = -1;
+  int rc = mbox_parse_cached(m);
+  if (rc == 0)
+    mbox_update_anchors(m);
 
   if (!mbox_has_new(m))
     m->has_new = false;
@@ -1105,10 +1905,8 @@ static int mbox_mbox_check(struct Mailbox *m, int *index_hint)
             mutt_debug(LL_DEBUG1, "#2 fseek() failed\n");
 
           int old_msg_count = m->msg_count;
-          if (m->type == MUTT_MBOX)
-            mbox_parse_mailbox(m);
-          else
-            mmdf_parse_mailbox(m);
+          if (mbox_parse_cached(m) == 0)
+            mbox_update_anchors(m);
 
           if (m->msg_count > old_msg_count)
             mailbox_changed(m, NT_MAILBOX_INVALID);
@@ -1229,6 +2027,11 @@ static int mbox_mbox_sync(struct Mailbox *m, int *index_hint)
     goto fatal;
   }
 
+#ifdef USE_HCACHE
+  /* Is the cache up to date with the mailbox, before it is rewritten? */
+  const uint32_t generation = mbox_hcache_generation(m);
+#endif
+
   /* Create a temporary file to write the new version of the mailbox in. */
   tempfile = mutt_buffer_pool_get();
   mutt_buffer_mktemp(tempfile);
@@ -1470,6 +2273,15 @@ static int mbox_mbox_sync(struct Mailbox *m, int *index_hint)
       m->emails[i]->index = j++;
     }
   }
+
+  mbox_update_anchors(m);
+
+#ifdef USE_HCACHE
+  /* The messages before the first rewritten one haven't changed.  The others
+   * will be parsed, and cached, when the mailbox is next opened. */
+  mbox_hcache_save(m, generation ? first : 0, first, offset, generation);
+#endif
+
   FREE(&new_offset);
   FREE(&old_offset);
   unlink(mutt_b2s(tempfile)); /* remove partial copy of the mailbox */
@@ -0,0 +1,372 @@
+/**
+ * @file
+ * Bulk allocation of long-lived objects
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page arena Bulk allocation of long-lived objects
+ *
+ * An Arena hands out memory from large blocks and releases it all at once,
+ * when the Arena is freed.  Objects that live as long as a Mailbox (Emails,
+ * Envelopes, Addresses, header strings) can be allocated much more cheaply
+ * this way than one at a time.
+ *
+ * Nothing needs to know where an object came from.  mutt_mem_free() ignores
+ * memory owned by an Arena and mutt_mem_realloc() moves it to the heap.
+ *
+ * Allocations come from the "current" Arena, set with mutt_arena_swap().  If
+ * there isn't one, they come from the heap.
+ *
+ * Identical strings can be shared with mutt_arena_intern().  A shared string
+ * must not be changed in place.
+ *
+ * An Arena with a release() function can manage the lifetime of its objects
+ * itself, see @ref strpool.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <string.h>
+#include "arena.h"
+#include "hash.h"
+#include "memory.h"
+#include "string2.h"
+
+#define ARENA_ALIGN 8                 ///< Alignment of every allocation
+#define ARENA_MIN_BLOCK (64 * 1024)   ///< Size of the first block
+#define ARENA_MAX_BLOCK (1024 * 1024) ///< Largest size of a shared block
+#define ARENA_MAX_INTERN 256          ///< Longest string worth interning
+
+/**
+ * struct ArenaRange - The memory range of an ArenaBlock
+ */
+struct ArenaRange
+{
+  const char *start; ///< First byte of the block's data
+  const char *end;   ///< Byte after the block's data
+  struct Arena *a;   ///< Arena owning the block
+};
+
+static struct Arena *CurrentArena = NULL; ///< Arena used for new allocations
+static struct ArenaRange *Ranges = NULL;  ///< Blocks of all Arenas, sorted by address
+static size_t NumRanges = 0;              ///< Number of Ranges in use
+static size_t MaxRanges = 0;              ///< Number of Ranges allocated
+
+/**
+ * range_find - Find the last range starting at or before an address
+ * @param ptr Address
+ * @retval num Index of the range + 1, or 0 if there isn't one
+ */
+static size_t range_find(const char *ptr)
+{
+  size_t lo = 0;
+  size_t hi = NumRanges;
+
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (Ranges[mid].start <= ptr)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/**
+ * range_add - Register the memory of an ArenaBlock
+ * @param a   Arena owning the block
+ * @param blk Block
+ */
+static void range_add(struct Arena *a, struct ArenaBlock *blk)
+{
+  if (NumRanges == MaxRanges)
+  {
+    MaxRanges = MaxRanges ? (MaxRanges * 2) : 64;
+    mutt_mem_realloc(&Ranges, MaxRanges * sizeof(struct ArenaRange));
+  }
+
+  size_t pos = range_find(blk->data);
+  memmove(&Ranges[pos + 1], &Ranges[pos], (NumRanges - pos) * sizeof(struct ArenaRange));
+  Ranges[pos].start = blk->data;
+  Ranges[pos].end = blk->data + blk->size;
+  Ranges[pos].a = a;
+  NumRanges++;
+}
+
+/**
+ * range_remove - Forget the memory of an ArenaBlock
+ * @param blk Block
+ */
+static void range_remove(struct ArenaBlock *blk)
+{
+  size_t pos = range_find(blk->data);
+  if ((pos == 0) || (Ranges[pos - 1].start != blk->data))
+    return;
+
+  pos--;
+  NumRanges--;
+  memmove(&Ranges[pos], &Ranges[pos + 1], (NumRanges - pos) * sizeof(struct ArenaRange));
+
+  if (NumRanges == 0)
+  {
+    FREE(&Ranges);
+    MaxRanges = 0;
+  }
+}
+
+/**
+ * block_new - Add a block of memory to an Arena
+ * @param a    Arena
+ * @param size Number of bytes the block must hold
+ * @retval ptr New block
+ */
+static struct ArenaBlock *block_new(struct Arena *a, size_t size)
+{
+  struct ArenaBlock *blk = mutt_mem_malloc(sizeof(struct ArenaBlock) + size);
+  blk->size = size;
+  blk->used = 0;
+  range_add(a, blk);
+  a->size += size;
+  return blk;
+}
+
+/**
+ * mutt_arena_alloc - Allocate memory from an Arena
+ * @param a    Arena
+ * @param size Number of bytes
+ * @retval ptr Uninitialised memory
+ */
+void *mutt_arena_alloc(struct Arena *a, size_t size)
+{
+  size = (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+
+  struct ArenaBlock *blk = a->blocks;
+  if (!blk || ((blk->size - blk->used) < size))
+  {
+    if (size > (ARENA_MAX_BLOCK / 8))
+    {
+      /* Give a large object a block of its own, behind the current one */
+      struct ArenaBlock *big = block_new(a, size);
+      big->used = size;
+      if (blk)
+      {
+        big->next = blk->next;
+        blk->next = big;
+      }
+      else
+      {
+        big->next = NULL;
+        a->blocks = big;
+      }
+      a->num_allocs++;
+      a->used += size;
+      return big->data;
+    }
+
+    size_t bsize = blk ? MIN(blk->size * 2, ARENA_MAX_BLOCK) : ARENA_MIN_BLOCK;
+    blk = block_new(a, bsize);
+    blk->next = a->blocks;
+    a->blocks = blk;
+  }
+
+  void *p = blk->data + blk->used;
+  blk->used += size;
+  a->num_allocs++;
+  a->used += size;
+  return p;
+}
+
+/**
+ * mutt_arena_new - Create a new Arena
+ * @retval ptr New Arena
+ */
+struct Arena *mutt_arena_new(void)
+{
+  return mutt_mem_calloc(1, sizeof(struct Arena));
+}
+
+/**
+ * mutt_arena_free - Free an Arena and everything allocated from it
+ * @param[out] ptr Arena to free
+ *
+ * If the Arena is current, allocations will come from the heap again.
+ */
+void mutt_arena_free(struct Arena **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct Arena *a = *ptr;
+  if (CurrentArena == a)
+    CurrentArena = NULL;
+
+  mutt_hash_free(&a->strings);
+  while (a->blocks)
+  {
+    struct ArenaBlock *blk = a->blocks;
+    a->blocks = blk->next;
+    range_remove(blk);
+    FREE(&blk);
+  }
+
+  FREE(ptr);
+}
+
+/**
+ * mutt_arena_swap - Change the current Arena
+ * @param a Arena to use for new allocations (NULL for the heap)
+ * @retval ptr Previous Arena, to be restored later
+ */
+struct Arena *mutt_arena_swap(struct Arena *a)
+{
+  struct Arena *old = CurrentArena;
+  CurrentArena = a;
+  return old;
+}
+
+/**
+ * mutt_arena_current - Get the current Arena
+ * @retval ptr  Arena used for new allocations
+ * @retval NULL Allocations come from the heap
+ */
+struct Arena *mutt_arena_current(void)
+{
+  return CurrentArena;
+}
+
+/**
+ * mutt_arena_find - Find the Arena that owns some memory
+ * @param[in]  ptr   Memory
+ * @param[out] avail Bytes from ptr to the end of its ArenaBlock
+ * @retval ptr  Arena owning the memory
+ * @retval NULL The memory doesn't belong to any Arena
+ */
+struct Arena *mutt_arena_find(const void *ptr, size_t *avail)
+{
+  if (!ptr || (NumRanges == 0))
+    return NULL;
+
+  const char *p = ptr;
+  size_t pos = range_find(p);
+  if ((pos == 0) || (p >= Ranges[pos - 1].end))
+    return NULL;
+
+  if (avail)
+    *avail = Ranges[pos - 1].end - p;
+  return Ranges[pos - 1].a;
+}
+
+/**
+ * mutt_arena_owns - Does an Arena own some memory?
+ * @param ptr Memory
+ * @retval num Bytes from ptr to the end of its ArenaBlock
+ * @retval 0   The memory doesn't belong to any Arena
+ */
+size_t mutt_arena_owns(const void *ptr)
+{
+  size_t avail = 0;
+  mutt_arena_find(ptr, &avail);
+  return avail;
+}
+
+/**
+ * mutt_arena_calloc - Allocate zeroed memory from the current Arena
+ * @param size Number of bytes
+ * @retval ptr Zeroed memory
+ *
+ * If there's no current Arena, the memory comes from the heap.
+ * Either way, it can be released with mutt_mem_free().
+ */
+void *mutt_arena_calloc(size_t size)
+{
+  if (!CurrentArena)
+    return mutt_mem_calloc(1, size);
+
+  if (size == 0)
+    return NULL;
+
+  void *p = mutt_arena_alloc(CurrentArena, size);
+  memset(p, 0, size);
+  return p;
+}
+
+/**
+ * mutt_arena_strndup - Copy a string into the current Arena
+ * @param str String to copy
+ * @param len Length of the string
+ * @retval ptr New string
+ *
+ * If there's no current Arena, the string is copied to the heap.
+ */
+char *mutt_arena_strndup(const char *str, size_t len)
+{
+  if (!str)
+    return NULL;
+
+  if (!CurrentArena)
+    return mutt_str_substr_dup(str, str + len);
+
+  char *p = mutt_arena_alloc(CurrentArena, len + 1);
+  memcpy(p, str, len);
+  p[len] = '\0';
+  return p;
+}
+
+/**
+ * mutt_arena_intern - Share a string in the current Arena
+ * @param str String to copy
+ * @param len Length of the string
+ * @retval ptr Shared string
+ *
+ * If the Arena already holds an identical string, it will be returned.
+ * The string must not be changed in place.
+ *
+ * If there's no current Arena, the string is copied to the heap.
+ */
+char *mutt_arena_intern(const char *str, size_t len)
+{
+  if (!str)
+    return NULL;
+
+  struct Arena *a = CurrentArena;
+  if (!a || (len > ARENA_MAX_INTERN))
+    return mutt_arena_strndup(str, len);
+
+  if (!a->strings)
+    a->strings = mutt_hash_new(1024, MUTT_HASH_NO_FLAGS);
+
+  /* Copy the string first, it may not be NUL-terminated */
+  const size_t used = a->used;
+  char *p = mutt_arena_strndup(str, len);
+
+  char *old = mutt_hash_find(a->strings, p);
+  if (old)
+  {
+    /* Nothing has been allocated since, so give the copy back */
+    a->blocks->used = p - a->blocks->data;
+    a->num_allocs--;
+    a->used = used;
+    a->shared += len + 1;
+    return old;
+  }
+
+  mutt_hash_insert(a->strings, p, p);
+  return p;
+}
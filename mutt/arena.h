@@ -0,0 +1,71 @@
+/**
+ * @file
+ * Bulk allocation of long-lived objects
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_ARENA_H
+#define MUTT_LIB_ARENA_H
+
+#include <stddef.h>
+
+/**
+ * struct ArenaBlock - A block of memory owned by an Arena
+ */
+struct ArenaBlock
+{
+  struct ArenaBlock *next; ///< Previous block
+  size_t size;             ///< Number of bytes in data
+  size_t used;             ///< Number of bytes handed out
+  char data[];             ///< Memory
+};
+
+struct Arena;
+
+/**
+ * typedef arena_release_t - Prototype for an Arena's release callback function
+ * @param a   Arena owning the object
+ * @param ptr Object being released by mutt_mem_free()
+ */
+typedef void (*arena_release_t)(struct Arena *a, void *ptr);
+
+/**
+ * struct Arena - A collection of objects that are freed together
+ */
+struct Arena
+{
+  struct ArenaBlock *blocks; ///< Blocks, newest first
+  arena_release_t release;   ///< Function to take back an object (optional)
+  struct Hash *strings;      ///< Interned strings
+  size_t num_allocs;         ///< Number of allocations
+  size_t size;               ///< Total size of the blocks
+  size_t used;               ///< Bytes handed out
+  size_t shared;             ///< Bytes saved by interning strings
+};
+
+void *        mutt_arena_alloc  (struct Arena *a, size_t size);
+void *        mutt_arena_calloc (size_t size);
+struct Arena *mutt_arena_current(void);
+struct Arena *mutt_arena_find   (const void *ptr, size_t *avail);
+void          mutt_arena_free   (struct Arena **ptr);
+char *        mutt_arena_intern (const char *str, size_t len);
+struct Arena *mutt_arena_new    (void);
+size_t        mutt_arena_owns   (const void *ptr);
+char *        mutt_arena_strndup(const char *str, size_t len);
+struct Arena *mutt_arena_swap   (struct Arena *a);
+
+#endif /* MUTT_LIB_ARENA_H */
@@ -25,33 +25,67 @@
  * @page hash Hash table data structure
  *
  * Hash table data structure.
+ *
+ * The table uses open addressing with linear probing.  Each slot holds the
+ * full hash of its key, so a probe rarely has to compare the keys themselves.
+ * The table doubles in size when it becomes 3/4 full; deletions shift the
+ * following entries back, so no tombstones are needed.
+ *
+ * The elements are allocated in blocks, which never move, so a HashElem
+ * pointer stays valid until the element is deleted.  Elements with duplicate
+ * keys are chained together from a single slot.
  */
 
 #include "config.h"
 #include <ctype.h>
 #include <stdbool.h>
+#include <string.h>
 #include "hash.h"
 #include "memory.h"
 #include "string2.h"
 
-#define SOME_PRIME 149711
+#define HASH_MIN_SLOTS 16   ///< Smallest number of slots in a table
+#define HASH_MIN_BLOCK 16   ///< Number of elements in the first block
+#define HASH_MAX_BLOCK 4096 ///< Largest number of elements in a block
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL ///< FNV-1a offset basis
+#define FNV_PRIME  0x100000001b3ULL      ///< FNV-1a prime
+
+/**
+ * hash_mix - Scramble the bits of a hash
+ * @param h Hash
+ * @retval num Scrambled hash
+ *
+ * The table is indexed by the low bits of the hash, so they must depend on
+ * every bit of the key.  This is the finaliser from MurmurHash3.
+ */
+static size_t hash_mix(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
 
 /**
  * gen_string_hash - Generate a hash from a string - Implements Hash::gen_hash()
  * @param key String key
- * @param n   Number of elements in the Hash table
- * @retval num Cryptographic hash of the string
+ * @retval num FNV-1a hash of the string
  */
-static size_t gen_string_hash(union HashKey key, size_t n)
+static size_t gen_string_hash(union HashKey key)
 {
-  size_t h = 0;
+  uint64_t h = FNV_OFFSET;
   const unsigned char *s = (const unsigned char *) key.strkey;
 
   while (*s)
-    h += ((h << 7) + *s++);
-  h = (h * SOME_PRIME) % n;
+  {
+    h ^= *s++;
+    h *= FNV_PRIME;
+  }
 
-  return h;
+  return hash_mix(h);
 }
 
 /**
@@ -70,19 +104,20 @@ static int cmp_string_key(union HashKey a, union HashKey b)
 /**
  * gen_case_string_hash - Generate a hash from a string (ignore the case) - Implements Hash::gen_hash()
  * @param key String key
- * @param n   Number of elements in the Hash table
- * @retval num Cryptographic hash of the string
+ * @retval num FNV-1a hash of the lower-case string
  */
-static size_t gen_case_string_hash(union HashKey key, size_t n)
+static size_t gen_case_string_hash(union HashKey key)
 {
-  size_t h = 0;
+  uint64_t h = FNV_OFFSET;
   const unsigned char *s = (const unsigned char *) key.strkey;
 
   while (*s)
-    h += ((h << 7) + tolower(*s++));
-  h = (h * SOME_PRIME) % n;
+  {
+    h ^= tolower(*s++);
+    h *= FNV_PRIME;
+  }
 
-  return h;
+  return hash_mix(h);
 }
 
 /**
@@ -101,12 +136,11 @@ static int cmp_case_string_key(union HashKey a, union HashKey b)
 /**
  * gen_int_hash - Generate a hash from an integer - Implements Hash::gen_hash()
  * @param key Integer key
- * @param n   Number of elements in the Hash table
- * @retval num Cryptographic hash of the integer
+ * @retval num Hash of the integer
  */
-static size_t gen_int_hash(union HashKey key, size_t n)
+static size_t gen_int_hash(union HashKey key)
 {
-  return key.intkey % n;
+  return hash_mix(key.intkey);
 }
 
 /**
@@ -131,19 +165,145 @@ static int cmp_int_key(union HashKey a, union HashKey b)
  * @param nelem Number of elements it should contain
  * @retval ptr New Hash table
  *
- * The Hash table can contain more elements than nelem, but they will be
- * chained together.
+ * The Hash table will grow if more than 3/4 of nelem are added.
  */
 static struct Hash *hash_new(size_t nelem)
 {
   struct Hash *table = mutt_mem_calloc(1, sizeof(struct Hash));
-  if (nelem == 0)
-    nelem = 2;
-  table->nelem = nelem;
-  table->table = mutt_mem_calloc(nelem, sizeof(struct HashElem *));
+
+  size_t slots = HASH_MIN_SLOTS;
+  while (slots < nelem)
+    slots *= 2;
+
+  table->nelem = slots;
+  table->table = mutt_mem_calloc(slots, sizeof(struct HashSlot));
   return table;
 }
 
+/**
+ * hash_elem_new - Get an unused HashElem
+ * @param table Hash table
+ * @retval ptr Empty HashElem
+ */
+static struct HashElem *hash_elem_new(struct Hash *table)
+{
+  struct HashElem *he = table->free_elems;
+  if (he)
+  {
+    table->free_elems = he->next;
+  }
+  else
+  {
+    struct HashElemBlock *blk = table->blocks;
+    if (!blk || (blk->used == blk->size))
+    {
+      size_t size = blk ? MIN(blk->size * 2, HASH_MAX_BLOCK) : HASH_MIN_BLOCK;
+      blk = mutt_mem_malloc(sizeof(struct HashElemBlock) + size * sizeof(struct HashElem));
+      blk->next = table->blocks;
+      blk->size = size;
+      blk->used = 0;
+      table->blocks = blk;
+    }
+    he = &blk->elems[blk->used++];
+  }
+
+  memset(he, 0, sizeof(*he));
+  return he;
+}
+
+/**
+ * hash_elem_free - Free a HashElem and its data
+ * @param table Hash table
+ * @param he    HashElem to free
+ */
+static void hash_elem_free(struct Hash *table, struct HashElem *he)
+{
+  if (table->hdata_free)
+    table->hdata_free(he->type, he->data, table->hdata);
+  if (table->strdup_keys)
+    FREE(&he->key.strkey);
+
+  he->next = table->free_elems;
+  table->free_elems = he;
+}
+
+/**
+ * hash_lookup - Find the slot for a key
+ * @param table Hash table
+ * @param key   Key to look for
+ * @param hash  Hash of the key
+ * @retval ptr Slot holding the key, or the empty slot where it belongs
+ */
+static struct HashSlot *hash_lookup(const struct Hash *table, union HashKey key, size_t hash)
+{
+  const size_t mask = table->nelem - 1;
+
+  /* The table is never full, so this will find an empty slot */
+  for (size_t i = hash & mask;; i = (i + 1) & mask)
+  {
+    struct HashSlot *slot = &table->table[i];
+    if (!slot->elem)
+      return slot;
+    if ((slot->hash == hash) && (table->cmp_key(slot->elem->key, key) == 0))
+      return slot;
+  }
+}
+
+/**
+ * hash_grow - Double the size of a Hash table
+ * @param table Hash table
+ */
+static void hash_grow(struct Hash *table)
+{
+  struct HashSlot *old = table->table;
+  const size_t old_nelem = table->nelem;
+
+  table->nelem *= 2;
+  table->table = mutt_mem_calloc(table->nelem, sizeof(struct HashSlot));
+
+  const size_t mask = table->nelem - 1;
+  for (size_t i = 0; i < old_nelem; i++)
+  {
+    if (!old[i].elem)
+      continue;
+
+    size_t j = old[i].hash & mask;
+    while (table->table[j].elem)
+      j = (j + 1) & mask;
+    table->table[j] = old[i];
+  }
+
+  FREE(&old);
+}
+
+/**
+ * hash_remove_slot - Empty a slot, keeping the probe sequences intact
+ * @param table Hash table
+ * @param slot  Slot to empty
+ *
+ * Any following entries that would no longer be found are moved back.
+ */
+static void hash_remove_slot(struct Hash *table, struct HashSlot *slot)
+{
+  const size_t mask = table->nelem - 1;
+  size_t hole = slot - table->table;
+
+  for (size_t i = (hole + 1) & mask; table->table[i].elem; i = (i + 1) & mask)
+  {
+    /* Distance from the entry's ideal slot to the hole, and to where it is */
+    const size_t home = table->table[i].hash & mask;
+    if (((hole - home) & mask) < ((i - home) & mask))
+    {
+      table->table[hole] = table->table[i];
+      hole = i;
+    }
+  }
+
+  table->table[hole].hash = 0;
+  table->table[hole].elem = NULL;
+  table->count--;
+}
+
 /**
  * union_hash_insert - Insert into a hash table using a union as a key
  * @param table Hash table to update
@@ -155,41 +315,34 @@ static struct Hash *hash_new(size_t nelem)
 static struct HashElem *union_hash_insert(struct Hash *table, union HashKey key,
                                           int type, void *data)
 {
-  if (!table)
+  if (!table || !table->table)
     return NULL;
 
-  struct HashElem *he = mutt_mem_malloc(sizeof(struct HashElem));
-  unsigned int h = table->gen_hash(key, table->nelem);
+  if (((table->count + 1) * 4) > (table->nelem * 3))
+    hash_grow(table);
+
+  const size_t hash = table->gen_hash(key);
+  struct HashSlot *slot = hash_lookup(table, key, hash);
+  if (slot->elem && !table->allow_dups)
+    return NULL;
+
+  struct HashElem *he = hash_elem_new(table);
   he->key = key;
   he->data = data;
   he->type = type;
 
-  if (table->allow_dups)
+  if (slot->elem)
   {
-    he->next = table->table[h];
-    table->table[h] = he;
+    /* The newest duplicate is found first */
+    he->next = slot->elem;
   }
   else
   {
-    struct HashElem *tmp = NULL, *last = NULL;
-
-    for (tmp = table->table[h], last = NULL; tmp; last = tmp, tmp = tmp->next)
-    {
-      const int r = table->cmp_key(tmp->key, key);
-      if (r == 0)
-      {
-        FREE(&he);
-        return NULL;
-      }
-      if (r > 0)
-        break;
-    }
-    if (last)
-      last->next = he;
-    else
-      table->table[h] = he;
-    he->next = tmp;
+    slot->hash = hash;
+    table->count++;
   }
+  slot->elem = he;
+
   return he;
 }
 
@@ -201,17 +354,10 @@ static struct HashElem *union_hash_insert(struct Hash *table, union HashKey key,
  */
 static struct HashElem *union_hash_find_elem(const struct Hash *table, union HashKey key)
 {
-  if (!table)
+  if (!table || !table->table)
     return NULL;
 
-  int hash = table->gen_hash(key, table->nelem);
-  struct HashElem *he = table->table[hash];
-  for (; he; he = he->next)
-  {
-    if (table->cmp_key(key, he->key) == 0)
-      return he;
-  }
-  return NULL;
+  return hash_lookup(table, key, table->gen_hash(key))->elem;
 }
 
 /**
@@ -238,24 +384,22 @@ static void *union_hash_find(const struct Hash *table, union HashKey key)
  */
 static void union_hash_delete(struct Hash *table, union HashKey key, const void *data)
 {
-  if (!table)
+  if (!table || !table->table)
     return;
 
-  int hash = table->gen_hash(key, table->nelem);
-  struct HashElem *he = table->table[hash];
-  struct HashElem **last = &table->table[hash];
+  struct HashSlot *slot = hash_lookup(table, key, table->gen_hash(key));
+  if (!slot->elem)
+    return;
+
+  struct HashElem *he = slot->elem;
+  struct HashElem **last = &slot->elem;
 
   while (he)
   {
-    if (((data == he->data) || !data) && (table->cmp_key(he->key, key) == 0))
+    if ((data == he->data) || !data)
     {
       *last = he->next;
-      if (table->hdata_free)
-        table->hdata_free(he->type, he->data, table->hdata);
-      if (table->strdup_keys)
-        FREE(&he->key.strkey);
-      FREE(&he);
-
+      hash_elem_free(table, he);
       he = *last;
     }
     else
@@ -264,6 +408,9 @@ static void union_hash_delete(struct Hash *table, union HashKey key, const void
       he = he->next;
     }
   }
+
+  if (!slot->elem)
+    hash_remove_slot(table, slot);
 }
 
 /**
@@ -337,8 +484,12 @@ struct HashElem *mutt_hash_typed_insert(struct Hash *table, const char *strkey,
     return NULL;
 
   union HashKey key;
-  key.strkey = table->strdup_keys ? mutt_str_strdup(strkey) : strkey;
-  return union_hash_insert(table, key, type, data);
+  /* Not mutt_str_strdup(), an empty key must be copied too */
+  key.strkey = table->strdup_keys ? mutt_str_substr_dup(strkey, NULL) : strkey;
+  struct HashElem *he = union_hash_insert(table, key, type, data);
+  if (!he && table->strdup_keys)
+    FREE(&key.strkey);
+  return he;
 }
 
 /**
@@ -420,7 +571,8 @@ void *mutt_hash_int_find(const struct Hash *table, unsigned int intkey)
  * @param strkey String key to search for
  * @retval ptr HashElem matching the key
  *
- * Unlike mutt_hash_find_elem(), this will return the first matching entry.
+ * If the table allows duplicate keys, all the matching entries can be found
+ * by following HashElem::next.
  */
 struct HashElem *mutt_hash_find_bucket(const struct Hash *table, const char *strkey)
 {
@@ -428,10 +580,8 @@ struct HashElem *mutt_hash_find_bucket(const struct Hash *table, const char *str
     return NULL;
 
   union HashKey key;
-
   key.strkey = strkey;
-  int hash = table->gen_hash(key, table->nelem);
-  return table->table[hash];
+  return union_hash_find_elem(table, key);
 }
 
 /**
@@ -478,7 +628,7 @@ void mutt_hash_free(struct Hash **ptr)
 
   for (size_t i = 0; i < hash->nelem; i++)
   {
-    for (elem = hash->table[i]; elem;)
+    for (elem = hash->table[i].elem; elem;)
     {
       tmp = elem;
       elem = elem->next;
@@ -486,9 +636,16 @@ void mutt_hash_free(struct Hash **ptr)
         hash->hdata_free(tmp->type, tmp->data, hash->hdata);
       if (hash->strdup_keys)
         FREE(&tmp->key.strkey);
-      FREE(&tmp);
     }
   }
+
+  while (hash->blocks)
+  {
+    struct HashElemBlock *blk = hash->blocks;
+    hash->blocks = blk->next;
+    FREE(&blk);
+  }
+
   FREE(&hash->table);
   FREE(ptr);
 }
@@ -502,7 +659,7 @@ void mutt_hash_free(struct Hash **ptr)
  */
 struct HashElem *mutt_hash_walk(const struct Hash *table, struct HashWalkState *state)
 {
-  if (!table || !state)
+  if (!table || !state || !table->table)
     return NULL;
 
   if (state->last && state->last->next)
@@ -516,9 +673,9 @@ struct HashElem *mutt_hash_walk(const struct Hash *table, struct HashWalkState *
 
   while (state->index < table->nelem)
   {
-    if (table->table[state->index])
+    if (table->table[state->index].elem)
     {
-      state->last = table->table[state->index];
+      state->last = table->table[state->index].elem;
       return state->last;
     }
     state->index++;
@@ -44,7 +44,33 @@ struct HashElem
   int type;
   union HashKey key;
   void *data;
-  struct HashElem *next;
+  struct HashElem *next; ///< Next item with the same key (only with #MUTT_HASH_ALLOW_DUPS)
+};
+
+/**
+ * struct HashSlot - A slot in a Hash Table
+ *
+ * The full hash of the key is kept beside the element, so most probes never
+ * need to look at the key itself.
+ */
+struct HashSlot
+{
+  size_t hash;           ///< Hash of the key
+  struct HashElem *elem; ///< First element with this key, NULL if the slot is empty
+};
+
+/**
+ * struct HashElemBlock - Storage for Hash Table elements
+ *
+ * Elements are allocated in blocks, so that their addresses stay the same
+ * when the table grows.
+ */
+struct HashElemBlock
+{
+  struct HashElemBlock *next; ///< Previous block
+  size_t size;                ///< Number of elements in the block
+  size_t used;                ///< Number of elements handed out
+  struct HashElem elems[];    ///< Elements
 };
 
 /**
@@ -60,14 +86,17 @@ typedef void (*hashelem_free_t)(int type, void *obj, intptr_t data);
  */
 struct Hash
 {
-  size_t nelem;                                 ///< Number of elements in the Hash table
+  size_t nelem;                                 ///< Number of slots in the Hash table (a power of two)
+  size_t count;                                 ///< Number of slots in use
   bool strdup_keys : 1;                         ///< if set, the key->strkey is strdup'ed
   bool allow_dups  : 1;                         ///< if set, duplicate keys are allowed
-  struct HashElem **table;                      ///< Array of Hash keys
-  size_t (*gen_hash)(union HashKey, size_t);    ///< Function to generate hash id from the key
+  struct HashSlot *table;                       ///< Array of slots
+  size_t (*gen_hash)(union HashKey);            ///< Function to generate hash id from the key
   int (*cmp_key)(union HashKey, union HashKey); ///< Function to compare two Hash keys
   intptr_t hdata;                               ///< Data to pass to the hdata_free() function
   hashelem_free_t hdata_free;                   ///< Function to free a Hash element
+  struct HashElemBlock *blocks;                 ///< Storage for the elements
+  struct HashElem *free_elems;                  ///< Recycled elements, linked by HashElem::next
 };
 
 typedef uint8_t HashFlags;             ///< Flags for mutt_hash_new(), e.g. #MUTT_HASH_STRCASECMP
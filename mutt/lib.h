@@ -27,6 +27,7 @@
  *
  * | File             | Description        |
  * | :--------------- | :----------------- |
+ * | mutt/arena.c     | @subpage arena     |
  * | mutt/base64.c    | @subpage base64    |
  * | mutt/buffer.c    | @subpage buffer    |
  * | mutt/charset.c   | @subpage charset   |
@@ -51,6 +52,7 @@
  * | mutt/slist.c     | @subpage slist     |
  * | mutt/signal.c    | @subpage signal    |
  * | mutt/string.c    | @subpage string    |
+ * | mutt/strpool.c   | @subpage strpool   |
  *
  * @note The library is self-contained -- some files may depend on others in
  *       the library, but none depends on source from outside.
@@ -60,6 +62,7 @@
 #define MUTT_MUTT_LIB_H
 
 // IWYU pragma: begin_exports
+#include "arena.h"
 #include "base64.h"
 #include "buffer.h"
 #include "charset.h"
@@ -87,6 +90,7 @@
 #include "signal2.h"
 #include "slist.h"
 #include "string2.h"
+#include "strpool.h"
 // IWYU pragma: end_exports
 
 #endif /* MUTT_MUTT_LIB_H */
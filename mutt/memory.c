@@ -31,7 +31,9 @@
 
 #include "config.h"
 #include <stdlib.h>
+#include <string.h>
 #include "memory.h"
+#include "arena.h"
 #include "exit.h"
 #include "logging.h"
 #include "message.h"
@@ -72,7 +74,12 @@ void mutt_mem_free(void *ptr)
   void **p = (void **) ptr;
   if (*p)
   {
-    free(*p);
+    /* Memory owned by an Arena is released with the Arena */
+    struct Arena *a = mutt_arena_find(*p, NULL);
+    if (!a)
+      free(*p);
+    else if (a->release)
+      a->release(a, *p);
     *p = NULL;
   }
 }
@@ -110,6 +117,8 @@ void *mutt_mem_malloc(size_t size)
  *       It will print an error and exit the program.
  *
  * If the new size is zero, the block will be freed.
+ *
+ * Memory owned by an Arena is copied to the heap.
  */
 void mutt_mem_realloc(void *ptr, size_t size)
 {
@@ -117,18 +126,32 @@ void mutt_mem_realloc(void *ptr, size_t size)
     return;
 
   void **p = (void **) ptr;
+  size_t avail = 0;
+  struct Arena *a = mutt_arena_find(*p, &avail);
 
   if (size == 0)
   {
-    if (*p)
+    mutt_mem_free(p);
+    return;
+  }
+
+  void *r = NULL;
+  if (!a)
+  {
+    r = realloc(*p, size);
+  }
+  else
+  {
+    /* The old size isn't known, but the rest of the block is readable */
+    r = malloc(size);
+    if (r)
     {
-      free(*p);
-      *p = NULL;
+      memcpy(r, *p, MIN(size, avail));
+      if (a->release)
+        a->release(a, *p);
     }
-    return;
   }
 
-  void *r = realloc(*p, size);
   if (!r)
   {
     mutt_error(_("Out of memory"));
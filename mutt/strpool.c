@@ -0,0 +1,197 @@
+/**
+ * @file
+ * Shared, reference-counted strings
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page strpool Shared, reference-counted strings
+ *
+ * In a mailing list folder, the same names and email addresses appear
+ * thousands of times.  The pool keeps one copy of each string and counts the
+ * references to it.
+ *
+ * A pooled string is an ordinary `char *`.  Each mutt_strpool_get() must be
+ * matched by a mutt_mem_free(), which drops the reference.  The memory is
+ * reused when the last reference is gone.
+ *
+ * Because the strings are shared, they must not be changed in place.  Two
+ * pooled strings are identical if, and only if, their pointers are equal.
+ *
+ * The strings live in an @ref arena, which lets mutt_mem_free() recognise
+ * them.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "strpool.h"
+#include "arena.h"
+#include "hash.h"
+#include "memory.h"
+#include "string2.h"
+
+#define STRPOOL_NUM_CLASSES 5 ///< Number of sizes of PoolEntry
+#define STRPOOL_MIN_ENTRY 16  ///< Size of the smallest PoolEntry
+
+/**
+ * struct PoolEntry - A string in the pool
+ */
+struct PoolEntry
+{
+  uint32_t refs; ///< Number of references
+  uint32_t cls;  ///< Size class of the entry
+  char str[];    ///< String
+};
+
+/// Longest string that can be pooled
+#define STRPOOL_MAX_LEN ((STRPOOL_MIN_ENTRY << (STRPOOL_NUM_CLASSES - 1)) - sizeof(struct PoolEntry) - 1)
+
+static struct Arena *PoolArena = NULL; ///< Storage for the strings
+static struct Hash *PoolHash = NULL;   ///< Lookup table of the strings
+static struct PoolEntry *FreeEntries[STRPOOL_NUM_CLASSES] = { 0 }; ///< Unused entries, by size
+
+/**
+ * entry_of - Get the PoolEntry of a string
+ * @param str Pooled string
+ * @retval ptr PoolEntry
+ */
+static struct PoolEntry *entry_of(const char *str)
+{
+  return (struct PoolEntry *) (str - offsetof(struct PoolEntry, str));
+}
+
+/**
+ * entry_free - Put a PoolEntry on the free list
+ * @param pe PoolEntry
+ *
+ * The free list is linked through the entries' strings.
+ */
+static void entry_free(struct PoolEntry *pe)
+{
+  memcpy(pe->str, &FreeEntries[pe->cls], sizeof(struct PoolEntry *));
+  FreeEntries[pe->cls] = pe;
+}
+
+/**
+ * entry_new - Get an unused PoolEntry
+ * @param len Length of the string it must hold
+ * @retval ptr PoolEntry
+ */
+static struct PoolEntry *entry_new(size_t len)
+{
+  uint32_t cls = 0;
+  size_t size = STRPOOL_MIN_ENTRY;
+  while (size < (sizeof(struct PoolEntry) + len + 1))
+  {
+    size *= 2;
+    cls++;
+  }
+
+  struct PoolEntry *pe = FreeEntries[cls];
+  if (pe)
+    memcpy(&FreeEntries[cls], pe->str, sizeof(struct PoolEntry *));
+  else
+    pe = mutt_arena_alloc(PoolArena, size);
+
+  pe->refs = 0;
+  pe->cls = cls;
+  return pe;
+}
+
+/**
+ * strpool_release - Drop a reference to a pooled string - Implements ::arena_release_t
+ */
+static void strpool_release(struct Arena *a, void *ptr)
+{
+  struct PoolEntry *pe = entry_of(ptr);
+  if (--pe->refs > 0)
+    return;
+
+  mutt_hash_delete(PoolHash, pe->str, pe);
+  entry_free(pe);
+}
+
+/**
+ * mutt_strpool_getn - Get a pooled copy of a string
+ * @param str String
+ * @param len Length of the string
+ * @retval ptr Pooled string
+ *
+ * The string needn't be NUL-terminated.  Like mutt_strpool_get(), an empty
+ * string gives NULL.  Long strings aren't pooled, the caller gets a plain
+ * copy.  Either way, release it with mutt_mem_free().
+ */
+char *mutt_strpool_getn(const char *str, size_t len)
+{
+  if (!str || (len == 0))
+    return NULL;
+
+  if (len > STRPOOL_MAX_LEN)
+    return mutt_str_substr_dup(str, str + len);
+
+  if (!PoolArena)
+  {
+    PoolArena = mutt_arena_new();
+    PoolArena->release = strpool_release;
+    PoolHash = mutt_hash_new(4096, MUTT_HASH_NO_FLAGS);
+  }
+
+  struct PoolEntry *pe = entry_new(len);
+  memcpy(pe->str, str, len);
+  pe->str[len] = '\0';
+
+  struct PoolEntry *old = mutt_hash_find(PoolHash, pe->str);
+  if (old)
+  {
+    entry_free(pe);
+    pe = old;
+  }
+  else
+  {
+    mutt_hash_insert(PoolHash, pe->str, pe);
+  }
+
+  pe->refs++;
+  return pe->str;
+}
+
+/**
+ * mutt_strpool_get - Get a pooled copy of a string
+ * @param str String
+ * @retval ptr Pooled string
+ *
+ * If the string is already pooled, this just adds a reference.
+ * Release the result with mutt_mem_free().
+ *
+ * Like mutt_str_strdup(), an empty string gives NULL.
+ */
+char *mutt_strpool_get(const char *str)
+{
+  if (!str || (*str == '\0'))
+    return NULL;
+
+  if (PoolArena && (mutt_arena_find(str, NULL) == PoolArena))
+  {
+    struct PoolEntry *pe = entry_of(str);
+    pe->refs++;
+    return pe->str;
+  }
+
+  return mutt_strpool_getn(str, strlen(str));
+}
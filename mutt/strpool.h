@@ -0,0 +1,29 @@
+/**
+ * @file
+ * Shared, reference-counted strings
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_STRPOOL_H
+#define MUTT_LIB_STRPOOL_H
+
+#include <stddef.h>
+
+char *mutt_strpool_get (const char *str);
+char *mutt_strpool_getn(const char *str, size_t len);
+
+#endif /* MUTT_LIB_STRPOOL_H */
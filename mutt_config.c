@@ -67,6 +67,7 @@
 #include "remailer.h"
 #include "rfc3676.h"
 #include "score.h"
+#include "search_index.h"
 #include "send.h"
 #include "sendlib.h"
 #include "sidebar.h"
@@ -1682,6 +1683,9 @@ struct ConfigDef MuttVars[] = {
   ** prevent a timeout and disconnect when opening the mailbox, by sending
   ** a FETCH per set of this size instead of a single FETCH for all new
   ** headers.
+  ** .pp
+  ** Up to $$imap_pipeline_depth sets are requested at once, which hides the
+  ** latency of a slow connection.
   */
   { "imap_headers", DT_STRING|R_INDEX, &C_ImapHeaders, 0 },
   /*
@@ -1717,6 +1721,14 @@ struct ConfigDef MuttVars[] = {
   ** violated every now and then. Reduce this number if you find yourself
   ** getting disconnected from your IMAP server due to inactivity.
   */
+  { "imap_list_status", DT_BOOL, &C_ImapListStatus, true },
+  /*
+  ** .pp
+  ** When \fIset\fP, and the server supports the IMAP LIST-STATUS extension
+  ** (RFC5819), NeoMutt will check all the IMAP mailboxes of an account with a
+  ** single command, rather than sending a STATUS command for each one.
+  ** With many mailboxes, this makes $$mail_check much quicker.
+  */
   { "imap_list_subscribed", DT_BOOL, &C_ImapListSubscribed, false },
   /*
   ** .pp
@@ -1731,6 +1743,15 @@ struct ConfigDef MuttVars[] = {
   ** .pp
   ** This variable defaults to the value of $$imap_user.
   */
+  { "imap_notify", DT_BOOL, &C_ImapNotify, false },
+  /*
+  ** .pp
+  ** When \fIset\fP, and the server supports the IMAP NOTIFY extension
+  ** (RFC5465), NeoMutt will ask the server to report changes to all the IMAP
+  ** mailboxes of an account, as they happen.  NeoMutt no longer needs to poll
+  ** those mailboxes every $$mail_check seconds, and the counts in the
+  ** sidebar stay up to date.
+  */
   { "imap_oauth_refresh_command", DT_STRING|DT_COMMAND|DT_SENSITIVE, &C_ImapOauthRefreshCommand, 0 },
   /*
   ** .pp
@@ -1786,6 +1807,18 @@ struct ConfigDef MuttVars[] = {
   ** for new mail, before timing out and closing the connection.  Set
   ** to 0 to disable timing out.
   */
+  { "imap_prefetch_size", DT_LONG|DT_NOT_NEGATIVE, &C_ImapPrefetchSize, 0 },
+  /*
+  ** .pp
+  ** When set to a value greater than 0, NeoMutt will use the time it spends
+  ** waiting for a key to download the bodies of messages in the current
+  ** IMAP mailbox into the $$message_cachedir.  Unread messages are fetched
+  ** first.  Opening a prefetched message doesn't need the server.
+  ** .pp
+  ** This is the maximum number of bytes to download each time a mailbox is
+  ** opened, counted by the sizes of the messages in the index.  Prefetching
+  ** doesn't mark messages as read.
+  */
   { "imap_qresync", DT_BOOL, &C_ImapQresync, false },
   /*
   ** .pp
@@ -1832,6 +1865,9 @@ struct ConfigDef MuttVars[] = {
   ** an internal viewer defined for.  If such an entry is found, NeoMutt will
   ** use the viewer defined in that entry to convert the body part to text
   ** form.
+  ** .pp
+  ** When searching messages (see $$thorough_search), this only applies to
+  ** text parts.  Other types must be listed explicitly with "$auto_view".
   */
   { "include", DT_QUAD, &C_Include, MUTT_ASKYES },
   /*
@@ -2048,6 +2084,14 @@ struct ConfigDef MuttVars[] = {
   ** When $$mail_check_stats is \fIset\fP, this variable configures
   ** how often (in seconds) NeoMutt will update message counts.
   */
+  { "mailbox_arena", DT_BOOL, &C_MailboxArena, false },
+  /*
+  ** .pp
+  ** When \fIset\fP, the emails of a mailbox are allocated in large blocks
+  ** while it is being read, and all released together when it is closed.
+  ** This makes opening and closing large mailboxes faster, but the memory
+  ** of any emails deleted from a mailbox isn't reused until it is closed.
+  */
   { "mailcap_path", DT_SLIST|SLIST_SEP_COLON, &C_MailcapPath, IP "~/.mailcap:" PKGDATADIR "/mailcap:" SYSCONFDIR "/mailcap:/etc/mailcap:/usr/etc/mailcap:/usr/local/etc/mailcap" },
   /*
   ** .pp
@@ -2088,6 +2132,21 @@ struct ConfigDef MuttVars[] = {
   ** message every time the folder is opened (which can be very slow for NFS
   ** folders).
   */
+#endif
+#ifdef USE_PTHREAD
+  { "maildir_read_threads", DT_NUMBER|DT_NOT_NEGATIVE, &C_MaildirReadThreads, 0, 0, threads_validator },
+  /*
+  ** .pp
+  ** When opening a Maildir or MH mailbox, NeoMutt has to read the headers of
+  ** every message that isn't in the header cache.  If this variable is greater
+  ** than 0, that many background threads will read the message files ahead of
+  ** the parser, so that the disk is kept busy.  This can make opening a large
+  ** mailbox with a cold cache much faster, especially on slow or network
+  ** filesystems.  At most 32 threads can be used.
+  ** .pp
+  ** The messages are still parsed, and stored in the header cache, in order
+  ** by the main thread.
+  */
 #endif
   { "maildir_trash", DT_BOOL, &C_MaildirTrash, false },
   /*
@@ -2599,6 +2658,21 @@ struct ConfigDef MuttVars[] = {
   ** when you are at the end of a message and invoke the \fC<next-page>\fP
   ** function.
   */
+#ifdef USE_PTHREAD
+  { "pattern_threads", DT_NUMBER|DT_NOT_NEGATIVE, &C_PatternThreads, 0, 0, threads_validator },
+  /*
+  ** .pp
+  ** When limiting, tagging, untagging, deleting or undeleting messages by
+  ** pattern, NeoMutt normally matches every message in turn.  If this variable
+  ** is greater than 0, that many background threads help with the matching of
+  ** large mailboxes.  At most 32 threads can be used.
+  ** .pp
+  ** Only patterns that can be answered from the index are matched in
+  ** parallel, e.g. \fC~s\fP, \fC~f\fP, \fC~C\fP or \fC~d\fP.  Patterns that
+  ** need to read the messages, such as \fC~b\fP, run on the main thread as
+  ** before.  The results are the same either way.
+  */
+#endif
   { "pgp_auto_decode", DT_BOOL, &C_PgpAutoDecode, false },
   /*
   ** .pp
@@ -3623,6 +3697,18 @@ struct ConfigDef MuttVars[] = {
   ** For the pager, this variable specifies the number of lines shown
   ** before search results. By default, search results will be top-aligned.
   */
+  { "search_index", DT_BOOL, &C_SearchIndex, false },
+  /*
+  ** .pp
+  ** When \fIset\fP, NeoMutt remembers which text each message contains when
+  ** it's searched with \fC~b\fP, \fC~B\fP or \fC~h\fP.  Later searches for
+  ** plain text (not a regular expression with special characters) skip the
+  ** messages that can't contain it, without opening them.  Messages are
+  ** indexed by the first search that reads them, including new mail.
+  ** .pp
+  ** If $$header_cache is a directory, the index is also saved there, so it
+  ** can be used in later sessions.
+  */
   { "send_charset", DT_STRING, &C_SendCharset, IP "us-ascii:iso-8859-1:utf-8", 0, charset_validator },
   /*
   ** .pp
@@ -4661,6 +4747,8 @@ struct ConfigDef MuttVars[] = {
   ** character set conversions. Otherwise NeoMutt will attempt to match against the
   ** raw message received (for example quoted-printable encoded or with encoded
   ** headers) which may lead to incorrect search results.
+  ** .pp
+  ** Non-text attachments are only searched if they're listed in "$auto_view".
   */
   { "thread_received", DT_BOOL|R_RESORT|R_RESORT_INIT|R_INDEX, &C_ThreadReceived, false, 0, pager_validator },
   /*
@@ -40,6 +40,9 @@
 #include "muttlib.h"
 #include "mx.h"
 #include "protos.h"
+#ifdef USE_IMAP
+#include "imap/lib.h"
+#endif
 
 static time_t MailboxTime = 0; ///< last time we started checking for mail
 static time_t MailboxStatsTime = 0; ///< last time we check performed mail_check_stats
@@ -193,6 +196,13 @@ int mutt_mailbox_check(struct Mailbox *m_cur, int force)
     contex_sb.st_ino = 0;
   }
 
+#ifdef USE_IMAP
+  /* read the changes pushed by the server, or fetch the statistics of many
+   * IMAP mailboxes at once */
+  imap_notify_check();
+  imap_list_status();
+#endif
+
   struct MailboxList ml = neomutt_mailboxlist_get_all(NeoMutt, MUTT_MAILBOX_ANY);
   struct MailboxNode *np = NULL;
   STAILQ_FOREACH(np, &ml, entries)
@@ -450,6 +450,198 @@ static void make_subject_list(struct ListHead *subjects, struct MuttThread *cur,
   }
 }
 
+/**
+ * struct SubjectEmail - An Email in the subject Hash table
+ */
+struct SubjectEmail
+{
+  struct Email *email; ///< Email
+  time_t date;         ///< Date used for threading, see thread_date()
+};
+
+/**
+ * struct SubjectEmails - The Emails with the same subject
+ *
+ * The Emails are kept newest first, then by descending Email::index.
+ */
+struct SubjectEmails
+{
+  struct SubjectEmail *emails; ///< Emails, newest first
+  int num;                     ///< Number of Emails
+  int max;                     ///< Size of the array
+  bool received;               ///< Emails are sorted by their received date
+};
+
+/**
+ * thread_date - Get the date an Email is threaded by
+ * @param e Email
+ * @retval num Received or sent date, see $thread_received
+ */
+static time_t thread_date(const struct Email *e)
+{
+  return C_ThreadReceived ? e->received : e->date_sent;
+}
+
+/**
+ * compare_subject_emails - Sort Emails, newest first
+ * @param a First SubjectEmail
+ * @param b Second SubjectEmail
+ * @retval -1 a precedes b
+ * @retval  0 a and b are identical
+ * @retval  1 b precedes a
+ */
+static int compare_subject_emails(const void *a, const void *b)
+{
+  const struct SubjectEmail *sa = a;
+  const struct SubjectEmail *sb = b;
+
+  if (sa->date != sb->date)
+    return (sa->date > sb->date) ? -1 : 1;
+  return (sa->email->index < sb->email->index) - (sa->email->index > sb->email->index);
+}
+
+/**
+ * subject_emails_free - Free a SubjectEmails - Implements ::hash_hdata_free_t
+ */
+static void subject_emails_free(int type, void *obj, intptr_t data)
+{
+  struct SubjectEmails *se = obj;
+  FREE(&se->emails);
+  FREE(&se);
+}
+
+/**
+ * subject_position - Find where an Email belongs in a SubjectEmails
+ * @param se    Emails with the same subject
+ * @param date  Date of the Email
+ * @param index Email::index of the Email
+ * @retval num Index of the first older Email
+ */
+static int subject_position(const struct SubjectEmails *se, time_t date, int index)
+{
+  int lo = 0;
+  int hi = se->num;
+
+  while (lo < hi)
+  {
+    const int mid = lo + (hi - lo) / 2;
+    const struct SubjectEmail *sm = &se->emails[mid];
+    if ((sm->date > date) || ((sm->date == date) && (sm->email->index >= index)))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/**
+ * get_subject_emails - Get the Emails with a subject
+ * @param m    Mailbox
+ * @param subj Real subject
+ * @retval ptr  Emails, newest first
+ * @retval NULL No Emails have this subject
+ */
+static struct SubjectEmails *get_subject_emails(struct Mailbox *m, const char *subj)
+{
+  struct SubjectEmails *se = mutt_hash_find(m->subj_hash, subj);
+  if (!se || (se->received == C_ThreadReceived))
+    return se;
+
+  /* $thread_received has changed */
+  for (int i = 0; i < se->num; i++)
+    se->emails[i].date = thread_date(se->emails[i].email);
+  qsort(se->emails, se->num, sizeof(struct SubjectEmail), compare_subject_emails);
+  se->received = C_ThreadReceived;
+  return se;
+}
+
+/**
+ * subject_emails_append - Add an Email to the end of a SubjectEmails
+ * @param hash Subject Hash table
+ * @param e    Email
+ * @retval ptr Emails with the same subject as e
+ */
+static struct SubjectEmails *subject_emails_append(struct Hash *hash, struct Email *e)
+{
+  struct SubjectEmails *se = mutt_hash_find(hash, e->env->real_subj);
+  if (!se)
+  {
+    se = mutt_mem_calloc(1, sizeof(struct SubjectEmails));
+    se->received = C_ThreadReceived;
+    mutt_hash_insert(hash, e->env->real_subj, se);
+  }
+
+  if (se->num == se->max)
+  {
+    se->max = se->max ? (se->max * 2) : 4;
+    mutt_mem_realloc(&se->emails, se->max * sizeof(struct SubjectEmail));
+  }
+
+  se->emails[se->num].email = e;
+  se->emails[se->num].date = thread_date(e);
+  se->num++;
+  return se;
+}
+
+/**
+ * mutt_subj_hash_add - Add an Email to the subject Hash table
+ * @param m Mailbox
+ * @param e Email
+ *
+ * Nothing is done if the Mailbox doesn't have a subject Hash table.
+ */
+void mutt_subj_hash_add(struct Mailbox *m, struct Email *e)
+{
+  if (!m || !m->subj_hash || !e || !e->env || !e->env->real_subj)
+    return;
+
+  struct SubjectEmails *se = get_subject_emails(m, e->env->real_subj);
+  if (!se)
+  {
+    subject_emails_append(m->subj_hash, e);
+    return;
+  }
+
+  /* New mail is usually the newest, so this rarely moves many Emails */
+  const int pos = subject_position(se, thread_date(e), e->index);
+  subject_emails_append(m->subj_hash, e);
+  memmove(&se->emails[pos + 1], &se->emails[pos],
+          (se->num - 1 - pos) * sizeof(struct SubjectEmail));
+  se->emails[pos].email = e;
+  se->emails[pos].date = thread_date(e);
+}
+
+/**
+ * mutt_subj_hash_remove - Remove an Email from the subject Hash table
+ * @param m Mailbox
+ * @param e Email
+ *
+ * This must be called before the Email's subject is changed.
+ */
+void mutt_subj_hash_remove(struct Mailbox *m, struct Email *e)
+{
+  if (!m || !m->subj_hash || !e || !e->env || !e->env->real_subj)
+    return;
+
+  struct SubjectEmails *se = mutt_hash_find(m->subj_hash, e->env->real_subj);
+  if (!se)
+    return;
+
+  for (int i = 0; i < se->num; i++)
+  {
+    if (se->emails[i].email != e)
+      continue;
+
+    se->num--;
+    memmove(&se->emails[i], &se->emails[i + 1], (se->num - i) * sizeof(struct SubjectEmail));
+    break;
+  }
+
+  if (se->num == 0)
+    mutt_hash_delete(m->subj_hash, e->env->real_subj, se);
+}
+
 /**
  * find_subject - Find the best possible match for a parent based on subject
  * @param m   Mailbox
@@ -464,31 +656,35 @@ static struct MuttThread *find_subject(struct Mailbox *m, struct MuttThread *cur
   if (!m)
     return NULL;
 
-  struct HashElem *ptr = NULL;
   struct MuttThread *tmp = NULL, *last = NULL;
   struct ListHead subjects = STAILQ_HEAD_INITIALIZER(subjects);
   time_t date = 0;
+  time_t last_date = 0;
 
   make_subject_list(&subjects, cur, &date);
 
   struct ListNode *np = NULL;
   STAILQ_FOREACH(np, &subjects, entries)
   {
-    for (ptr = mutt_hash_find_bucket(m->subj_hash, np->data); ptr; ptr = ptr->next)
+    struct SubjectEmails *se = get_subject_emails(m, np->data);
+    if (!se)
+      continue;
+
+    /* The Emails are newest first, so the first match is the best */
+    for (int i = subject_position(se, date, INT_MAX); i < se->num; i++)
     {
-      tmp = ((struct Email *) ptr->data)->thread;
+      if (last && (se->emails[i].date <= last_date))
+        break;
+
+      tmp = se->emails[i].email->thread;
       if ((tmp != cur) &&                  /* don't match the same message */
           !tmp->fake_thread &&             /* don't match pseudo threads */
           tmp->message->subject_changed && /* only match interesting replies */
-          !is_descendant(tmp, cur) &&      /* don't match in the same thread */
-          (date >= (C_ThreadReceived ? tmp->message->received : tmp->message->date_sent)) &&
-          (!last || (C_ThreadReceived ?
-                         (last->message->received < tmp->message->received) :
-                         (last->message->date_sent < tmp->message->date_sent))) &&
-          tmp->message->env->real_subj &&
-          (mutt_str_strcmp(np->data, tmp->message->env->real_subj) == 0))
+          !is_descendant(tmp, cur))        /* don't match in the same thread */
       {
-        last = tmp; /* best match so far */
+        last = tmp;
+        last_date = se->emails[i].date;
+        break;
       }
     }
   }
@@ -501,13 +697,16 @@ static struct MuttThread *find_subject(struct Mailbox *m, struct MuttThread *cur
  * make_subj_hash - Create a Hash Table for the email subjects
  * @param m Mailbox
  * @retval ptr Newly allocated Hash Table
+ *
+ * The Hash Table maps each real subject to a SubjectEmails.
  */
 static struct Hash *make_subj_hash(struct Mailbox *m)
 {
   if (!m)
     return NULL;
 
-  struct Hash *hash = mutt_hash_new(m->msg_count * 2, MUTT_HASH_ALLOW_DUPS);
+  struct Hash *hash = mutt_hash_new(m->msg_count, MUTT_HASH_STRDUP_KEYS);
+  mutt_hash_set_destructor(hash, subject_emails_free, 0);
 
   for (int i = 0; i < m->msg_count; i++)
   {
@@ -515,12 +714,73 @@ static struct Hash *make_subj_hash(struct Mailbox *m)
     if (!e || !e->env)
       continue;
     if (e->env->real_subj)
-      mutt_hash_insert(hash, e->env->real_subj, e);
+      subject_emails_append(hash, e);
+  }
+
+  struct HashWalkState state = { 0 };
+  struct HashElem *he = NULL;
+  while ((he = mutt_hash_walk(hash, &state)))
+  {
+    struct SubjectEmails *se = he->data;
+    qsort(se->emails, se->num, sizeof(struct SubjectEmail), compare_subject_emails);
   }
 
   return hash;
 }
 
+/**
+ * pseudo_attach - Attach a thread to a parent with the same subject
+ * @param[in,out] top    List of threads containing cur
+ * @param[in]     parent New parent thread
+ * @param[in]     cur    Thread to attach
+ */
+static void pseudo_attach(struct MuttThread **top, struct MuttThread *parent,
+                          struct MuttThread *cur)
+{
+  struct MuttThread *tmp = NULL, *curchild = NULL, *nextchild = NULL;
+
+  cur->fake_thread = true;
+  unlink_message(top, cur);
+  insert_message(&parent->child, parent, cur);
+  parent->sort_children = true;
+  tmp = cur;
+  while (true)
+  {
+    while (!tmp->message)
+      tmp = tmp->child;
+
+    /* if the message we're attaching has pseudo-children, they
+     * need to be attached to its parent, so move them up a level.
+     * but only do this if they have the same real subject as the
+     * parent, since otherwise they rightly belong to the message
+     * we're attaching. */
+    if ((tmp == cur) || (mutt_str_strcmp(tmp->message->env->real_subj,
+                                         parent->message->env->real_subj) == 0))
+    {
+      tmp->message->subject_changed = false;
+
+      for (curchild = tmp->child; curchild;)
+      {
+        nextchild = curchild->next;
+        if (curchild->fake_thread)
+        {
+          unlink_message(&tmp->child, curchild);
+          insert_message(&parent->child, parent, curchild);
+        }
+        curchild = nextchild;
+      }
+    }
+
+    while (!tmp->next && (tmp != cur))
+    {
+      tmp = tmp->parent;
+    }
+    if (tmp == cur)
+      break;
+    tmp = tmp->next;
+  }
+}
+
 /**
  * pseudo_threads - Thread messages by subject
  * @param ctx Mailbox
@@ -536,8 +796,7 @@ static void pseudo_threads(struct Context *ctx)
 
   struct MuttThread *tree = ctx->tree;
   struct MuttThread *top = tree;
-  struct MuttThread *tmp = NULL, *cur = NULL, *parent = NULL, *curchild = NULL,
-                    *nextchild = NULL;
+  struct MuttThread *cur = NULL, *parent = NULL;
 
   if (!m->subj_hash)
     m->subj_hash = make_subj_hash(ctx->mailbox);
@@ -548,48 +807,7 @@ static void pseudo_threads(struct Context *ctx)
     tree = tree->next;
     parent = find_subject(ctx->mailbox, cur);
     if (parent)
-    {
-      cur->fake_thread = true;
-      unlink_message(&top, cur);
-      insert_message(&parent->child, parent, cur);
-      parent->sort_children = true;
-      tmp = cur;
-      while (true)
-      {
-        while (!tmp->message)
-          tmp = tmp->child;
-
-        /* if the message we're attaching has pseudo-children, they
-         * need to be attached to its parent, so move them up a level.
-         * but only do this if they have the same real subject as the
-         * parent, since otherwise they rightly belong to the message
-         * we're attaching. */
-        if ((tmp == cur) || (mutt_str_strcmp(tmp->message->env->real_subj,
-                                             parent->message->env->real_subj) == 0))
-        {
-          tmp->message->subject_changed = false;
-
-          for (curchild = tmp->child; curchild;)
-          {
-            nextchild = curchild->next;
-            if (curchild->fake_thread)
-            {
-              unlink_message(&tmp->child, curchild);
-              insert_message(&parent->child, parent, curchild);
-            }
-            curchild = nextchild;
-          }
-        }
-
-        while (!tmp->next && (tmp != cur))
-        {
-          tmp = tmp->parent;
-        }
-        if (tmp == cur)
-          break;
-        tmp = tmp->next;
-      }
-    }
+      pseudo_attach(&top, parent, cur);
   }
   ctx->tree = top;
 }
@@ -646,6 +864,102 @@ static int compare_threads(const void *a, const void *b)
   }
 }
 
+/**
+ * struct ThreadSortKey - A thread and its precomputed sort key
+ */
+struct ThreadSortKey
+{
+  struct SortField key;      ///< Key of the thread's sort_key Email
+  int index;                 ///< Email::index
+  struct MuttThread *thread; ///< Thread to sort
+};
+
+/* How compare_thread_keys() sorts */
+static struct
+{
+  enum SortType method; ///< Sort method
+  int sign;             ///< -1 for a reverse sort, otherwise 1
+} ThreadKeySpec;
+
+/**
+ * has_thread_key - Can threads be sorted by precomputed keys?
+ * @param method Sort method, e.g. #SORT_DATE
+ * @retval true The sort only compares a number or a string, then the Email::index
+ *
+ * compare_label() and compare_spam() return 0 for some ties and leave the
+ * order to qsort(), so those keep using compare_threads().
+ */
+static bool has_thread_key(int method)
+{
+  switch (method & SORT_MASK)
+  {
+    case SORT_LABEL:
+    case SORT_SPAM:
+      return false;
+    default:
+      return mutt_sort_has_key(method & SORT_MASK);
+  }
+}
+
+/**
+ * compare_thread_keys - Compare two precomputed sort keys
+ * @param a First ThreadSortKey
+ * @param b Second ThreadSortKey
+ * @retval <0 a precedes b
+ * @retval  0 a and b are identical
+ * @retval >0 b precedes a
+ *
+ * Threads are sorted without the $sort_aux, so ties fall back to the index.
+ */
+static int compare_thread_keys(const void *a, const void *b)
+{
+  const struct ThreadSortKey *ka = a;
+  const struct ThreadSortKey *kb = b;
+  bool aux = true;
+
+  int rc = mutt_sort_field_cmp(ThreadKeySpec.method, &ka->key, &kb->key, &aux);
+  if (rc == 0)
+    rc = ka->index - kb->index;
+
+  /* compare_subject() applies the reverse flag twice to the date order of
+   * emails without a subject */
+  if ((ThreadKeySpec.method == SORT_SUBJECT) && !ka->key.str && !kb->key.str)
+    return rc;
+
+  return ThreadKeySpec.sign * rc;
+}
+
+/**
+ * sort_siblings - Sort threads by their precomputed sort keys
+ * @param[in,out] array Threads to sort
+ * @param[in]     num   Number of threads
+ * @param[in,out] keys  Array for the keys, large enough for num entries
+ * @param[in]     arena Arena for the key strings
+ *
+ * This gives the same order as sorting with compare_threads(), but each key is
+ * only looked up once.
+ */
+static void sort_siblings(struct MuttThread **array, int num,
+                          struct ThreadSortKey *keys, struct Arena *arena)
+{
+  ThreadKeySpec.method = C_Sort & SORT_MASK;
+  ThreadKeySpec.sign = (C_Sort & SORT_REVERSE) ? -1 : 1;
+
+  for (int i = 0; i < num; i++)
+  {
+    struct Email *e = array[i]->sort_key;
+    memset(&keys[i].key, 0, sizeof(keys[i].key));
+    mutt_sort_field_set(&keys[i].key, e, ThreadKeySpec.method, arena);
+    keys[i].index = e->index;
+    keys[i].thread = array[i];
+  }
+
+  qsort(keys, num, sizeof(struct ThreadSortKey), compare_thread_keys);
+
+  for (int i = 0; i < num; i++)
+    array[i] = keys[i].thread;
+}
+
 /**
  * mutt_sort_subthreads - Sort the children of a thread
  * @param thread Thread to start at
@@ -655,6 +969,8 @@ static int compare_threads(const void *a, const void *b)
 struct MuttThread *mutt_sort_subthreads(struct MuttThread *thread, bool init)
 {
   struct MuttThread **array = NULL, *sort_key = NULL, *top = NULL, *tmp = NULL;
+  struct ThreadSortKey *keys = NULL;
+  struct Arena *arena = NULL;
   struct Email *oldsort_key = NULL;
   int i, array_size, sort_top = 0;
 
@@ -668,8 +984,16 @@ struct MuttThread *mutt_sort_subthreads(struct MuttThread *thread, bool init)
 
   top = thread;
 
+  /* Most sort methods only compare a number or a string, so avoid the sort function */
+  const bool keyed = has_thread_key(C_Sort);
+
   array_size = 256;
   array = mutt_mem_calloc(array_size, sizeof(struct MuttThread *));
+  if (keyed)
+  {
+    keys = mutt_mem_calloc(array_size, sizeof(struct ThreadSortKey));
+    arena = mutt_arena_new();
+  }
   while (true)
   {
     if (init || !thread->sort_key)
@@ -708,12 +1032,19 @@ struct MuttThread *mutt_sort_subthreads(struct MuttThread *thread, bool init)
         for (i = 0; thread; i++, thread = thread->prev)
         {
           if (i >= array_size)
+          {
             mutt_mem_realloc(&array, (array_size *= 2) * sizeof(struct MuttThread *));
+            if (keyed)
+              mutt_mem_realloc(&keys, array_size * sizeof(struct ThreadSortKey));
+          }
 
           array[i] = thread;
         }
 
-        qsort((void *) array, i, sizeof(struct MuttThread *), *compare_threads);
+        if (keyed)
+          sort_siblings(array, i, keys, arena);
+        else
+          qsort((void *) array, i, sizeof(struct MuttThread *), *compare_threads);
 
         /* attach them back together.  make thread the last sibling. */
         thread = array[0];
@@ -776,6 +1107,8 @@ struct MuttThread *mutt_sort_subthreads(struct MuttThread *thread, bool init)
       {
         C_Sort ^= SORT_REVERSE;
         FREE(&array);
+        FREE(&keys);
+        mutt_arena_free(&arena);
         return top;
       }
     }
@@ -784,6 +1117,32 @@ struct MuttThread *mutt_sort_subthreads(struct MuttThread *thread, bool init)
   }
 }
 
+/**
+ * set_subject_changed - Does an email's subject differ from its parent's?
+ * @param e Email
+ */
+static void set_subject_changed(struct Email *e)
+{
+  /* figure out which messages have subjects different than their parents' */
+  struct MuttThread *tmp = e->thread->parent;
+  while (tmp && !tmp->message)
+  {
+    tmp = tmp->parent;
+  }
+
+  if (!tmp)
+    e->subject_changed = true;
+  else if (e->env->real_subj && tmp->message->env->real_subj)
+  {
+    e->subject_changed =
+        (mutt_str_strcmp(e->env->real_subj, tmp->message->env->real_subj) != 0);
+  }
+  else
+  {
+    e->subject_changed = (e->env->real_subj || tmp->message->env->real_subj);
+  }
+}
+
 /**
  * check_subjects - Find out which emails' subjects differ from their parent's
  * @param m    Mailbox
@@ -805,31 +1164,356 @@ static void check_subjects(struct Mailbox *m, bool init)
     else if (!init)
       continue;
 
-    /* figure out which messages have subjects different than their parents' */
-    struct MuttThread *tmp = e->thread->parent;
-    while (tmp && !tmp->message)
+    set_subject_changed(e);
+  }
+}
+
+/**
+ * next_reference - Get the next Message-ID to thread an Email by
+ * @param[in]     e          Email
+ * @param[in]     ref        Previous reference, NULL to start
+ * @param[in,out] using_refs Which header is being used, 0 to start
+ * @retval ptr  Next reference
+ * @retval NULL No more references
+ */
+static struct ListNode *next_reference(struct Email *e, struct ListNode *ref, int *using_refs)
+{
+  if (*using_refs == 0)
+  {
+    /* look at the beginning of in-reply-to: */
+    ref = STAILQ_FIRST(&e->env->in_reply_to);
+    if (ref)
+      *using_refs = 1;
+    else
     {
-      tmp = tmp->parent;
+      ref = STAILQ_FIRST(&e->env->references);
+      *using_refs = 2;
     }
+  }
+  else if (*using_refs == 1)
+  {
+    /* if there's no references header, use all the in-reply-to:
+     * data that we have.  otherwise, use the first reference
+     * if it's different than the first in-reply-to, otherwise use
+     * the second reference (since at least eudora puts the most
+     * recent reference in in-reply-to and the rest in references) */
+    if (STAILQ_EMPTY(&e->env->references))
+      ref = STAILQ_NEXT(ref, entries);
+    else
+    {
+      if (mutt_str_strcmp(ref->data, STAILQ_FIRST(&e->env->references)->data) != 0)
+        ref = STAILQ_FIRST(&e->env->references);
+      else
+        ref = STAILQ_NEXT(STAILQ_FIRST(&e->env->references), entries);
 
-    if (!tmp)
-      e->subject_changed = true;
-    else if (e->env->real_subj && tmp->message->env->real_subj)
+      *using_refs = 2;
+    }
+  }
+  else
+    ref = STAILQ_NEXT(ref, entries); /* go on with references */
+
+  return ref;
+}
+
+/**
+ * new_thread - Create a MuttThread for an Email
+ * @param ctx Mailbox
+ * @param e   Email
+ * @param dup Thread of an Email with the same Message-ID (optional)
+ */
+static void new_thread(struct Context *ctx, struct Email *e, struct MuttThread *dup)
+{
+  struct MuttThread *thread = mutt_mem_calloc(1, sizeof(struct MuttThread));
+  thread->message = e;
+  thread->check_subject = true;
+  e->thread = thread;
+  mutt_hash_insert(ctx->thread_hash, e->env->message_id ? e->env->message_id : "", thread);
+
+  if (dup)
+  {
+    if (dup->duplicate_thread)
+      dup = dup->parent;
+
+    insert_message(&dup->child, dup, thread);
+    thread->duplicate_thread = true;
+    thread->message->threaded = true;
+  }
+}
+
+/**
+ * thread_by_references - Link an Email to its parents
+ * @param ctx Mailbox
+ * @param e   Email
+ * @param top Temporary parent of all the top-level threads
+ */
+static void thread_by_references(struct Context *ctx, struct Email *e, struct MuttThread *top)
+{
+  if (e->threaded)
+    return;
+  e->threaded = true;
+
+  struct MuttThread *thread = e->thread;
+  if (!thread)
+    return;
+
+  struct MuttThread *tnew = NULL;
+  struct ListNode *ref = NULL;
+  int using_refs = 0;
+
+  while ((ref = next_reference(e, ref, &using_refs)))
+  {
+    tnew = mutt_hash_find(ctx->thread_hash, ref->data);
+    if (tnew)
     {
-      e->subject_changed =
-          (mutt_str_strcmp(e->env->real_subj, tmp->message->env->real_subj) != 0);
+      if (tnew->duplicate_thread)
+        tnew = tnew->parent;
+      if (is_descendant(tnew, thread)) /* no loops! */
+        continue;
     }
     else
     {
-      e->subject_changed = (e->env->real_subj || tmp->message->env->real_subj);
+      tnew = mutt_mem_calloc(1, sizeof(struct MuttThread));
+      mutt_hash_insert(ctx->thread_hash, ref->data, tnew);
+    }
+
+    if (thread->parent)
+      unlink_message(&top->child, thread);
+    insert_message(&tnew->child, tnew, thread);
+    thread = tnew;
+    if (thread->message || (thread->parent && (thread->parent != top)))
+      break;
+  }
+
+  if (!thread->parent)
+    insert_message(&top->child, top, thread);
+}
+
+/**
+ * can_thread_new - Can a new Email be threaded without rethreading the rest?
+ * @param ctx Mailbox
+ * @param e   New Email
+ * @retval true The Email will only be added to the threads
+ *
+ * The Email mustn't be, or reply to, a message that's missing from the
+ * threads.  That would change how the existing threads are threaded by
+ * subject.  For the same reason, it must be newer than every threaded Email
+ * with the same subject.
+ */
+static bool can_thread_new(struct Context *ctx, struct Email *e)
+{
+  struct MuttThread *thread = NULL;
+
+  if (e->env->message_id)
+  {
+    thread = mutt_hash_find(ctx->thread_hash, e->env->message_id);
+    if (thread && !thread->message)
+      return false;
+  }
+
+  struct ListNode *ref = NULL;
+  int using_refs = 0;
+  while ((ref = next_reference(e, ref, &using_refs)))
+  {
+    thread = mutt_hash_find(ctx->thread_hash, ref->data);
+    if (!thread)
+      continue;
+    if (thread->duplicate_thread)
+      thread = thread->parent;
+    if (!thread->message)
+      return false;
+    break;
+  }
+
+  if (C_StrictThreads || !e->env->real_subj)
+    return true;
+
+  /* The first threaded Email is the newest one */
+  struct SubjectEmails *se = get_subject_emails(ctx->mailbox, e->env->real_subj);
+  for (int i = 0; se && (i < se->num); i++)
+  {
+    if (se->emails[i].email->thread)
+      return (se->emails[i].date < thread_date(e));
+  }
+
+  return true;
+}
+
+/**
+ * insert_sorted - Put a top-level thread in its place
+ * @param[in,out] tree     Sorted list of threads
+ * @param[in]     cur      Thread to insert
+ * @param[in]     sortfunc Sort function
+ */
+static void insert_sorted(struct MuttThread **tree, struct MuttThread *cur, sort_t sortfunc)
+{
+  struct MuttThread *prev = NULL;
+
+  if (sortfunc)
+  {
+    for (struct MuttThread *tmp = *tree; tmp; prev = tmp, tmp = tmp->next)
+    {
+      if (sortfunc(&cur->sort_key, &tmp->sort_key) < 0)
+        break;
+    }
+  }
+
+  if (!prev)
+  {
+    insert_message(tree, NULL, cur);
+    return;
+  }
+
+  cur->parent = NULL;
+  cur->prev = prev;
+  cur->next = prev->next;
+  if (prev->next)
+    prev->next->prev = cur;
+  prev->next = cur;
+}
+
+/**
+ * find_roots - Find the top-level threads containing some Emails
+ * @param[in]  emails Emails
+ * @param[in]  num    Number of Emails
+ * @param[out] roots  Array for the threads, large enough for num entries
+ * @retval num Number of different threads
+ */
+static int find_roots(struct Email **emails, int num, struct MuttThread **roots)
+{
+  int num_roots = 0;
+
+  for (int i = 0; i < num; i++)
+  {
+    struct MuttThread *thread = emails[i]->thread;
+    while (thread->parent)
+      thread = thread->parent;
+
+    int j;
+    for (j = 0; (j < num_roots) && (roots[j] != thread); j++)
+      ; // do nothing
+
+    if (j == num_roots)
+      roots[num_roots++] = thread;
+  }
+
+  return num_roots;
+}
+
+/**
+ * thread_new_emails - Add new Emails to the existing threads
+ * @param ctx Mailbox
+ * @retval true  Success, the threads are sorted
+ * @retval false The Mailbox needs threading from scratch
+ *
+ * Only the new Emails are linked into the threads, and only the threads that
+ * they join are resorted.  Nothing is changed if this isn't possible.
+ */
+static bool thread_new_emails(struct Context *ctx)
+{
+  struct Mailbox *m = ctx->mailbox;
+  struct MuttThread *thread = NULL;
+  struct Email **new_emails = NULL;
+  int num_new = 0;
+
+  if (!C_StrictThreads && !m->subj_hash)
+    m->subj_hash = make_subj_hash(m);
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (!e || e->thread)
+      continue;
+
+    if (!can_thread_new(ctx, e))
+    {
+      FREE(&new_emails);
+      return false;
     }
+
+    if ((num_new % 64) == 0)
+      mutt_mem_realloc(&new_emails, (num_new + 64) * sizeof(struct Email *));
+    new_emails[num_new++] = e;
   }
+
+  if (num_new == 0)
+    return true;
+
+  mutt_debug(LL_DEBUG2, "threading %d new emails\n", num_new);
+
+  /* Attach the threads to a temporary top node, like mutt_sort_threads() */
+  struct MuttThread top = { 0 };
+  top.child = ctx->tree;
+  for (thread = ctx->tree; thread; thread = thread->next)
+    thread->parent = &top;
+
+  for (int i = 0; i < num_new; i++)
+  {
+    struct Email *e = new_emails[i];
+    thread = NULL;
+    if (C_DuplicateThreads && e->env->message_id)
+      thread = mutt_hash_find(ctx->thread_hash, e->env->message_id);
+    new_thread(ctx, e, thread);
+  }
+
+  for (int i = 0; i < num_new; i++)
+    thread_by_references(ctx, new_emails[i], &top);
+
+  /* detach everything from the temporary top node */
+  ctx->tree = top.child;
+  for (thread = ctx->tree; thread; thread = thread->next)
+    thread->parent = NULL;
+
+  for (int i = 0; i < num_new; i++)
+  {
+    new_emails[i]->thread->check_subject = false;
+    set_subject_changed(new_emails[i]);
+  }
+
+  struct MuttThread **roots = mutt_mem_calloc(num_new, sizeof(struct MuttThread *));
+  int num_roots = 0;
+
+  /* The other threads can't be attached to the new Emails by subject, they're
+   * too recent.  So, only the threads containing new Emails need checking. */
+  if (!C_StrictThreads)
+  {
+    num_roots = find_roots(new_emails, num_new, roots);
+    for (int i = 0; i < num_roots; i++)
+    {
+      struct MuttThread *parent = find_subject(m, roots[i]);
+      if (parent)
+        pseudo_attach(&ctx->tree, parent, roots[i]);
+    }
+  }
+
+  /* Take out the changed threads, so that only sorted threads are left */
+  num_roots = find_roots(new_emails, num_new, roots);
+  for (int i = 0; i < num_roots; i++)
+  {
+    unlink_message(&ctx->tree, roots[i]);
+    roots[i]->next = NULL;
+    roots[i]->prev = NULL;
+  }
+
+  /* Sort each changed thread on its own, then put it back in its place */
+  sort_t sortfunc = mutt_get_sort_func(C_Sort & SORT_MASK);
+  for (int i = 0; i < num_roots; i++)
+  {
+    thread = mutt_sort_subthreads(roots[i], false);
+    insert_sorted(&ctx->tree, thread, sortfunc);
+  }
+
+  FREE(&roots);
+  FREE(&new_emails);
+  return true;
 }
 
 /**
  * mutt_sort_threads - Sort email threads
  * @param ctx  Mailbox
  * @param init If true, rebuild the thread
+ *
+ * If init is false and only new Emails have been added to the Mailbox, they
+ * are threaded without touching the rest.
  */
 void mutt_sort_threads(struct Context *ctx, bool init)
 {
@@ -839,10 +1523,9 @@ void mutt_sort_threads(struct Context *ctx, bool init)
   struct Mailbox *m = ctx->mailbox;
 
   struct Email *e = NULL;
-  int i, oldsort, using_refs = 0;
+  int i, oldsort;
   struct MuttThread *thread = NULL, *tnew = NULL, *tmp = NULL;
   struct MuttThread top = { 0 };
-  struct ListNode *ref = NULL;
 
   /* Set C_Sort to the secondary method to support the set sort_aux=reverse-*
    * settings.  The sorting functions just look at the value of SORT_REVERSE */
@@ -852,9 +1535,18 @@ void mutt_sort_threads(struct Context *ctx, bool init)
   if (!ctx->thread_hash)
     init = true;
 
+  if (!init && ctx->tree && thread_new_emails(ctx))
+  {
+    C_Sort = oldsort;
+    linearize_tree(ctx);
+    mutt_draw_tree(ctx);
+    return;
+  }
+
   if (init)
   {
-    ctx->thread_hash = mutt_hash_new(m->msg_count * 2, MUTT_HASH_ALLOW_DUPS);
+    ctx->thread_hash = mutt_hash_new(m->msg_count * 2,
+                                     MUTT_HASH_STRDUP_KEYS | MUTT_HASH_ALLOW_DUPS);
     mutt_hash_set_destructor(ctx->thread_hash, thread_hash_destructor, 0);
   }
 
@@ -925,26 +1617,7 @@ void mutt_sort_threads(struct Context *ctx, bool init)
       }
       else
       {
-        tnew = (C_DuplicateThreads ? thread : NULL);
-
-        thread = mutt_mem_calloc(1, sizeof(struct MuttThread));
-        thread->message = e;
-        thread->check_subject = true;
-        e->thread = thread;
-        mutt_hash_insert(ctx->thread_hash,
-                         e->env->message_id ? e->env->message_id : "", thread);
-
-        if (tnew)
-        {
-          if (tnew->duplicate_thread)
-            tnew = tnew->parent;
-
-          thread = e->thread;
-
-          insert_message(&tnew->child, tnew, thread);
-          thread->duplicate_thread = true;
-          thread->message->threaded = true;
-        }
+        new_thread(ctx, e, C_DuplicateThreads ? thread : NULL);
       }
     }
     else
@@ -973,78 +1646,7 @@ void mutt_sort_threads(struct Context *ctx, bool init)
     if (!e)
       break;
 
-    if (e->threaded)
-      continue;
-    e->threaded = true;
-
-    thread = e->thread;
-    if (!thread)
-      continue;
-    using_refs = 0;
-
-    while (true)
-    {
-      if (using_refs == 0)
-      {
-        /* look at the beginning of in-reply-to: */
-        ref = STAILQ_FIRST(&e->env->in_reply_to);
-        if (ref)
-          using_refs = 1;
-        else
-        {
-          ref = STAILQ_FIRST(&e->env->references);
-          using_refs = 2;
-        }
-      }
-      else if (using_refs == 1)
-      {
-        /* if there's no references header, use all the in-reply-to:
-         * data that we have.  otherwise, use the first reference
-         * if it's different than the first in-reply-to, otherwise use
-         * the second reference (since at least eudora puts the most
-         * recent reference in in-reply-to and the rest in references) */
-        if (STAILQ_EMPTY(&e->env->references))
-          ref = STAILQ_NEXT(ref, entries);
-        else
-        {
-          if (mutt_str_strcmp(ref->data, STAILQ_FIRST(&e->env->references)->data) != 0)
-            ref = STAILQ_FIRST(&e->env->references);
-          else
-            ref = STAILQ_NEXT(STAILQ_FIRST(&e->env->references), entries);
-
-          using_refs = 2;
-        }
-      }
-      else
-        ref = STAILQ_NEXT(ref, entries); /* go on with references */
-
-      if (!ref)
-        break;
-
-      tnew = mutt_hash_find(ctx->thread_hash, ref->data);
-      if (tnew)
-      {
-        if (tnew->duplicate_thread)
-          tnew = tnew->parent;
-        if (is_descendant(tnew, thread)) /* no loops! */
-          continue;
-      }
-      else
-      {
-        tnew = mutt_mem_calloc(1, sizeof(struct MuttThread));
-        mutt_hash_insert(ctx->thread_hash, ref->data, tnew);
-      }
-
-      if (thread->parent)
-        unlink_message(&top.child, thread);
-      insert_message(&tnew->child, tnew, thread);
-      thread = tnew;
-      if (thread->message || (thread->parent && (thread->parent != &top)))
-        break;
-    }
-
-    if (!thread->parent)
-      insert_message(&top.child, &top, thread);
+    thread_by_references(ctx, e, &top);
   }
 
   /* detach everything from the temporary top node */
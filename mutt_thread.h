@@ -76,5 +76,7 @@ int                mutt_parent_message    (struct Context *ctx, struct Email *e,
 void               mutt_set_vnum          (struct Context *ctx);
 struct MuttThread *mutt_sort_subthreads   (struct MuttThread *thread, bool init);
 void               mutt_sort_threads      (struct Context *ctx, bool init);
+void               mutt_subj_hash_add     (struct Mailbox *m, struct Email *e);
+void               mutt_subj_hash_remove  (struct Mailbox *m, struct Email *e);
 
 #endif /* MUTT_MUTT_THREAD_H */
@@ -34,7 +34,9 @@
 #include <limits.h>
 #include <locale.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include "mutt/lib.h"
@@ -82,6 +84,7 @@
 /* These Config Variables are only used in mx.c */
 unsigned char C_CatchupNewsgroup; ///< Config: (nntp) Mark all articles as read when leaving a newsgroup
 bool C_KeepFlagged; ///< Config: Don't move flagged messages from #C_Spoolfile to #C_Mbox
+bool C_MailboxArena; ///< Config: Allocate the emails of a mailbox in bulk
 unsigned char C_MboxType; ///< Config: Default type for creating new mailboxes
 unsigned char C_Move; ///< Config: Move emails from #C_Spoolfile to #C_Mbox when read
 char *C_Trash;        ///< Config: Folder to put deleted emails
@@ -245,6 +248,49 @@ static int mx_open_mailbox_append(struct Mailbox *m, OpenMailboxFlags flags)
   return rc;
 }
 
+/**
+ * mx_log_memory - Log the memory used by a Mailbox
+ * @param m    Mailbox
+ * @param what Description of the event, e.g. "opened"
+ */
+static void mx_log_memory(struct Mailbox *m, const char *what)
+{
+  if (C_DebugLevel < LL_DEBUG1)
+    return;
+
+  long rss = -1;
+  FILE *fp = fopen("/proc/self/statm", "r");
+  if (fp)
+  {
+    long pages = 0;
+    if (fscanf(fp, "%*s %ld", &pages) == 1)
+      rss = pages * (sysconf(_SC_PAGESIZE) / 1024);
+    mutt_file_fclose(&fp);
+  }
+
+  if (rss < 0)
+  {
+    /* No procfs, settle for the peak */
+    struct rusage ru = { 0 };
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+      rss = ru.ru_maxrss;
+  }
+
+  struct Arena *a = m->arena;
+  if (a)
+  {
+    mutt_debug(LL_DEBUG1,
+               "%s %s: %d emails, arena %zu allocs, %zu/%zu KiB, %zu KiB shared, RSS %ld KiB\n",
+               mailbox_path(m), what, m->msg_count, a->num_allocs, a->used / 1024,
+               a->size / 1024, a->shared / 1024, rss);
+  }
+  else
+  {
+    mutt_debug(LL_DEBUG1, "%s %s: %d emails, RSS %ld KiB\n", mailbox_path(m),
+               what, m->msg_count, rss);
+  }
+}
+
 /**
  * mx_mbox_open - Open a mailbox and parse it
  * @param m     Mailbox to open
@@ -366,7 +412,12 @@ struct Context *mx_mbox_open(struct Mailbox *m, OpenMailboxFlags flags)
   m->msg_tagged = 0;
   m->vcount = 0;
 
+  if (C_MailboxArena && !m->arena)
+    m->arena = mutt_arena_new();
+
+  struct Arena *arena = mutt_arena_swap(m->arena);
   int rc = m->mx_ops->mbox_open(ctx->mailbox);
+  mutt_arena_swap(arena);
   m->opened++;
   if (rc == 0)
     ctx_update(ctx);
@@ -397,6 +448,7 @@ struct Context *mx_mbox_open(struct Mailbox *m, OpenMailboxFlags flags)
     m->has_new = false;
   OptForceRefresh = false;
 
+  mx_log_memory(m, "opened");
   return ctx;
 
 error:
@@ -441,6 +493,15 @@ void mx_fastclose_mailbox(struct Mailbox *m)
       email_free(&m->emails[i]);
     }
   }
+
+  if (m->arena)
+  {
+    /* Nothing may point into the arena once it's gone */
+    for (int i = 0; i < m->email_max; i++)
+      email_free(&m->emails[i]);
+    mx_log_memory(m, "closed");
+    mutt_arena_free(&m->arena);
+  }
 }
 
 /**
@@ -1071,6 +1132,7 @@ struct Message *mx_msg_open_new(struct Mailbox *m, struct Email *e, MsgOpenFlags
     {
       if (e)
       {
+        mutt_env_load(e->env);
         p = TAILQ_FIRST(&e->env->return_path);
         if (!p)
           p = TAILQ_FIRST(&e->env->sender);
@@ -1106,7 +1168,9 @@ int mx_mbox_check(struct Mailbox *m, int *index_hint)
   if (!m || !m->mx_ops)
     return -1;
 
+  struct Arena *arena = mutt_arena_swap(m->arena);
   int rc = m->mx_ops->mbox_check(m, index_hint);
+  mutt_arena_swap(arena);
   if ((rc == MUTT_NEW_MAIL) || (rc == MUTT_REOPENED))
     mailbox_changed(m, NT_MAILBOX_INVALID);
 
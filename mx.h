@@ -41,6 +41,7 @@ extern const struct MxOps *mx_ops[];
 /* These Config Variables are only used in mx.c */
 extern unsigned char C_CatchupNewsgroup;
 extern bool          C_KeepFlagged;
+extern bool          C_MailboxArena;
 extern unsigned char C_MboxType;
 extern unsigned char C_Move;
 extern char *        C_Trash;
@@ -907,6 +907,7 @@ void crypt_extract_keys_from_messages(struct Mailbox *m, struct EmailList *el)
       fflush(fp_out);
 
       char *mbox = NULL;
+      mutt_env_load(e->env);
       if (!TAILQ_EMPTY(&e->env->from))
       {
         mutt_expand_aliases(&e->env->from);
@@ -5783,6 +5783,7 @@ static bool verify_sender(struct Email *e)
   struct Address *sender = NULL;
   bool rc = true;
 
+  mutt_env_load(e->env);
   if (!TAILQ_EMPTY(&e->env->from))
   {
     mutt_expand_aliases(&e->env->from);
@@ -1478,6 +1478,7 @@ int smime_class_verify_sender(struct Mailbox *m, struct Email *e)
   fflush(fp_out);
   mutt_file_fclose(&fp_out);
 
+  mutt_env_load(e->env);
   if (!TAILQ_EMPTY(&e->env->from))
   {
     mutt_expand_aliases(&e->env->from);
@@ -53,6 +53,7 @@
 #include "mutt_logging.h"
 #include "mutt_parse.h"
 #include "mutt_socket.h"
+#include "mutt_thread.h"
 #include "muttlib.h"
 #include "mx.h"
 #include "progress.h"
@@ -2787,16 +2788,14 @@ static int nntp_msg_open(struct Mailbox *m, struct Message *msg, int msgno)
    * hash elements must be updated because pointers will be changed */
   if (m->id_hash && e->env->message_id)
     mutt_hash_delete(m->id_hash, e->env->message_id, e);
-  if (m->subj_hash && e->env->real_subj)
-    mutt_hash_delete(m->subj_hash, e->env->real_subj, e);
+  mutt_subj_hash_remove(m, e);
 
   mutt_env_free(&e->env);
   e->env = mutt_rfc822_read_header(msg->fp, e, false, false);
 
   if (m->id_hash && e->env->message_id)
     mutt_hash_insert(m->id_hash, e->env->message_id, e);
-  if (m->subj_hash && e->env->real_subj)
-    mutt_hash_insert(m->subj_hash, e->env->real_subj, e);
+  mutt_subj_hash_add(m, e);
 
   /* fix content length */
   fseek(msg->fp, 0, SEEK_END);
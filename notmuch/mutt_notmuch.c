@@ -90,11 +90,16 @@ char *C_NmRepliedTag; ///< Config: (notmuch) Tag to use for replied messages
  * nm_hcache_open - Open a header cache
  * @param m Mailbox
  * @retval ptr Header cache handle
+ *
+ * The writes are batched until nm_hcache_close().
  */
 static header_cache_t *nm_hcache_open(struct Mailbox *m)
 {
 #ifdef USE_HCACHE
-  return mutt_hcache_open(C_HeaderCache, mailbox_path(m), NULL);
+  /* Emails are appended one at a time, so group the writes into a batch */
+  header_cache_t *h = mutt_hcache_open(C_HeaderCache, mailbox_path(m), NULL);
+  mutt_hcache_begin(h);
+  return h;
 #else
   return NULL;
 #endif
@@ -107,6 +112,7 @@ static header_cache_t *nm_hcache_open(struct Mailbox *m)
 static void nm_hcache_close(header_cache_t *h)
 {
 #ifdef USE_HCACHE
+  mutt_hcache_commit(h);
   mutt_hcache_close(h);
 #endif
 }
@@ -60,6 +60,7 @@
 #include "options.h"
 #include "progress.h"
 #include "protos.h"
+#include "search_index.h"
 #include "sendlib.h"
 #include "state.h"
 #include "ncrypt/lib.h"
@@ -69,8 +70,13 @@
 #ifdef USE_IMAP
 #include "imap/lib.h"
 #endif
+#ifdef USE_PTHREAD
+#include <pthread.h>
+#include <signal.h>
+#endif
 
 /* These Config Variables are only used in pattern.c */
+short C_PatternThreads; ///< Config: Number of threads used to match header patterns
 bool C_ThoroughSearch; ///< Config: Decode headers and messages before searching them
 
 // clang-format off
@@ -95,6 +101,8 @@ bool C_ThoroughSearch; ///< Config: Decode headers and messages before searching
 #define MEGA 1048576
 #define EMSG(e) (((e)->msgno) + 1)
 
+#define PATTERN_THREADS_MIN 1000 ///< Don't use threads for fewer Emails than this
+
 #define MUTT_MAXRANGE -1
 
 typedef uint16_t ParseDateRangeFlags; ///< Flags for parse_date_range(), e.g. #MUTT_PDR_MINUS
@@ -160,6 +168,19 @@ enum RangeSide
   RANGE_S_RIGHT, ///< Right side of range
 };
 
+/**
+ * enum PatternCost - Estimated cost of evaluating a Pattern
+ *
+ * The Patterns of a logical operation are evaluated cheapest first.
+ */
+enum PatternCost
+{
+  PAT_COST_FLAG,    ///< Test a flag or number in the Email
+  PAT_COST_HEADER,  ///< Match a header, e.g. a regex against the Subject
+  PAT_COST_THREAD,  ///< Evaluate a Pattern against the Emails in a thread
+  PAT_COST_MESSAGE, ///< Read the message from the Mailbox
+};
+
 /**
  * struct PatternFlags - Mapping between user character and internal constant
  */
@@ -253,6 +274,12 @@ static bool eat_regex(struct Pattern *pat, int flags, struct Buffer *s, struct B
       FREE(&pat->p.regex);
       return false;
     }
+    if (!strpbrk(buf.data, "\\^$.[]|()*+?{}"))
+    {
+      pat->literal = mutt_str_strdup(buf.data);
+      pat->ign_case = (case_flags != 0);
+      pat->is_literal = !pat->ign_case || mutt_str_is_ascii(buf.data, mutt_str_strlen(buf.data));
+    }
     FREE(&buf.data);
   }
 
@@ -1120,9 +1147,170 @@ static bool patmatch(const struct Pattern *pat, const char *buf)
     return pat->ign_case ? strcasestr(buf, pat->p.str) : strstr(buf, pat->p.str);
   if (pat->group_match)
     return mutt_group_match(pat->p.group, buf);
+  if (pat->is_literal)
+  {
+    if (!pat->ign_case)
+      return strstr(buf, pat->literal);
+    /* In Unicode locales, REG_ICASE also folds some non-ASCII characters to
+     * ASCII letters, e.g. the Kelvin sign to 'k', so leave those to the regex */
+    if (mutt_str_is_ascii(buf, strlen(buf)))
+      return strcasestr(buf, pat->literal);
+  }
   return (regexec(pat->p.regex, buf, 0, NULL, 0) == 0);
 }
 
+/**
+ * get_search_index - Get the Search Index for a Mailbox
+ * @param m Mailbox
+ * @retval ptr  Search Index
+ * @retval NULL $search_index is unset, or the Mailbox isn't open
+ */
+static struct SearchIndex *get_search_index(struct Mailbox *m)
+{
+  if (!C_SearchIndex || !Context || (Context->mailbox != m))
+    return NULL;
+
+  if (!Context->search_index)
+    Context->search_index = search_index_new();
+
+  return Context->search_index;
+}
+
+#ifdef HAVE_FOPENCOOKIE
+/**
+ * struct SearchStream - Match a Pattern against a message as it's decoded
+ */
+struct SearchStream
+{
+  struct Pattern *pat;     ///< Pattern to match
+  struct State *state;     ///< State of the body handlers writing the text
+  struct SearchScan *scan; ///< Search Index scan, if the message isn't indexed yet
+  char buf[256];           ///< Current line
+  size_t len;              ///< Length of the current line
+  bool match;              ///< The Pattern has matched
+};
+
+/**
+ * search_stream_line - Match one line of decoded text
+ * @param ss Search Stream
+ */
+static void search_stream_line(struct SearchStream *ss)
+{
+  ss->buf[ss->len] = '\0';
+  ss->len = 0;
+
+  search_index_scan_text(ss->scan, ss->buf);
+  if (!ss->match && patmatch(ss->pat, ss->buf))
+  {
+    ss->match = true;
+    /* Stop decoding, unless the Search Index needs the rest of the text */
+    if (!ss->scan)
+      ss->state->stop = true;
+  }
+}
+
+/**
+ * search_stream_write - Receive decoded text - Implements cookie_write_function_t
+ * @param cookie Search Stream
+ * @param data   Decoded text
+ * @param size   Length of text
+ * @retval num Bytes consumed (always all of them)
+ *
+ * The text is split into lines just as fgets() would split it.
+ * Once the Pattern has matched, and there's nothing left to index, the body
+ * handlers are told to stop and anything they've already written is thrown
+ * away.
+ */
+static ssize_t search_stream_write(void *cookie, const char *data, size_t size)
+{
+  struct SearchStream *ss = cookie;
+
+  for (size_t i = 0; i < size; i++)
+  {
+    if (ss->match && !ss->scan)
+      break;
+
+    ss->buf[ss->len++] = data[i];
+    if ((data[i] == '\n') || (ss->len == (sizeof(ss->buf) - 2)))
+      search_stream_line(ss);
+  }
+
+  return size;
+}
+
+/**
+ * search_stream_close - Match any unterminated last line - Implements cookie_close_function_t
+ * @param cookie Search Stream
+ * @retval 0 Always
+ */
+static int search_stream_close(void *cookie)
+{
+  struct SearchStream *ss = cookie;
+
+  if ((ss->len != 0) && (!ss->match || ss->scan))
+    search_stream_line(ss);
+
+  return 0;
+}
+
+/**
+ * msg_search_stream - Search a decoded email without buffering it
+ * @param m   Mailbox
+ * @param msg Open Message
+ * @param e   Email
+ * @param pat Pattern to find (not #MUTT_PAT_HEADER)
+ * @param si  Search Index (OPTIONAL)
+ * @retval true Pattern found
+ * @retval false Error or pattern not found
+ *
+ * The decoded text is matched, line by line, as the body handlers write it.
+ * Non-text parts are skipped unless they're listed in auto_view.
+ */
+static bool msg_search_stream(struct Mailbox *m, struct Message *msg, struct Email *e,
+                              struct Pattern *pat, struct SearchIndex *si)
+{
+  mutt_parse_mime_message(m, e);
+
+  if ((WithCrypto != 0) && (e->security & SEC_ENCRYPT) &&
+      !crypt_valid_passphrase(e->security))
+  {
+    return false;
+  }
+
+  struct SearchStream ss = { 0 };
+  ss.pat = pat;
+
+  cookie_io_functions_t io = { 0 };
+  io.write = search_stream_write;
+  io.close = search_stream_close;
+
+  struct State s = { 0 };
+  s.fp_in = msg->fp;
+  s.flags = MUTT_CHARCONV | MUTT_SEARCHING;
+  ss.state = &s;
+  s.fp_out = fopencookie(&ss, "w", io);
+  if (!s.fp_out)
+  {
+    mutt_perror(_("Error opening 'memory stream'"));
+    return false;
+  }
+
+  /* If the message isn't indexed yet, read all of it, even after a match */
+  ss.scan = search_index_scan_begin(si, m, e, pat->op);
+
+  if (pat->op != MUTT_PAT_BODY)
+    mutt_copy_header(msg->fp, e, s.fp_out, CH_FROM | CH_DECODE, NULL, 0);
+
+  fseeko(msg->fp, e->offset, SEEK_SET);
+  const int rc = mutt_body_handler(e->content, &s);
+
+  mutt_file_fclose(&s.fp_out);
+  search_index_scan_end(si, &ss.scan, (rc == 0) && !ferror(msg->fp));
+
+  return ss.match;
+}
+#endif
+
 /**
  * msg_search - Search an email
  * @param m   Mailbox
@@ -1134,15 +1322,34 @@ static bool patmatch(const struct Pattern *pat, const char *buf)
 static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
 {
   bool match = false;
+  struct SearchIndex *si = get_search_index(m);
+  if (si)
+  {
+    const char *literal = pat->string_match ? pat->p.str : pat->literal;
+    const bool icase = literal && !pat->string_match && mutt_mb_is_lower(literal);
+    if (!search_index_may_match(si, m, m->emails[msgno], pat->op, literal, icase))
+      return false;
+  }
+
   struct Message *msg = mx_msg_open(m, msgno);
   if (!msg)
   {
     return match;
   }
 
+#ifdef HAVE_FOPENCOOKIE
+  if (C_ThoroughSearch && (pat->op != MUTT_PAT_HEADER))
+  {
+    match = msg_search_stream(m, msg, m->emails[msgno], pat, si);
+    mx_msg_close(m, &msg);
+    return match;
+  }
+#endif
+
   FILE *fp = NULL;
   long len = 0;
   struct Email *e = m->emails[msgno];
+  bool decoded = true;
 #ifdef USE_FMEMOPEN
   char *temp = NULL;
   size_t tempsize = 0;
@@ -1155,7 +1362,7 @@ static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
     /* decode the header / body */
     struct State s = { 0 };
     s.fp_in = msg->fp;
-    s.flags = MUTT_CHARCONV;
+    s.flags = MUTT_CHARCONV | MUTT_SEARCHING;
 #ifdef USE_FMEMOPEN
     s.fp_out = open_memstream(&temp, &tempsize);
     if (!s.fp_out)
@@ -1194,7 +1401,8 @@ static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
       }
 
       fseeko(msg->fp, e->offset, SEEK_SET);
-      mutt_body_handler(e->content, &s);
+      if (mutt_body_handler(e->content, &s) != 0)
+        decoded = false;
     }
 
 #ifdef USE_FMEMOPEN
@@ -1248,6 +1456,9 @@ static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
   size_t blen = 256;
   char *buf = mutt_mem_malloc(blen);
 
+  /* If the message isn't indexed yet, read all of it, even after a match */
+  struct SearchScan *scan = search_index_scan_begin(si, m, e, pat->op);
+
   /* search the file "fp" */
   while (len > 0)
   {
@@ -1259,14 +1470,17 @@ static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
     }
     else if (!fgets(buf, blen - 1, fp))
       break; /* don't loop forever */
-    if (patmatch(pat, buf))
+    search_index_scan_text(scan, buf);
+    if (!match && patmatch(pat, buf))
     {
       match = true;
-      break;
+      if (!scan)
+        break;
     }
     len -= mutt_str_strlen(buf);
   }
 
+  search_index_scan_end(si, &scan, decoded && !ferror(fp));
   FREE(&buf);
 
   mx_msg_close(m, &msg);
@@ -1404,6 +1618,7 @@ void mutt_pattern_free(struct PatternList **pat)
       FREE(&np->p.regex);
     }
 
+    FREE(&np->literal);
     mutt_pattern_free(&np->child);
     FREE(&np);
 
@@ -1426,6 +1641,108 @@ static struct PatternList *mutt_pattern_node_new(void)
   return h;
 }
 
+/**
+ * pattern_cost - Estimate how expensive a Pattern is to evaluate
+ * @param pat Pattern
+ * @retval enum #PatternCost, e.g. #PAT_COST_HEADER
+ */
+static enum PatternCost pattern_cost(const struct Pattern *pat)
+{
+  enum PatternCost cost = PAT_COST_FLAG;
+  struct Pattern *p = NULL;
+
+  switch (pat->op)
+  {
+    case MUTT_PAT_AND:
+    case MUTT_PAT_OR:
+      SLIST_FOREACH(p, pat->child, entries)
+      {
+        cost = MAX(cost, pattern_cost(p));
+      }
+      return cost;
+
+    case MUTT_PAT_THREAD:
+    case MUTT_PAT_PARENT:
+    case MUTT_PAT_CHILDREN:
+      SLIST_FOREACH(p, pat->child, entries)
+      {
+        cost = MAX(cost, pattern_cost(p));
+      }
+      return MAX(cost, PAT_COST_THREAD);
+
+    case MUTT_PAT_ADDRESS:
+    case MUTT_PAT_CC:
+    case MUTT_PAT_DRIVER_TAGS:
+    case MUTT_PAT_FROM:
+    case MUTT_PAT_HORMEL:
+    case MUTT_PAT_ID:
+    case MUTT_PAT_ID_EXTERNAL:
+    case MUTT_PAT_LIST:
+#ifdef USE_NNTP
+    case MUTT_PAT_NEWSGROUPS:
+#endif
+    case MUTT_PAT_PERSONAL_FROM:
+    case MUTT_PAT_PERSONAL_RECIP:
+    case MUTT_PAT_RECIPIENT:
+    case MUTT_PAT_REFERENCE:
+    case MUTT_PAT_SENDER:
+    case MUTT_PAT_SUBJECT:
+    case MUTT_PAT_SUBSCRIBED_LIST:
+    case MUTT_PAT_TO:
+    case MUTT_PAT_XLABEL:
+      return PAT_COST_HEADER;
+
+    case MUTT_PAT_BODY:
+    case MUTT_PAT_HEADER:
+    case MUTT_PAT_MIMEATTACH:
+    case MUTT_PAT_MIMETYPE:
+    case MUTT_PAT_WHOLE_MSG:
+      return PAT_COST_MESSAGE;
+
+    default:
+      return PAT_COST_FLAG;
+  }
+}
+
+/**
+ * order_patterns - Order the Patterns of logical operations by cost
+ * @param pl Patterns to order
+ *
+ * The result of an AND or OR doesn't depend on the order of its Patterns, so
+ * put the cheap ones first to avoid the expensive ones where possible.
+ * Patterns of the same cost keep their order.
+ */
+static void order_patterns(struct PatternList *pl)
+{
+  struct PatternList sorted = SLIST_HEAD_INITIALIZER(sorted);
+  struct Pattern *pat = NULL;
+  struct Pattern *p = NULL;
+
+  while ((pat = SLIST_FIRST(pl)))
+  {
+    SLIST_REMOVE_HEAD(pl, entries);
+    if ((pat->op == MUTT_PAT_AND) || (pat->op == MUTT_PAT_OR))
+      order_patterns(pat->child);
+
+    /* The lists are short, so an insertion sort will do */
+    const enum PatternCost cost = pattern_cost(pat);
+    struct Pattern *prev = NULL;
+    SLIST_FOREACH(p, &sorted, entries)
+    {
+      if (pattern_cost(p) > cost)
+        break;
+      prev = p;
+    }
+
+    if (prev)
+      SLIST_INSERT_AFTER(prev, pat, entries);
+    else
+      SLIST_INSERT_HEAD(&sorted, pat, entries);
+  }
+
+  *pl = sorted;
+}
+
 /**
  * mutt_pattern_comp - Create a Pattern
  * @param s     Pattern string
@@ -1677,6 +1994,7 @@ struct PatternList *mutt_pattern_comp(const char *s, PatternCompFlags flags, str
     curlist = tmp;
   }
 
+  order_patterns(curlist);
   return curlist;
 
 cleanup:
@@ -1979,11 +2297,20 @@ static bool match_content_type(const struct Pattern *pat, struct Body *b)
  */
 static bool match_update_dynamic_date(struct Pattern *pat)
 {
+  /* The range only depends on the current time, so it only needs updating
+   * once a second, rather than for every Email */
+  const time_t now = mutt_date_epoch();
+  if (pat->date_updated == now)
+    return true;
+
   struct Buffer *err = mutt_buffer_pool_get();
 
   bool rc = eval_date_minmax(pat, pat->p.str, err);
   mutt_buffer_pool_release(&err);
 
+  if (rc)
+    pat->date_updated = now;
+
   return rc;
 }
 
@@ -2211,6 +2538,7 @@ int mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags,
     case MUTT_PAT_SENDER:
       if (!e->env)
         return 0;
+      mutt_env_load(e->env);
       return pat->pat_not ^ match_addrlist(pat, (flags & MUTT_MATCH_FULL_ADDRESS),
                                            1, &e->env->sender);
     case MUTT_PAT_FROM:
@@ -2252,6 +2580,7 @@ int mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags,
     case MUTT_PAT_ADDRESS:
       if (!e->env)
         return 0;
+      mutt_env_load(e->env);
       return pat->pat_not ^ match_addrlist(pat, (flags & MUTT_MATCH_FULL_ADDRESS),
                                            4, &e->env->from, &e->env->sender,
                                            &e->env->to, &e->env->cc);
@@ -2543,6 +2872,197 @@ bool mutt_limit_current_thread(struct Email *e)
   return true;
 }
 
+#ifdef USE_PTHREAD
+/**
+ * struct PatternWorker - A thread matching a Pattern against some Emails
+ */
+struct PatternWorker
+{
+  struct PatternList *pat; ///< Private copy of the Pattern
+  struct Mailbox *m;       ///< Mailbox
+  bool virt;               ///< Match the visible Emails, not all of them
+  int first;               ///< First Email to match
+  int last;                ///< One past the last Email to match
+  bool *matches;           ///< Results, indexed like the Emails
+  pthread_t thread;        ///< Thread
+};
+
+/**
+ * is_thread_safe - Can a Pattern be matched outside the main thread?
+ * @param pl Patterns to check
+ * @retval true The Patterns only read the Emails
+ *
+ * Patterns that read the message, query other programs, load deferred
+ * headers or log while matching need global state, so they're excluded.
+ */
+static bool is_thread_safe(const struct PatternList *pl)
+{
+  const struct Pattern *pat = NULL;
+  SLIST_FOREACH(pat, pl, entries)
+  {
+    if (pat->group_match || pat->is_alias || pat->dynamic)
+      return false;
+
+    switch (pat->op)
+    {
+      case MUTT_PAT_AND:
+      case MUTT_PAT_OR:
+      case MUTT_PAT_THREAD:
+      case MUTT_PAT_PARENT:
+      case MUTT_PAT_CHILDREN:
+        if (!is_thread_safe(pat->child))
+          return false;
+        break;
+
+      case MUTT_ALL:
+      case MUTT_DELETED:
+      case MUTT_EXPIRED:
+      case MUTT_FLAG:
+      case MUTT_NEW:
+      case MUTT_OLD:
+      case MUTT_READ:
+      case MUTT_REPLIED:
+      case MUTT_SUPERSEDED:
+      case MUTT_TAG:
+      case MUTT_UNREAD:
+      case MUTT_PAT_BROKEN:
+      case MUTT_PAT_CC:
+      case MUTT_PAT_CRYPT_ENCRYPT:
+      case MUTT_PAT_CRYPT_SIGN:
+      case MUTT_PAT_CRYPT_VERIFIED:
+      case MUTT_PAT_DATE:
+      case MUTT_PAT_DATE_RECEIVED:
+      case MUTT_PAT_DRIVER_TAGS:
+      case MUTT_PAT_DUPLICATED:
+      case MUTT_PAT_FROM:
+      case MUTT_PAT_HORMEL:
+      case MUTT_PAT_ID:
+      case MUTT_PAT_MESSAGE:
+#ifdef USE_NNTP
+      case MUTT_PAT_NEWSGROUPS:
+#endif
+      case MUTT_PAT_PGP_KEY:
+      case MUTT_PAT_RECIPIENT:
+      case MUTT_PAT_REFERENCE:
+      case MUTT_PAT_SCORE:
+      case MUTT_PAT_SIZE:
+      case MUTT_PAT_SUBJECT:
+      case MUTT_PAT_TO:
+      case MUTT_PAT_UNREFERENCED:
+      case MUTT_PAT_XLABEL:
+        break;
+
+      default:
+        return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * pattern_worker - Match a Pattern against a range of Emails
+ * @param arg PatternWorker
+ * @retval NULL Always
+ */
+static void *pattern_worker(void *arg)
+{
+  struct PatternWorker *pw = arg;
+
+  for (int i = pw->first; i < pw->last; i++)
+  {
+    struct Email *e = pw->virt ? mutt_get_virt_email(pw->m, i) : pw->m->emails[i];
+    if (!e)
+      continue;
+    pw->matches[i] = (mutt_pattern_exec(SLIST_FIRST(pw->pat), MUTT_MATCH_FULL_ADDRESS,
+                                        pw->m, e, NULL) != 0);
+  }
+
+  return NULL;
+}
+
+/**
+ * match_parallel - Match a Pattern against many Emails using threads
+ * @param str  Pattern string
+ * @param pat  Compiled Pattern
+ * @param m    Mailbox
+ * @param virt If true, match the visible Emails, otherwise all of them
+ * @param num  Number of Emails
+ * @retval ptr  Array of results, indexed like the Emails
+ * @retval NULL Threads weren't used; the caller must match the Emails
+ *
+ * Each thread gets its own copy of the Pattern, so that the regexes aren't
+ * shared, and a contiguous range of Emails.  The main thread matches the
+ * first range.  The results don't depend on the number of threads.
+ *
+ * The caller must free the array.
+ */
+static bool *match_parallel(const char *str, struct PatternList *pat,
+                            struct Mailbox *m, bool virt, int num)
+{
+  if ((C_PatternThreads < 1) || (num < PATTERN_THREADS_MIN) || !is_thread_safe(pat))
+    return NULL;
+
+  const int threads = C_PatternThreads + 1;
+  const int chunk = (num + threads - 1) / threads;
+  bool *matches = mutt_mem_calloc(num, sizeof(bool));
+  struct PatternWorker *workers = mutt_mem_calloc(threads, sizeof(struct PatternWorker));
+  struct Buffer *err = mutt_buffer_pool_get();
+
+  for (int i = 0; i < threads; i++)
+  {
+    workers[i].pat = (i == 0) ? pat : mutt_pattern_comp(str, MUTT_PC_FULL_MSG, err);
+    workers[i].m = m;
+    workers[i].virt = virt;
+    workers[i].first = MIN(i * chunk, num);
+    workers[i].last = MIN((i + 1) * chunk, num);
+    workers[i].matches = matches;
+  }
+  mutt_buffer_pool_release(&err);
+
+  /* Signals must be handled by the main thread */
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_BLOCK, &all, &old);
+  bool *running = mutt_mem_calloc(threads, sizeof(bool));
+  for (int i = 1; i < threads; i++)
+  {
+    if (workers[i].pat && (workers[i].first < workers[i].last))
+    {
+      running[i] = (pthread_create(&workers[i].thread, NULL, pattern_worker,
+                                   &workers[i]) == 0);
+    }
+  }
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+  /* Anything that didn't get a thread is matched here */
+  for (int i = 0; i < threads; i++)
+  {
+    if (running[i])
+      continue;
+    if (!workers[i].pat)
+      workers[i].pat = pat;
+    pattern_worker(&workers[i]);
+  }
+
+  for (int i = 1; i < threads; i++)
+  {
+    if (running[i])
+      pthread_join(workers[i].thread, NULL);
+  }
+
+  for (int i = 1; i < threads; i++)
+  {
+    if (workers[i].pat != pat)
+      mutt_pattern_free(&workers[i].pat);
+  }
+
+  FREE(&running);
+  FREE(&workers);
+  return matches;
+}
+#endif
+
 /**
  * mutt_pattern_func - Perform some Pattern matching
  * @param op     Operation to perform, e.g. #MUTT_LIMIT
@@ -2560,6 +3080,7 @@ int mutt_pattern_func(int op, char *prompt)
   struct Progress progress;
   struct Buffer *buf = mutt_buffer_pool_get();
   struct Mailbox *m = Context->mailbox;
+  bool *matches = NULL;
 
   mutt_buffer_strcpy(buf, NONULL(Context->pattern));
   if (prompt || (op != MUTT_LIMIT))
@@ -2597,6 +3118,9 @@ int mutt_pattern_func(int op, char *prompt)
 
   if (op == MUTT_LIMIT)
   {
+#ifdef USE_PTHREAD
+    matches = match_parallel(buf->data, pat, m, false, m->msg_count);
+#endif
     m->vcount = 0;
     Context->vsize = 0;
     Context->collapsed = false;
@@ -2614,7 +3138,8 @@ int mutt_pattern_func(int op, char *prompt)
       e->limited = false;
       e->collapsed = false;
       e->num_hidden = 0;
-      if (mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL))
+      if (matches ? matches[i] :
+                    mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL))
       {
         e->vnum = m->vcount;
         e->limited = true;
@@ -2627,13 +3152,17 @@ int mutt_pattern_func(int op, char *prompt)
   }
   else
   {
+#ifdef USE_PTHREAD
+    matches = match_parallel(buf->data, pat, m, true, m->vcount);
+#endif
     for (int i = 0; i < m->vcount; i++)
     {
       struct Email *e = mutt_get_virt_email(Context->mailbox, i);
       if (!e)
         continue;
       mutt_progress_update(&progress, i, -1);
-      if (mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL))
+      if (matches ? matches[i] :
+                    mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL))
       {
         switch (op)
         {
@@ -2680,6 +3209,7 @@ int mutt_pattern_func(int op, char *prompt)
 bail:
   mutt_buffer_pool_release(&buf);
   FREE(&simple);
+  FREE(&matches);
   mutt_pattern_free(&pat);
   FREE(&err.data);
 
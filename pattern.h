@@ -27,6 +27,7 @@
 #include "config.h"
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 #include "mutt/lib.h"
 #include "mutt.h"
 
@@ -35,6 +36,7 @@ struct Envelope;
 struct Mailbox;
 
 /* These Config Variables are only used in pattern.c */
+extern short C_PatternThreads;
 extern bool C_ThoroughSearch;
 
 typedef uint8_t PatternCompFlags;       ///< Flags for mutt_pattern_comp(), e.g. #MUTT_PC_FULL_MSG
@@ -53,14 +55,17 @@ struct Pattern
   bool all_addr     : 1;         ///< All Addresses in the list must match
   bool string_match : 1;         ///< Check a string for a match
   bool group_match  : 1;         ///< Check a group of Addresses
-  bool ign_case     : 1;         ///< Ignore case for local string_match searches
+  bool ign_case     : 1;         ///< Ignore case for string_match and literal searches
   bool is_alias     : 1;         ///< Is there an alias for this Address?
   bool dynamic      : 1;         ///< Evaluate date ranges at run time
   bool sendmode     : 1;         ///< Evaluate searches in send-mode
   bool is_multi     : 1;         ///< Multiple case (only for ~I pattern now)
+  bool is_literal   : 1;         ///< Match the literal instead of the regex (for ign_case, in ASCII text)
   int min;                       ///< Minimum for range checks
   int max;                       ///< Maximum for range checks
+  time_t date_updated;           ///< When a dynamic date range was last evaluated
   struct PatternList *child;     ///< Arguments to logical operation
+  char *literal;                 ///< Plain text of a regex without special characters
   union {
     regex_t *regex;              ///< Compiled regex, for non-pattern matching
     struct Group *group;         ///< Address group if group_match is set
@@ -51,6 +51,7 @@
 #include "mutt_header.h"
 #include "mutt_logging.h"
 #include "mutt_socket.h"
+#include "mutt_thread.h"
 #include "muttlib.h"
 #include "mx.h"
 #include "progress.h"
@@ -1161,13 +1162,11 @@ static int pop_msg_open(struct Mailbox *m, struct Message *msg, int msgno)
   e->edata = NULL;
 
   /* we replace envelope, key in subj_hash has to be updated as well */
-  if (m->subj_hash && e->env->real_subj)
-    mutt_hash_delete(m->subj_hash, e->env->real_subj, e);
+  mutt_subj_hash_remove(m, e);
   mutt_label_hash_remove(m, e);
   mutt_env_free(&e->env);
   e->env = mutt_rfc822_read_header(msg->fp, e, false, false);
-  if (m->subj_hash && e->env->real_subj)
-    mutt_hash_insert(m->subj_hash, e->env->real_subj, e);
+  mutt_subj_hash_add(m, e);
   mutt_label_hash_add(m, e);
 
   /* Reattach the private data */
@@ -418,6 +418,7 @@ int mutt_get_postponed(struct Context *ctx, struct Email *hdr,
     mx_mbox_close(&ctx_post);
   C_Delete = opt_delete;
 
+  mutt_env_load(hdr->env);
   struct ListNode *np = NULL, *tmp = NULL;
   STAILQ_FOREACH_SAFE(np, &hdr->env->userhdrs, entries, tmp)
   {
@@ -0,0 +1,592 @@
+/**
+ * @file
+ * Trigram index of the text of searched messages
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page search_index Trigram index of the text of searched messages
+ *
+ * Searching the body or headers of a message (~b, ~B, ~h) means opening and
+ * decoding it.  To avoid repeating that work, the first search of a message
+ * records a signature of the text it scanned: a Bloom filter of every
+ * three-byte sequence (trigram), with ASCII letters folded to lower case.
+ *
+ * Later searches for a literal string check its trigrams against the
+ * signature first.  If any of them is missing, the message can't match and
+ * isn't opened.  Otherwise, the message is searched as usual.  The signature
+ * never causes a match to be missed; it only lets non-matches be skipped.
+ *
+ * The signatures are keyed by the mailbox, the Message-ID and date of the
+ * message, the type of search and the settings that affect decoding and, for
+ * $thorough_search, which parts are displayed.  The key also
+ * describes the text that was scanned, so that it changes when the message
+ * does: the size of the header and body, the flags and fields that NeoMutt
+ * rewrites in the header and, for Maildir and MH, the file's mtime.
+ *
+ * A header isn't indexed while it has changes that haven't been written back
+ * to the mailbox.  Encrypted messages are never indexed.  When a message is edited, its old signatures are dropped,
+ * in case the new copy has the same key.
+ *
+ * The signatures are kept in memory and, if there's a header cache
+ * directory, in a database alongside the header caches, so they survive
+ * between sessions.
+ *
+ * New mail isn't read in advance; it's indexed by the first search that
+ * scans it.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "search_index.h"
+#include "globals.h"
+#include "handler.h"
+#include "muttlib.h"
+#include "pattern.h"
+#include "ncrypt/lib.h"
+#ifdef USE_HCACHE
+#include "hcache/lib.h"
+#endif
+
+/* These Config Variables are only used in search_index.c */
+bool C_SearchIndex; ///< Config: Remember which text searched messages contain
+
+#define SEARCH_INDEX_VERSION 3     ///< Change this if the signature format changes
+#define SCAN_BYTES 4096            ///< Largest signature, in bytes
+#define SIG_MIN_BYTES 64           ///< Smallest signature, in bytes
+#define SIG_BITS_PER_TRIGRAM 4     ///< Bits per trigram, keeps false positives low
+
+/**
+ * struct SearchSig - Signature of the text of a message
+ */
+struct SearchSig
+{
+  size_t size;         ///< Size of the Bloom filter in bytes, a power of two
+  unsigned char *bits; ///< Bloom filter of the trigrams
+};
+
+/**
+ * struct SearchIndex - Signatures of the text of searched messages
+ */
+struct SearchIndex
+{
+  struct Hash *sigs;   ///< Hash Table: key -> SearchSig
+  uint32_t display;    ///< Hash of the settings that choose the displayed parts
+  time_t display_time; ///< When display was calculated
+#ifdef USE_HCACHE
+  header_cache_t *hc;  ///< Database of signatures
+#endif
+};
+
+/**
+ * struct SearchScan - Signature of a message being searched
+ */
+struct SearchScan
+{
+  char *key;                       ///< Key of the signature
+  unsigned char bits[SCAN_BYTES];  ///< Bloom filter of the trigrams
+};
+
+/**
+ * fold - Fold an ASCII letter to lower case
+ * @param c Character
+ * @retval num Folded character
+ *
+ * Non-ASCII bytes are left alone, so the result doesn't depend on the locale.
+ */
+static unsigned char fold(unsigned char c)
+{
+  return ((c >= 'A') && (c <= 'Z')) ? (c - 'A' + 'a') : c;
+}
+
+/**
+ * has_wide_fold - Can a non-ASCII letter fold to this letter?
+ * @param c Character
+ * @retval true A case-insensitive regex may match c with a non-ASCII letter
+ *
+ * e.g. KELVIN SIGN folds to 'k', LONG S to 's' and DOTTED CAPITAL I to 'i'.
+ */
+static bool has_wide_fold(unsigned char c)
+{
+  c = fold(c);
+  return (c == 'i') || (c == 'k') || (c == 's');
+}
+
+/**
+ * trigram_hash - Hash three bytes of text
+ * @param s Text, at least three bytes long
+ * @retval num Hash
+ */
+static uint32_t trigram_hash(const unsigned char *s)
+{
+  uint32_t h = ((uint32_t) fold(s[0]) << 16) | ((uint32_t) fold(s[1]) << 8) | fold(s[2]);
+  h *= 0x9E3779B1;
+  return h ^ (h >> 15);
+}
+
+/**
+ * sig_free - Free a SearchSig - Implements ::hash_hdata_free_t
+ */
+static void sig_free(int type, void *obj, intptr_t data)
+{
+  struct SearchSig *sig = obj;
+  FREE(&sig->bits);
+  FREE(&sig);
+}
+
+/**
+ * str_hash - Add a string to a hash
+ * @param h   Hash so far
+ * @param str String
+ * @retval num New hash
+ */
+static uint32_t str_hash(uint32_t h, const char *str)
+{
+  for (const unsigned char *p = (const unsigned char *) NONULL(str); *p; p++)
+    h = (h ^ *p) * 16777619;
+  return (h ^ '\n') * 16777619;
+}
+
+/**
+ * header_hash - Hash the header fields that NeoMutt may rewrite
+ * @param env Envelope
+ * @retval num Hash
+ *
+ * These fields are written back to the mailbox when they're changed, e.g. by
+ * edit-label or link-threads.
+ */
+static uint32_t header_hash(const struct Envelope *env)
+{
+  uint32_t h = 2166136261;
+  h = str_hash(h, env->subject);
+  h = str_hash(h, env->x_label);
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &env->in_reply_to, entries)
+  {
+    h = str_hash(h, np->data);
+  }
+  h = str_hash(h, NULL);
+  STAILQ_FOREACH(np, &env->references, entries)
+  {
+    h = str_hash(h, np->data);
+  }
+
+  return h;
+}
+
+/**
+ * display_hash - Hash the settings that choose which parts are displayed
+ * @param si Search Index
+ * @retval num Hash
+ *
+ * These affect the text that $thorough_search decodes.  The mailcap files are
+ * checked at most once a second.
+ */
+static uint32_t display_hash(struct SearchIndex *si)
+{
+  const time_t now = mutt_date_epoch();
+  if (si->display_time == now)
+    return si->display;
+
+  uint32_t h = 2166136261;
+  h = str_hash(h, C_ImplicitAutoview ? "i" : "");
+  h = str_hash(h, C_HonorDisposition ? "d" : "");
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &AutoViewList, entries)
+  {
+    h = str_hash(h, np->data);
+  }
+  h = str_hash(h, NULL);
+  STAILQ_FOREACH(np, &AlternativeOrderList, entries)
+  {
+    h = str_hash(h, np->data);
+  }
+  h = str_hash(h, NULL);
+
+  if (C_MailcapPath)
+  {
+    struct Buffer *path = mutt_buffer_pool_get();
+    struct stat st;
+    STAILQ_FOREACH(np, &C_MailcapPath->head, entries)
+    {
+      mutt_buffer_strcpy(path, np->data);
+      mutt_buffer_expand_path(path);
+      h = str_hash(h, mutt_b2s(path));
+      if (stat(mutt_b2s(path), &st) == 0)
+        h = (h ^ (uint32_t) st.st_mtime) * 16777619;
+    }
+    mutt_buffer_pool_release(&path);
+  }
+
+  si->display = h;
+  si->display_time = now;
+  return h;
+}
+
+/**
+ * message_mtime - Get the mtime of a message's file
+ * @param[in]  m     Mailbox
+ * @param[in]  e     Email
+ * @param[out] mtime Modification time, 0 if the message isn't a file
+ * @retval true  Success
+ * @retval false The file can't be read
+ */
+static bool message_mtime(struct Mailbox *m, const struct Email *e, time_t *mtime)
+{
+  *mtime = 0;
+  if ((m->type != MUTT_MAILDIR) && (m->type != MUTT_MH))
+    return true;
+  if (!e->path)
+    return false;
+
+  struct Buffer *path = mutt_buffer_pool_get();
+  mutt_buffer_printf(path, "%s/%s", mailbox_path(m), e->path);
+  struct stat st;
+  bool rc = (stat(mutt_b2s(path), &st) == 0);
+  if (rc)
+    *mtime = st.st_mtime;
+  mutt_buffer_pool_release(&path);
+
+  return rc;
+}
+
+/**
+ * make_key - Create the key for a message's signature
+ * @param si  Search Index
+ * @param buf Buffer for the key
+ * @param m   Mailbox
+ * @param e   Email
+ * @param op  Type of search, e.g. #MUTT_PAT_BODY
+ * @retval true  Success
+ * @retval false The Email can't be indexed
+ *
+ * Everything that changes the searched text must change the key.
+ */
+static bool make_key(struct SearchIndex *si, struct Buffer *buf, struct Mailbox *m,
+                     const struct Email *e, int op)
+{
+  if (!m || !e || !e->env || !e->env->message_id || !e->content)
+    return false;
+
+  /* Don't keep a record of decrypted text */
+  if ((WithCrypto != 0) && (op != MUTT_PAT_HEADER) && (e->security & SEC_ENCRYPT))
+    return false;
+
+  char type;
+  switch (op)
+  {
+    case MUTT_PAT_BODY:
+      type = 'b';
+      break;
+    case MUTT_PAT_HEADER:
+      type = 'h';
+      break;
+    case MUTT_PAT_WHOLE_MSG:
+      type = 'B';
+      break;
+    default:
+      return false;
+  }
+
+  time_t mtime = 0;
+  if (!message_mtime(m, e, &mtime))
+    return false;
+
+  mutt_buffer_printf(buf, "/search%d/%s/%c%d/%s/%ld/%ld/%s", SEARCH_INDEX_VERSION,
+                     mailbox_path(m), type, C_ThoroughSearch, NONULL(C_Charset),
+                     (long) mtime, (long) e->date_sent, e->env->message_id);
+
+  if (C_ThoroughSearch && (op != MUTT_PAT_HEADER))
+    mutt_buffer_add_printf(buf, "/d%x", display_hash(si));
+
+  if (op != MUTT_PAT_BODY)
+  {
+    mutt_buffer_add_printf(buf, "/h%ld/%d%d%d%d/%x",
+                           (long) (e->content->offset - e->offset), e->read,
+                           e->old, e->flagged, e->replied, header_hash(e->env));
+  }
+  if (op != MUTT_PAT_HEADER)
+    mutt_buffer_add_printf(buf, "/b%ld", (long) e->content->length);
+
+  return true;
+}
+
+/**
+ * is_written - Does the mailbox hold the text that will be searched?
+ * @param e  Email
+ * @param op Type of search, e.g. #MUTT_PAT_BODY
+ * @retval true The message can be indexed
+ *
+ * Until the mailbox is synced, the header on disk doesn't match the flags and
+ * fields in the key.
+ */
+static bool is_written(const struct Email *e, int op)
+{
+  if (op == MUTT_PAT_BODY)
+    return true;
+  return e && !e->changed && (!e->env || !e->env->changed);
+}
+
+/**
+ * add_sig - Remember a signature
+ * @param si   Search Index
+ * @param key  Key of the signature
+ * @param bits Bloom filter
+ * @param size Size of the Bloom filter in bytes
+ * @retval ptr New signature
+ */
+static struct SearchSig *add_sig(struct SearchIndex *si, const char *key,
+                                 const unsigned char *bits, size_t size)
+{
+  struct SearchSig *sig = mutt_mem_calloc(1, sizeof(struct SearchSig));
+  sig->size = size;
+  sig->bits = mutt_mem_malloc(size);
+  memcpy(sig->bits, bits, size);
+  mutt_hash_insert(si->sigs, key, sig);
+  return sig;
+}
+
+/**
+ * find_sig - Find the signature of a message
+ * @param si  Search Index
+ * @param key Key of the signature
+ * @retval ptr  Signature
+ * @retval NULL The message hasn't been indexed
+ */
+static struct SearchSig *find_sig(struct SearchIndex *si, const char *key)
+{
+  struct SearchSig *sig = mutt_hash_find(si->sigs, key);
+  if (sig)
+    return sig;
+
+#ifdef USE_HCACHE
+  if (!si->hc)
+    return NULL;
+
+  size_t dlen = 0;
+  void *data = mutt_hcache_fetch_raw(si->hc, key, mutt_str_strlen(key), &dlen);
+  if (data && (dlen >= SIG_MIN_BYTES) && (dlen <= SCAN_BYTES) && ((dlen & (dlen - 1)) == 0))
+    sig = add_sig(si, key, data, dlen);
+  mutt_hcache_free_raw(si->hc, &data);
+#endif
+
+  return sig;
+}
+
+/**
+ * search_index_new - Create a Search Index
+ * @retval ptr New Search Index
+ */
+struct SearchIndex *search_index_new(void)
+{
+  struct SearchIndex *si = mutt_mem_calloc(1, sizeof(struct SearchIndex));
+  si->sigs = mutt_hash_new(1024, MUTT_HASH_STRDUP_KEYS);
+  mutt_hash_set_destructor(si->sigs, sig_free, 0);
+
+#ifdef USE_HCACHE
+  /* If $header_cache is a single file, it's in use by the mailboxes */
+  struct stat st;
+  if (C_HeaderCache && (stat(C_HeaderCache, &st) == 0) && S_ISDIR(st.st_mode))
+    si->hc = mutt_hcache_open(C_HeaderCache, "search-index", NULL);
+#endif
+
+  return si;
+}
+
+/**
+ * search_index_free - Free a Search Index
+ * @param[out] ptr Search Index to free
+ */
+void search_index_free(struct SearchIndex **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct SearchIndex *si = *ptr;
+  mutt_hash_free(&si->sigs);
+#ifdef USE_HCACHE
+  mutt_hcache_close(si->hc);
+#endif
+  FREE(ptr);
+}
+
+/**
+ * search_index_may_match - Might a message contain some text?
+ * @param si      Search Index
+ * @param m       Mailbox
+ * @param e       Email
+ * @param op      Type of search, e.g. #MUTT_PAT_BODY
+ * @param literal Text that every match must contain
+ * @param icase   The text is matched by a case-insensitive regex
+ * @retval true  The message might contain the text, search it
+ * @retval false The message can't contain the text
+ *
+ * Only the ASCII trigrams of the text are checked.
+ */
+bool search_index_may_match(struct SearchIndex *si, struct Mailbox *m, struct Email *e,
+                            int op, const char *literal, bool icase)
+{
+  if (!si || !literal || (mutt_str_strlen(literal) < 3) || !is_written(e, op))
+    return true;
+
+  struct Buffer *key = mutt_buffer_pool_get();
+  struct SearchSig *sig = make_key(si, key, m, e, op) ? find_sig(si, mutt_b2s(key)) : NULL;
+  mutt_buffer_pool_release(&key);
+  if (!sig)
+    return true;
+
+  const uint32_t mask = (sig->size * 8) - 1;
+  for (const unsigned char *p = (const unsigned char *) literal; p[0] && p[1] && p[2]; p++)
+  {
+    if ((p[0] | p[1] | p[2]) & 0x80)
+      continue;
+    if (icase && (has_wide_fold(p[0]) || has_wide_fold(p[1]) || has_wide_fold(p[2])))
+      continue;
+
+    const uint32_t bit = trigram_hash(p) & mask;
+    if ((sig->bits[bit / 8] & (1 << (bit % 8))) == 0)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * search_index_scan_begin - Start recording the text of a message
+ * @param si Search Index
+ * @param m  Mailbox
+ * @param e  Email
+ * @param op Type of search, e.g. #MUTT_PAT_BODY
+ * @retval ptr  Scan to pass to search_index_scan_text()
+ * @retval NULL The message is already indexed, or can't be
+ */
+struct SearchScan *search_index_scan_begin(struct SearchIndex *si, struct Mailbox *m,
+                                           struct Email *e, int op)
+{
+  if (!si || !is_written(e, op))
+    return NULL;
+
+  struct Buffer *key = mutt_buffer_pool_get();
+  struct SearchScan *ss = NULL;
+  if (make_key(si, key, m, e, op) && !find_sig(si, mutt_b2s(key)))
+  {
+    ss = mutt_mem_calloc(1, sizeof(struct SearchScan));
+    ss->key = mutt_buffer_strdup(key);
+  }
+  mutt_buffer_pool_release(&key);
+
+  return ss;
+}
+
+/**
+ * search_index_scan_text - Record some text of a message
+ * @param ss   Scan
+ * @param text Text, e.g. a line of the message
+ */
+void search_index_scan_text(struct SearchScan *ss, const char *text)
+{
+  if (!ss || !text)
+    return;
+
+  for (const unsigned char *p = (const unsigned char *) text; p[0] && p[1] && p[2]; p++)
+  {
+    const uint32_t bit = trigram_hash(p) & ((SCAN_BYTES * 8) - 1);
+    ss->bits[bit / 8] |= (1 << (bit % 8));
+  }
+}
+
+/**
+ * search_index_scan_end - Finish recording the text of a message
+ * @param si       Search Index
+ * @param[out] ptr Scan to free
+ * @param complete If true, all of the message's text was recorded
+ *
+ * A signature is only saved if the whole text was seen.
+ */
+void search_index_scan_end(struct SearchIndex *si, struct SearchScan **ptr, bool complete)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct SearchScan *ss = *ptr;
+  if (si && complete)
+  {
+    size_t count = 0;
+    for (size_t i = 0; i < SCAN_BYTES; i++)
+    {
+      for (unsigned char c = ss->bits[i]; c; c &= (c - 1))
+        count++;
+    }
+
+    /* Shrink the filter, while keeping it sparse, by folding it in half */
+    size_t size = SCAN_BYTES;
+    while ((size > SIG_MIN_BYTES) && ((size / 2) * 8 >= SIG_BITS_PER_TRIGRAM * count))
+    {
+      size /= 2;
+      for (size_t i = 0; i < size; i++)
+        ss->bits[i] |= ss->bits[i + size];
+    }
+
+    add_sig(si, ss->key, ss->bits, size);
+#ifdef USE_HCACHE
+    if (si->hc)
+      mutt_hcache_store_raw(si->hc, ss->key, mutt_str_strlen(ss->key), ss->bits, size);
+#endif
+  }
+
+  FREE(&ss->key);
+  FREE(ptr);
+}
+
+/**
+ * search_index_forget - Drop the signatures of a message
+ * @param si Search Index
+ * @param m  Mailbox
+ * @param e  Email
+ *
+ * This is used when a message is replaced by an edited copy, which may have
+ * the same key.
+ */
+void search_index_forget(struct SearchIndex *si, struct Mailbox *m, struct Email *e)
+{
+  if (!si)
+    return;
+
+  static const int ops[] = { MUTT_PAT_BODY, MUTT_PAT_HEADER, MUTT_PAT_WHOLE_MSG };
+  struct Buffer *key = mutt_buffer_pool_get();
+  for (size_t i = 0; i < mutt_array_size(ops); i++)
+  {
+    if (!make_key(si, key, m, e, ops[i]))
+      continue;
+    mutt_hash_delete(si->sigs, mutt_b2s(key), NULL);
+#ifdef USE_HCACHE
+    if (si->hc)
+      mutt_hcache_delete_header(si->hc, mutt_b2s(key), mutt_buffer_len(key));
+#endif
+  }
+  mutt_buffer_pool_release(&key);
+}
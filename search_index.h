@@ -0,0 +1,43 @@
+/**
+ * @file
+ * Trigram index of the text of searched messages
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_SEARCH_INDEX_H
+#define MUTT_SEARCH_INDEX_H
+
+#include <stdbool.h>
+
+struct Email;
+struct Mailbox;
+struct SearchIndex;
+struct SearchScan;
+
+/* These Config Variables are only used in search_index.c */
+extern bool C_SearchIndex;
+
+struct SearchIndex *search_index_new      (void);
+void                search_index_free     (struct SearchIndex **ptr);
+void                search_index_forget   (struct SearchIndex *si, struct Mailbox *m, struct Email *e);
+bool                search_index_may_match(struct SearchIndex *si, struct Mailbox *m, struct Email *e, int op, const char *literal, bool icase);
+
+struct SearchScan *search_index_scan_begin(struct SearchIndex *si, struct Mailbox *m, struct Email *e, int op);
+void               search_index_scan_text (struct SearchScan *ss, const char *text);
+void               search_index_scan_end  (struct SearchIndex *si, struct SearchScan **ptr, bool complete);
+
+#endif /* MUTT_SEARCH_INDEX_H */
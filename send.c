@@ -828,6 +828,7 @@ static int default_to(struct AddressList *to, struct Envelope *env, SendFlags fl
 int mutt_fetch_recips(struct Envelope *out, struct Envelope *in, SendFlags flags)
 {
   enum QuadOption hmfupto = MUTT_ABORT;
+  mutt_env_load(in);
   const struct Address *followup_to = TAILQ_FIRST(&in->mail_followup_to);
 
   if ((flags & (SEND_LIST_REPLY | SEND_GROUP_REPLY | SEND_GROUP_CHAT_REPLY)) && followup_to)
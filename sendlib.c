@@ -2333,6 +2333,8 @@ int mutt_rfc822_write_header(FILE *fp, struct Envelope *env,
 {
   char buf[1024];
 
+  mutt_env_load(env);
+
   if (((mode == MUTT_WRITE_HEADER_NORMAL) || (mode == MUTT_WRITE_HEADER_FCC)) && !privacy)
     fputs(mutt_date_make_date(buf, sizeof(buf)), fp);
 
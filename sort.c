@@ -28,6 +28,7 @@
  */
 
 #include "config.h"
+#include <ctype.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -171,6 +172,30 @@ const char *mutt_get_name(const struct Address *a)
   return "";
 }
 
+/**
+ * compare_names - Compare the names of two Addresses
+ * @param a First Address
+ * @param b Second Address
+ * @retval <0 a precedes b
+ * @retval  0 a and b have the same name
+ * @retval >0 b precedes a
+ */
+static int compare_names(const struct Address *a, const struct Address *b)
+{
+  /* The strings are pooled, so equal pointers mean equal strings.
+   * Without reverse aliases, the name depends only on the personal field. */
+  if (a && b && (a->personal == b->personal) &&
+      ((a->mailbox == b->mailbox) || (a->personal && !C_ReverseAlias)))
+  {
+    return 0;
+  }
+
+  char fa[128];
+  mutt_str_strfcpy(fa, mutt_get_name(a), sizeof(fa));
+  const char *fb = mutt_get_name(b);
+  return mutt_str_strncasecmp(fa, fb, sizeof(fa));
+}
+
 /**
  * compare_to - Compare the 'to' fields of two emails - Implements ::sort_t
  */
@@ -178,11 +203,8 @@ static int compare_to(const void *a, const void *b)
 {
   struct Email const *const *ppa = (struct Email const *const *) a;
   struct Email const *const *ppb = (struct Email const *const *) b;
-  char fa[128];
 
-  mutt_str_strfcpy(fa, mutt_get_name(TAILQ_FIRST(&(*ppa)->env->to)), sizeof(fa));
-  const char *fb = mutt_get_name(TAILQ_FIRST(&(*ppb)->env->to));
-  int result = mutt_str_strncasecmp(fa, fb, sizeof(fa));
+  int result = compare_names(TAILQ_FIRST(&(*ppa)->env->to), TAILQ_FIRST(&(*ppb)->env->to));
   result = perform_auxsort(result, a, b);
   return SORT_CODE(result);
 }
@@ -194,11 +216,9 @@ static int compare_from(const void *a, const void *b)
 {
   struct Email const *const *ppa = (struct Email const *const *) a;
   struct Email const *const *ppb = (struct Email const *const *) b;
-  char fa[128];
 
-  mutt_str_strfcpy(fa, mutt_get_name(TAILQ_FIRST(&(*ppa)->env->from)), sizeof(fa));
-  const char *fb = mutt_get_name(TAILQ_FIRST(&(*ppb)->env->from));
-  int result = mutt_str_strncasecmp(fa, fb, sizeof(fa));
+  int result = compare_names(TAILQ_FIRST(&(*ppa)->env->from),
+                             TAILQ_FIRST(&(*ppb)->env->from));
   result = perform_auxsort(result, a, b);
   return SORT_CODE(result);
 }
@@ -356,6 +376,276 @@ sort_t mutt_get_sort_func(enum SortType method)
   /* not reached */
 }
 
+/**
+ * struct EmailSortKey - An Email and its precomputed sort keys
+ */
+struct EmailSortKey
+{
+  struct Email *email;     ///< Email
+  struct SortField key;    ///< Key for the $sort method
+  struct SortField auxkey; ///< Key for the $sort_aux method
+};
+
+/**
+ * struct SortSpec - How to compare an array of EmailSortKey
+ */
+struct SortSpec
+{
+  enum SortType method;    ///< $sort method
+  enum SortType auxmethod; ///< $sort_aux method
+  int sign;                ///< -1 for a reverse $sort, otherwise 1
+  int auxsign;             ///< -1 for a reverse $sort_aux, otherwise 1
+};
+
+/* How compare_email_keys() sorts */
+static struct SortSpec KeySpec;
+
+/**
+ * mutt_sort_has_key - Can an Email's key for a sort method be precomputed?
+ * @param method Sort type, see #SortType
+ * @retval true The sort method only needs a string or a number
+ */
+bool mutt_sort_has_key(enum SortType method)
+{
+  switch (method)
+  {
+    case SORT_DATE:
+    case SORT_FROM:
+    case SORT_LABEL:
+    case SORT_RECEIVED:
+    case SORT_SCORE:
+    case SORT_SIZE:
+    case SORT_SPAM:
+    case SORT_SUBJECT:
+    case SORT_TO:
+      return true;
+    case SORT_ORDER:
+#ifdef USE_NNTP
+      /* nntp_compare_order() uses the article numbers */
+      return !Context || !Context->mailbox || (Context->mailbox->type != MUTT_NNTP);
+#else
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+/**
+ * fold_case - Copy a string in lower case
+ * @param a   Arena for the copy
+ * @param str String to copy
+ * @param len Number of bytes to copy
+ * @retval ptr Lower-case copy
+ */
+static const char *fold_case(struct Arena *a, const char *str, size_t len)
+{
+  char *key = mutt_arena_alloc(a, len + 1);
+  for (size_t i = 0; i < len; i++)
+    key[i] = tolower((unsigned char) str[i]);
+  key[len] = '\0';
+  return key;
+}
+
+/**
+ * mutt_sort_field_set - Precompute an Email's sort key
+ * @param[out] field  Sort key, zeroed by the caller
+ * @param[in]  e      Email
+ * @param[in]  method Sort type, see mutt_sort_has_key()
+ * @param[in]  a      Arena for the strings
+ */
+void mutt_sort_field_set(struct SortField *field, struct Email *e,
+                         enum SortType method, struct Arena *a)
+{
+  const char *str = NULL;
+  char *end = NULL;
+
+  switch (method)
+  {
+    case SORT_DATE:
+      field->num = e->date_sent;
+      break;
+    case SORT_FROM:
+    case SORT_TO:
+      str = mutt_get_name(TAILQ_FIRST((method == SORT_FROM) ? &e->env->from : &e->env->to));
+      /* compare_names() only compares the first 127 characters */
+      field->str = fold_case(a, str, strnlen(str, 127));
+      break;
+    case SORT_LABEL:
+      /* Blank labels are treated as no label */
+      str = e->env->x_label;
+      if (str && (*str != '\0'))
+        field->str = fold_case(a, str, strlen(str));
+      break;
+    case SORT_RECEIVED:
+      field->num = e->received;
+      break;
+    case SORT_SCORE:
+      field->num = -e->score; /* highest score first */
+      break;
+    case SORT_SIZE:
+      field->num = e->content->length;
+      break;
+    case SORT_SPAM:
+      if (mutt_buffer_is_empty(&e->env->spam))
+        break;
+      field->value = strtod(e->env->spam.data, &end);
+      field->has_value = (end != e->env->spam.data);
+      field->str = end; /* the rest is compared case-sensitively */
+      break;
+    case SORT_SUBJECT:
+      field->num = e->date_sent;
+      str = e->env->real_subj;
+      if (str)
+        field->str = fold_case(a, str, strlen(str));
+      break;
+    default:
+      field->num = e->index;
+      break;
+  }
+}
+
+/**
+ * mutt_sort_field_cmp - Compare two precomputed sort keys
+ * @param[in]  method Sort type, see mutt_sort_has_key()
+ * @param[in]  a      First key
+ * @param[in]  b      Second key
+ * @param[out] aux    Set to false if a tie isn't broken by the $sort_aux
+ * @retval <0 a precedes b
+ * @retval  0 a and b are identical
+ * @retval >0 b precedes a
+ *
+ * The results match the ::sort_t functions, including the int truncation of
+ * the numeric differences.
+ */
+int mutt_sort_field_cmp(enum SortType method, const struct SortField *a,
+                        const struct SortField *b, bool *aux)
+{
+  switch (method)
+  {
+    case SORT_FROM:
+    case SORT_TO:
+      return strcmp(a->str, b->str);
+
+    case SORT_LABEL:
+      /* Emails with a label come first */
+      if (!a->str || !b->str)
+        return (!a->str - !b->str);
+      /* compare_label() doesn't use the $sort_aux for equal labels */
+      *aux = false;
+      return strcmp(a->str, b->str);
+
+    case SORT_SPAM:
+    {
+      /* Emails with a spam attribute come last */
+      if (!a->str || !b->str)
+        return (!b->str - !a->str);
+      /* compare_spam() doesn't use the $sort_aux for non-numeric values */
+      if (!a->has_value || !b->has_value)
+      {
+        *aux = false;
+        return strcmp(a->str, b->str);
+      }
+      const double difference = a->value - b->value;
+      if (difference < 0.0)
+        return -1;
+      if (difference > 0.0)
+        return 1;
+      return strcmp(a->str, b->str);
+    }
+
+    case SORT_SUBJECT:
+      /* Emails without a subject come first, by date */
+      if (a->str && b->str)
+        return strcmp(a->str, b->str);
+      if (a->str || b->str)
+        return (!b->str - !a->str);
+      break;
+
+    default:
+      break;
+  }
+
+  return (int) (a->num - b->num);
+}
+
+/**
+ * compare_email_keys - Compare two emails by their precomputed keys - Implements ::sort_t
+ *
+ * The emails are compared by the $sort key, then the $sort_aux key, then their
+ * index, the way perform_auxsort() chains the ::sort_t functions.  No two
+ * emails are equal, so the order doesn't depend on qsort().
+ */
+static int compare_email_keys(const void *a, const void *b)
+{
+  const struct EmailSortKey *ka = a;
+  const struct EmailSortKey *kb = b;
+  const int index = ka->email->index - kb->email->index;
+
+  bool aux = true;
+  int rc = mutt_sort_field_cmp(KeySpec.method, &ka->key, &kb->key, &aux);
+  if (rc == 0)
+  {
+    /* A tie the $sort function leaves to qsort() keeps the mailbox order */
+    if (!aux)
+      return index;
+
+    /* The $sort_aux function breaks its own ties by the index, but a tie it
+     * returns as 0 falls back to the index without its reverse flag */
+    bool auxindex = true;
+    rc = mutt_sort_field_cmp(KeySpec.auxmethod, &ka->auxkey, &kb->auxkey, &auxindex);
+    if ((rc == 0) && auxindex)
+      rc = index;
+    rc *= KeySpec.auxsign;
+    if (rc == 0)
+      rc = index;
+  }
+  return KeySpec.sign * rc;
+}
+
+/**
+ * sort_by_keys - Sort emails by precomputed keys
+ * @param m Mailbox
+ * @retval true  The emails have been sorted
+ * @retval false The sort methods need the ::sort_t functions
+ *
+ * Each Email's $sort and $sort_aux keys are looked up once, then the emails
+ * are sorted in a single pass over them.
+ */
+static bool sort_by_keys(struct Mailbox *m)
+{
+  KeySpec.method = C_Sort & SORT_MASK;
+  KeySpec.auxmethod = C_SortAux & SORT_MASK;
+  KeySpec.sign = (C_Sort & SORT_REVERSE) ? -1 : 1;
+  KeySpec.auxsign = (C_SortAux & SORT_REVERSE) ? -1 : 1;
+
+  if (!mutt_sort_has_key(KeySpec.method) || !mutt_sort_has_key(KeySpec.auxmethod))
+    return false;
+
+  struct EmailSortKey *keys = mutt_mem_calloc(m->msg_count, sizeof(struct EmailSortKey));
+  struct Arena *arena = mutt_arena_new();
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    keys[i].email = e;
+    mutt_sort_field_set(&keys[i].key, e, KeySpec.method, arena);
+    if (KeySpec.auxmethod == KeySpec.method)
+      keys[i].auxkey = keys[i].key;
+    else
+      mutt_sort_field_set(&keys[i].auxkey, e, KeySpec.auxmethod, arena);
+  }
+
+  qsort(keys, m->msg_count, sizeof(struct EmailSortKey), compare_email_keys);
+
+  for (int i = 0; i < m->msg_count; i++)
+    m->emails[i] = keys[i].email;
+
+  mutt_arena_free(&arena);
+  FREE(&keys);
+  return true;
+}
+
 /**
  * mutt_sort_headers - Sort emails by their headers
  * @param ctx  Mailbox
@@ -431,7 +721,8 @@ void mutt_sort_headers(struct Context *ctx, bool init)
   }
   else
   {
-    qsort((void *) m->emails, m->msg_count, sizeof(struct Email *), sortfunc);
+    if (!sort_by_keys(m))
+      qsort((void *) m->emails, m->msg_count, sizeof(struct Email *), sortfunc);
   }
 
   /* adjust the virtual message numbers */
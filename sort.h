@@ -30,7 +30,9 @@
 #include "where.h"
 
 struct Address;
+struct Arena;
 struct Context;
+struct Email;
 
 /* These Config Variables are only used in sort.c */
 extern bool C_ReverseAlias;
@@ -47,8 +49,23 @@ extern bool C_ReverseAlias;
  */
 typedef int (*sort_t)(const void *a, const void *b);
 
+/**
+ * struct SortField - A precomputed sort key
+ */
+struct SortField
+{
+  const char *str; ///< Lower-case string, NULL if the Email doesn't have one
+  long long num;   ///< Number, or the date for a subject
+  double value;    ///< Numeric part of a spam attribute
+  bool has_value;  ///< The spam attribute starts with a number
+};
+
 sort_t mutt_get_sort_func(enum SortType method);
 
+int  mutt_sort_field_cmp(enum SortType method, const struct SortField *a, const struct SortField *b, bool *aux);
+void mutt_sort_field_set(struct SortField *field, struct Email *e, enum SortType method, struct Arena *a);
+bool mutt_sort_has_key(enum SortType method);
+
 void mutt_sort_headers(struct Context *ctx, bool init);
 int perform_auxsort(int retval, const void *a, const void *b);
 
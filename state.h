@@ -23,11 +23,12 @@
 #ifndef MUTT_STATE_H
 #define MUTT_STATE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <wchar.h>
 
-typedef uint8_t StateFlags;          ///< Flags for State->flags, e.g. #MUTT_DISPLAY
+typedef uint16_t StateFlags;          ///< Flags for State->flags, e.g. #MUTT_DISPLAY
 #define MUTT_STATE_NO_FLAGS       0  ///< No flags are set
 #define MUTT_DISPLAY        (1 << 0) ///< Output is displayed to the user
 #define MUTT_VERIFY         (1 << 1) ///< Perform signature verification
@@ -37,6 +38,7 @@ typedef uint8_t StateFlags;          ///< Flags for State->flags, e.g. #MUTT_DIS
 #define MUTT_PRINTING       (1 << 5) ///< Are we printing? - MUTT_DISPLAY "light"
 #define MUTT_REPLYING       (1 << 6) ///< Are we replying?
 #define MUTT_FIRSTDONE      (1 << 7) ///< The first attachment has been done
+#define MUTT_SEARCHING      (1 << 8) ///< Output is only being searched
 
 /**
  * struct State - Keep track when processing files
@@ -48,6 +50,7 @@ struct State
   char      *prefix;  ///< String to add to the beginning of each output line
   StateFlags flags;   ///< Flags, e.g. #MUTT_DISPLAY
   int        wraplen; ///< Width to wrap lines to (when flags & #MUTT_DISPLAY)
+  bool       stop;    ///< Stop decoding, the rest of the output isn't needed
 };
 
 #define state_set_prefix(state) ((state)->flags |= MUTT_PENDINGPREFIX)
@@ -220,6 +220,33 @@ static int store_bdb_delete_record(void *store, const char *key, size_t klen)
   return ctx->db->del(ctx->db, NULL, &dkey, 0);
 }
 
+/**
+ * store_bdb_begin - Implements StoreOps::begin()
+ *
+ * The environment isn't transactional.  Writes are already buffered in the
+ * memory pool until the database is synchronised or closed.
+ */
+static int store_bdb_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  return 0;
+}
+
+/**
+ * store_bdb_commit - Implements StoreOps::commit()
+ *
+ * Nothing to do, the writes reach the disk when the database is closed.
+ */
+static int store_bdb_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  return 0;
+}
+
 /**
  * store_bdb_close - Implements StoreOps::close()
  */
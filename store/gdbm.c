@@ -121,6 +121,33 @@ static int store_gdbm_delete_record(void *store, const char *key, size_t klen)
   return gdbm_delete(db, dkey);
 }
 
+/**
+ * store_gdbm_begin - Implements StoreOps::begin()
+ *
+ * GDBM doesn't have transactions.  Writes are already buffered in memory
+ * until the database is synchronised or closed.
+ */
+static int store_gdbm_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  return 0;
+}
+
+/**
+ * store_gdbm_commit - Implements StoreOps::commit()
+ *
+ * Nothing to do, the writes reach the disk when the database is closed.
+ */
+static int store_gdbm_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  return 0;
+}
+
 /**
  * store_gdbm_close - Implements StoreOps::close()
  */
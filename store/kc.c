@@ -119,6 +119,42 @@ static int store_kyotocabinet_delete_record(void *store, const char *key, size_t
   return 0;
 }
 
+/**
+ * store_kyotocabinet_begin - Implements StoreOps::begin()
+ */
+static int store_kyotocabinet_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  KCDB *db = store;
+  /* A soft transaction doesn't synchronise with the device on commit */
+  if (!kcdbbegintran(db, 0))
+  {
+    int ecode = kcdbecode(db);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
+/**
+ * store_kyotocabinet_commit - Implements StoreOps::commit()
+ */
+static int store_kyotocabinet_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  KCDB *db = store;
+  if (!kcdbendtran(db, 1))
+  {
+    int ecode = kcdbecode(db);
+    mutt_debug(LL_DEBUG2, "kcdbendtran failed: %s (ecode %d)\n", kcdbemsg(db), ecode);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
 /**
  * store_kyotocabinet_close - Implements StoreOps::close()
  */
@@ -114,6 +114,28 @@ struct StoreOps
    */
   int (*delete_record)(void *store, const char *key, size_t klen);
 
+  /**
+   * begin - Start a batch of writes
+   * @param[in] store Store retrieved via open()
+   * @retval 0   Success
+   * @retval num Error, a backend-specific error code
+   *
+   * The store() and delete_record() calls that follow, until commit(), may be
+   * grouped into a single transaction.  Backends without transactions may
+   * treat this as a no-op.  fetch() must still see the pending writes.
+   */
+  int (*begin)(void *store);
+
+  /**
+   * commit - Finish a batch of writes
+   * @param[in] store Store retrieved via open()
+   * @retval 0   Success
+   * @retval num Error, a backend-specific error code
+   *
+   * commit() will only be called after a successful begin().
+   */
+  int (*commit)(void *store);
+
   /**
    * close - Close a Store connection
    * @param[in,out] ptr Store retrieved via open()
@@ -139,6 +161,8 @@ bool                   store_is_valid_backend(const char *str);
     .free           = store_##_name##_free,                                    \
     .store          = store_##_name##_store,                                   \
     .delete_record  = store_##_name##_delete_record,                           \
+    .begin          = store_##_name##_begin,                                   \
+    .commit         = store_##_name##_commit,                                  \
     .close          = store_##_name##_close,                                   \
     .version        = store_##_name##_version,                                 \
   };
@@ -100,6 +100,32 @@ static int store_qdbm_delete_record(void *store, const char *key, size_t klen)
   return success ? 0 : dpecode ? dpecode : -1;
 }
 
+/**
+ * store_qdbm_begin - Implements StoreOps::begin()
+ */
+static int store_qdbm_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  VILLA *db = store;
+  bool success = vltranbegin(db);
+  return success ? 0 : dpecode ? dpecode : -1;
+}
+
+/**
+ * store_qdbm_commit - Implements StoreOps::commit()
+ */
+static int store_qdbm_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  VILLA *db = store;
+  bool success = vltrancommit(db);
+  return success ? 0 : dpecode ? dpecode : -1;
+}
+
 /**
  * store_qdbm_close - Implements StoreOps::close()
  */
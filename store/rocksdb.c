@@ -45,6 +45,7 @@ struct RocksDB_Ctx
   rocksdb_options_t *options;
   rocksdb_readoptions_t *read_options;
   rocksdb_writeoptions_t *write_options;
+  rocksdb_writebatch_wi_t *batch; ///< Pending writes between begin() and commit()
   char *err;
 };
 
@@ -57,6 +58,7 @@ static void *store_rocksdb_open(const char *path)
 
   /* RocksDB store errors in form of strings */
   ctx->err = NULL;
+  ctx->batch = NULL;
 
   /* setup generic options, create new db and limit log to one file */
   ctx->options = rocksdb_options_create();
@@ -96,7 +98,17 @@ static void *store_rocksdb_fetch(void *store, const char *key, size_t keylen, si
 
   struct RocksDB_Ctx *ctx = store;
 
-  void *rv = rocksdb_get(ctx->db, ctx->read_options, key, keylen, dlen, &ctx->err);
+  void *rv = NULL;
+  if (ctx->batch)
+  {
+    /* Include any writes that haven't been committed yet */
+    rv = rocksdb_writebatch_wi_get_from_batch_and_db(ctx->batch, ctx->db, ctx->read_options,
+                                                     key, keylen, dlen, &ctx->err);
+  }
+  else
+  {
+    rv = rocksdb_get(ctx->db, ctx->read_options, key, keylen, dlen, &ctx->err);
+  }
   if (ctx->err)
   {
     rocksdb_free(ctx->err);
@@ -126,6 +138,12 @@ static int store_rocksdb_store(void *store, const char *key, size_t keylen,
 
   struct RocksDB_Ctx *ctx = store;
 
+  if (ctx->batch)
+  {
+    rocksdb_writebatch_wi_put(ctx->batch, key, keylen, data, dlen);
+    return 0;
+  }
+
   rocksdb_put(ctx->db, ctx->write_options, key, keylen, data, dlen, &ctx->err);
   if (ctx->err)
   {
@@ -147,6 +165,12 @@ static int store_rocksdb_delete_record(void *store, const char *key, size_t keyl
 
   struct RocksDB_Ctx *ctx = store;
 
+  if (ctx->batch)
+  {
+    rocksdb_writebatch_wi_delete(ctx->batch, key, keylen);
+    return 0;
+  }
+
   rocksdb_delete(ctx->db, ctx->write_options, key, keylen, &ctx->err);
   if (ctx->err)
   {
@@ -158,6 +182,50 @@ static int store_rocksdb_delete_record(void *store, const char *key, size_t keyl
   return 0;
 }
 
+/**
+ * store_rocksdb_begin - Implements StoreOps::begin()
+ */
+static int store_rocksdb_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct RocksDB_Ctx *ctx = store;
+
+  if (!ctx->batch)
+    ctx->batch = rocksdb_writebatch_wi_create(0, 1);
+
+  return 0;
+}
+
+/**
+ * store_rocksdb_commit - Implements StoreOps::commit()
+ */
+static int store_rocksdb_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct RocksDB_Ctx *ctx = store;
+
+  if (!ctx->batch)
+    return 0;
+
+  rocksdb_write_writebatch_wi(ctx->db, ctx->write_options, ctx->batch, &ctx->err);
+  rocksdb_writebatch_wi_destroy(ctx->batch);
+  ctx->batch = NULL;
+
+  if (ctx->err)
+  {
+    mutt_debug(LL_DEBUG2, "rocksdb_write_writebatch_wi: %s\n", ctx->err);
+    rocksdb_free(ctx->err);
+    ctx->err = NULL;
+    return -1;
+  }
+
+  return 0;
+}
+
 /**
  * store_rocksdb_close - Implements StoreOps::close()
  */
@@ -168,6 +236,9 @@ static void store_rocksdb_close(void **ptr)
 
   struct RocksDB_Ctx *ctx = *ptr;
 
+  /* flush any pending writes */
+  store_rocksdb_commit(ctx);
+
   /* close database and free resources */
   rocksdb_close(ctx->db);
   rocksdb_options_destroy(ctx->options);
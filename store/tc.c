@@ -114,6 +114,42 @@ static int store_tokyocabinet_delete_record(void *store, const char *key, size_t
   return 0;
 }
 
+/**
+ * store_tokyocabinet_begin - Implements StoreOps::begin()
+ */
+static int store_tokyocabinet_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  TCBDB *db = store;
+  if (!tcbdbtranbegin(db))
+  {
+    int ecode = tcbdbecode(db);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
+/**
+ * store_tokyocabinet_commit - Implements StoreOps::commit()
+ */
+static int store_tokyocabinet_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  TCBDB *db = store;
+  if (!tcbdbtrancommit(db))
+  {
+    int ecode = tcbdbecode(db);
+    mutt_debug(LL_DEBUG2, "tcbdbtrancommit failed: %s (ecode %d)\n",
+               tcbdberrmsg(ecode), ecode);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
 /**
  * store_tokyocabinet_close - Implements StoreOps::close()
  */
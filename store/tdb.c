@@ -114,6 +114,30 @@ static int store_tdb_delete_record(void *store, const char *key, size_t klen)
   return tdb_delete(db, dkey);
 }
 
+/**
+ * store_tdb_begin - Implements StoreOps::begin()
+ */
+static int store_tdb_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  TDB_CONTEXT *db = store;
+  return tdb_transaction_start(db);
+}
+
+/**
+ * store_tdb_commit - Implements StoreOps::commit()
+ */
+static int store_tdb_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  TDB_CONTEXT *db = store;
+  return tdb_transaction_commit(db);
+}
+
 /**
  * store_tdb_close - Implements StoreOps::close()
  */
@@ -0,0 +1,68 @@
+/**
+ * @file
+ * Test code for mutt_arena_calloc()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <string.h>
+#include "mutt/lib.h"
+
+void test_mutt_arena_calloc(void)
+{
+  // void *mutt_arena_calloc(size_t size);
+
+  {
+    // No current Arena, so the memory comes from the heap
+    char *p = mutt_arena_calloc(32);
+    TEST_CHECK(p != NULL);
+    TEST_CHECK(mutt_arena_owns(p) == 0);
+    FREE(&p);
+  }
+
+  {
+    struct Arena *a = mutt_arena_new();
+    struct Arena *old = mutt_arena_swap(a);
+
+    TEST_CHECK(mutt_arena_calloc(0) == NULL);
+
+    char *p = mutt_arena_calloc(13);
+    char *q = mutt_arena_calloc(40);
+    TEST_CHECK(p != NULL);
+    TEST_CHECK(q != NULL);
+    TEST_CHECK((q - p) >= 13);
+    TEST_CHECK(((uintptr_t) q % sizeof(void *)) == 0);
+    TEST_CHECK(memcmp(q, "\0\0\0\0\0\0\0\0", 8) == 0);
+    TEST_CHECK(a->num_allocs == 2);
+
+    // Freeing arena memory is harmless
+    FREE(&p);
+    TEST_CHECK(p == NULL);
+
+    // Large allocations get a block of their own
+    char *big = mutt_arena_calloc(1024 * 1024);
+    TEST_CHECK(big != NULL);
+    TEST_CHECK(mutt_arena_owns(big) == (1024 * 1024));
+    char *r = mutt_arena_calloc(8);
+    TEST_CHECK(r == (q + 40));
+
+    mutt_arena_swap(old);
+    mutt_arena_free(&a);
+  }
+}
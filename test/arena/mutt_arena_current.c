@@ -0,0 +1,42 @@
+/**
+ * @file
+ * Test code for mutt_arena_current()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_arena_current(void)
+{
+  // struct Arena *mutt_arena_current(void);
+
+  {
+    TEST_CHECK(mutt_arena_current() == NULL);
+  }
+
+  {
+    struct Arena *a = mutt_arena_new();
+    struct Arena *old = mutt_arena_swap(a);
+    TEST_CHECK(mutt_arena_current() == a);
+    mutt_arena_swap(old);
+    TEST_CHECK(mutt_arena_current() == NULL);
+    mutt_arena_free(&a);
+  }
+}
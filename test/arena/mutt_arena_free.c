@@ -0,0 +1,53 @@
+/**
+ * @file
+ * Test code for mutt_arena_free()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_arena_free(void)
+{
+  // void mutt_arena_free(struct Arena **ptr);
+
+  {
+    mutt_arena_free(NULL);
+    TEST_CHECK_(1, "mutt_arena_free(NULL)");
+  }
+
+  {
+    struct Arena *a = NULL;
+    mutt_arena_free(&a);
+    TEST_CHECK_(1, "mutt_arena_free(&a)");
+  }
+
+  {
+    struct Arena *a = mutt_arena_new();
+    struct Arena *old = mutt_arena_swap(a);
+    void *p = mutt_arena_calloc(100);
+    TEST_CHECK(mutt_arena_owns(p) != 0);
+
+    mutt_arena_free(&a);
+    TEST_CHECK(a == NULL);
+    TEST_CHECK(mutt_arena_current() == NULL);
+    TEST_CHECK(mutt_arena_owns(p) == 0);
+    mutt_arena_swap(old);
+  }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file
+ * Test code for mutt_arena_intern()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_arena_intern(void)
+{
+  // char *mutt_arena_intern(const char *str, size_t len);
+
+  {
+    TEST_CHECK(mutt_arena_intern(NULL, 0) == NULL);
+  }
+
+  {
+    char *s = mutt_arena_intern("apple", 5);
+    char *t = mutt_arena_intern("apple", 5);
+    TEST_CHECK(mutt_str_strcmp(s, "apple") == 0);
+    TEST_CHECK(s != t);
+    FREE(&s);
+    FREE(&t);
+  }
+
+  {
+    struct Arena *a = mutt_arena_new();
+    struct Arena *old = mutt_arena_swap(a);
+
+    char *s = mutt_arena_intern("apple banana", 5);
+    size_t used = a->used;
+    char *t = mutt_arena_intern("apple", 5);
+    char *u = mutt_arena_intern("banana", 6);
+    TEST_CHECK(mutt_str_strcmp(s, "apple") == 0);
+    TEST_CHECK(mutt_str_strcmp(u, "banana") == 0);
+    TEST_CHECK(s == t);
+    TEST_CHECK(s != u);
+    TEST_CHECK(a->used > used);
+    TEST_CHECK(a->shared == 6);
+
+    mutt_arena_swap(old);
+    mutt_arena_free(&a);
+  }
+}
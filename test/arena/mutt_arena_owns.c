@@ -0,0 +1,65 @@
+/**
+ * @file
+ * Test code for mutt_arena_owns()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <string.h>
+#include "mutt/lib.h"
+
+void test_mutt_arena_owns(void)
+{
+  // size_t mutt_arena_owns(const void *ptr);
+
+  {
+    TEST_CHECK(mutt_arena_owns(NULL) == 0);
+  }
+
+  {
+    struct Arena *a = mutt_arena_new();
+    struct Arena *b = mutt_arena_new();
+    struct Arena *old = mutt_arena_swap(a);
+
+    char *p = mutt_arena_calloc(16);
+    mutt_arena_swap(b);
+    char *q = mutt_arena_calloc(16);
+    mutt_arena_swap(NULL);
+    char *h = mutt_arena_calloc(16);
+
+    TEST_CHECK(mutt_arena_owns(p) != 0);
+    TEST_CHECK(mutt_arena_owns(q) != 0);
+    TEST_CHECK(mutt_arena_owns(p + 8) == (mutt_arena_owns(p) - 8));
+    TEST_CHECK(mutt_arena_owns(h) == 0);
+
+    // Reallocating arena memory copies it to the heap
+    strcpy(p, "apple");
+    mutt_mem_realloc(&p, 1024);
+    TEST_CHECK(mutt_arena_owns(p) == 0);
+    TEST_CHECK(strcmp(p, "apple") == 0);
+    FREE(&p);
+    FREE(&h);
+
+    mutt_arena_free(&a);
+    TEST_CHECK(mutt_arena_owns(q) != 0);
+    mutt_arena_free(&b);
+    TEST_CHECK(mutt_arena_owns(q) == 0);
+    mutt_arena_swap(old);
+  }
+}
@@ -0,0 +1,59 @@
+/**
+ * @file
+ * Test code for mutt_arena_strndup()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_arena_strndup(void)
+{
+  // char *mutt_arena_strndup(const char *str, size_t len);
+
+  {
+    TEST_CHECK(mutt_arena_strndup(NULL, 0) == NULL);
+  }
+
+  {
+    char *s = mutt_arena_strndup("apple banana", 5);
+    TEST_CHECK(mutt_str_strcmp(s, "apple") == 0);
+    TEST_CHECK(mutt_arena_owns(s) == 0);
+    FREE(&s);
+  }
+
+  {
+    struct Arena *a = mutt_arena_new();
+    struct Arena *old = mutt_arena_swap(a);
+
+    char *s = mutt_arena_strndup("apple banana", 5);
+    char *t = mutt_arena_strndup("apple banana", 5);
+    TEST_CHECK(mutt_str_strcmp(s, "apple") == 0);
+    TEST_CHECK(mutt_arena_owns(s) != 0);
+    TEST_CHECK(s != t);
+
+    // Replacing an arena string moves it to the heap
+    mutt_str_replace(&s, "cherry");
+    TEST_CHECK(mutt_str_strcmp(s, "cherry") == 0);
+    FREE(&s);
+
+    mutt_arena_swap(old);
+    mutt_arena_free(&a);
+  }
+}
@@ -0,0 +1,56 @@
+/**
+ * @file
+ * Benchmark hub
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <locale.h>
+#define TEST_INIT setlocale(LC_ALL, "C.UTF-8")
+#include "acutest.h"
+
+/******************************************************************************
+ * Add your benchmarks to this list.
+ *
+ * The benchmarks aren't part of `make test`.  Build them with `make bench`
+ * and see the timings with `test/neomutt-bench -v`.
+ *****************************************************************************/
+#define NEOMUTT_BENCH_LIST                                                     \
+  /* hash */                                                                   \
+  NEOMUTT_TEST_ITEM(bench_mutt_hash)                                           \
+                                                                               \
+  /* pattern */                                                                \
+  NEOMUTT_TEST_ITEM(bench_mutt_pattern)                                        \
+                                                                               \
+  /* thread */                                                                 \
+  NEOMUTT_TEST_ITEM(bench_mutt_sort_threads)
+
+/******************************************************************************
+ * You probably don't need to touch what follows.
+ *****************************************************************************/
+// clang-format off
+#define NEOMUTT_TEST_ITEM(x) void x(void);
+NEOMUTT_BENCH_LIST
+#undef NEOMUTT_TEST_ITEM
+
+TEST_LIST = {
+#define NEOMUTT_TEST_ITEM(x) { #x, x },
+  NEOMUTT_BENCH_LIST
+#undef NEOMUTT_TEST_ITEM
+  { 0 }
+};
+// clang-format on
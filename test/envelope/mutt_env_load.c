@@ -0,0 +1,76 @@
+/**
+ * @file
+ * Test code for mutt_env_load()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "email/lib.h"
+
+static int lazy_calls = 0;
+
+static void lazy_load_sender(struct Envelope *env)
+{
+  lazy_calls++;
+  mutt_addrlist_append(&env->sender, mutt_addr_create(NULL, env->lazy_data));
+}
+
+void test_mutt_env_load(void)
+{
+  // void mutt_env_load(struct Envelope *env);
+
+  {
+    mutt_env_load(NULL);
+    TEST_CHECK_(1, "mutt_env_load(NULL)");
+  }
+
+  {
+    struct Envelope *env = mutt_env_new();
+    mutt_env_load(env);
+    TEST_CHECK(TAILQ_EMPTY(&env->sender));
+    mutt_env_free(&env);
+  }
+
+  {
+    struct Envelope *env = mutt_env_new();
+    env->lazy_data = mutt_str_strdup("sender@example.com");
+    env->lazy_load = lazy_load_sender;
+
+    lazy_calls = 0;
+    mutt_env_load(env);
+    TEST_CHECK(lazy_calls == 1);
+    TEST_CHECK(env->lazy_data == NULL);
+    TEST_CHECK(!TAILQ_EMPTY(&env->sender));
+
+    mutt_env_load(env);
+    TEST_CHECK(lazy_calls == 1);
+    mutt_env_free(&env);
+  }
+
+  {
+    /* Unloaded data is freed with the Envelope */
+    struct Envelope *env = mutt_env_new();
+    env->lazy_data = mutt_str_strdup("sender@example.com");
+    env->lazy_load = lazy_load_sender;
+    mutt_env_free(&env);
+    TEST_CHECK(env == NULL);
+  }
+}
@@ -0,0 +1,293 @@
+/**
+ * @file
+ * Benchmark for the Hash table
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdint.h>
+#include <stdio.h>
+#include "mutt/lib.h"
+
+#define BENCH_KEYS 100000
+
+/**
+ * struct ChainElem - An element of a ChainHash
+ */
+struct ChainElem
+{
+  char *key;              ///< Copy of the key
+  void *data;             ///< User data
+  struct ChainElem *next; ///< Next element in the bucket
+};
+
+/**
+ * struct ChainHash - The chained Hash table that mutt_hash_new() used to create
+ *
+ * The buckets are fixed at creation and each chain is kept sorted, as the
+ * old union_hash_insert() did for a table without duplicates.
+ */
+struct ChainHash
+{
+  size_t nelem;             ///< Number of buckets
+  struct ChainElem **table; ///< Buckets
+};
+
+/**
+ * chain_gen_hash - Generate a hash from a string, like the old gen_string_hash()
+ * @param key String key
+ * @param n   Number of buckets
+ * @retval num Bucket for the key
+ */
+static size_t chain_gen_hash(const char *key, size_t n)
+{
+  size_t h = 0;
+  const unsigned char *s = (const unsigned char *) key;
+
+  while (*s)
+    h += ((h << 7) + *s++);
+  h = (h * 149711) % n;
+
+  return h;
+}
+
+/**
+ * chain_new - Create a ChainHash
+ * @param nelem Number of buckets
+ * @retval ptr New ChainHash
+ */
+static struct ChainHash *chain_new(size_t nelem)
+{
+  struct ChainHash *table = mutt_mem_calloc(1, sizeof(struct ChainHash));
+  table->nelem = nelem;
+  table->table = mutt_mem_calloc(nelem, sizeof(struct ChainElem *));
+  return table;
+}
+
+/**
+ * chain_insert - Add a key to a ChainHash
+ * @param table Hash table
+ * @param key   Key, which will be copied
+ * @param data  User data
+ * @retval true The key was added
+ */
+static bool chain_insert(struct ChainHash *table, const char *key, void *data)
+{
+  size_t h = chain_gen_hash(key, table->nelem);
+  struct ChainElem *tmp = NULL, *last = NULL;
+
+  for (tmp = table->table[h]; tmp; last = tmp, tmp = tmp->next)
+  {
+    const int r = mutt_str_strcmp(tmp->key, key);
+    if (r == 0)
+      return false;
+    if (r > 0)
+      break;
+  }
+
+  struct ChainElem *ce = mutt_mem_malloc(sizeof(struct ChainElem));
+  ce->key = mutt_str_strdup(key);
+  ce->data = data;
+  ce->next = tmp;
+  if (last)
+    last->next = ce;
+  else
+    table->table[h] = ce;
+  return true;
+}
+
+/**
+ * chain_find - Find a key in a ChainHash
+ * @param table Hash table
+ * @param key   Key
+ * @retval ptr User data
+ */
+static void *chain_find(const struct ChainHash *table, const char *key)
+{
+  struct ChainElem *ce = table->table[chain_gen_hash(key, table->nelem)];
+  for (; ce; ce = ce->next)
+  {
+    if (mutt_str_strcmp(key, ce->key) == 0)
+      return ce->data;
+  }
+  return NULL;
+}
+
+/**
+ * chain_delete - Remove a key from a ChainHash
+ * @param table Hash table
+ * @param key   Key
+ */
+static void chain_delete(struct ChainHash *table, const char *key)
+{
+  struct ChainElem **last = &table->table[chain_gen_hash(key, table->nelem)];
+  for (struct ChainElem *ce = *last; ce; last = &ce->next, ce = ce->next)
+  {
+    if (mutt_str_strcmp(ce->key, key) == 0)
+    {
+      *last = ce->next;
+      FREE(&ce->key);
+      FREE(&ce);
+      return;
+    }
+  }
+}
+
+/**
+ * chain_free - Free a ChainHash
+ * @param ptr Hash table to free
+ */
+static void chain_free(struct ChainHash **ptr)
+{
+  struct ChainHash *table = *ptr;
+  for (size_t i = 0; i < table->nelem; i++)
+  {
+    struct ChainElem *ce = table->table[i];
+    while (ce)
+    {
+      struct ChainElem *next = ce->next;
+      FREE(&ce->key);
+      FREE(&ce);
+      ce = next;
+    }
+  }
+  FREE(&table->table);
+  FREE(ptr);
+}
+
+/**
+ * bench_keys - Generate Message-ID-like keys
+ * @param num Number of keys
+ * @retval ptr Array of keys
+ */
+static char **bench_keys(int num)
+{
+  char buf[128];
+  char **keys = mutt_mem_calloc(num, sizeof(char *));
+  for (int i = 0; i < num; i++)
+  {
+    snprintf(buf, sizeof(buf), "<20200101%06d.GA%05d@example%d.com>", i, i % 97, i % 13);
+    keys[i] = mutt_str_strdup(buf);
+  }
+  return keys;
+}
+
+/**
+ * bench_chain - Time the old chained Hash table
+ * @param nelem Number of buckets
+ * @param keys  Keys to use
+ * @param num   Number of keys
+ */
+static void bench_chain(size_t nelem, char **keys, int num)
+{
+  int failed = 0;
+
+  struct ChainHash *table = chain_new(nelem);
+
+  uint64_t start = mutt_date_epoch_ms();
+  for (int i = 0; i < num; i++)
+  {
+    if (!chain_insert(table, keys[i], (void *) (intptr_t) (i + 1)))
+      failed++;
+  }
+  uint64_t insert = mutt_date_epoch_ms() - start;
+
+  start = mutt_date_epoch_ms();
+  for (int i = 0; i < num; i++)
+  {
+    if (chain_find(table, keys[i]) != (void *) (intptr_t) (i + 1))
+      failed++;
+  }
+  uint64_t find = mutt_date_epoch_ms() - start;
+
+  start = mutt_date_epoch_ms();
+  for (int i = 0; i < num; i += 2)
+    chain_delete(table, keys[i]);
+  uint64_t del = mutt_date_epoch_ms() - start;
+
+  TEST_CASE_("chained, %zu buckets: insert %llu ms, find %llu ms, delete %llu ms",
+             nelem, (unsigned long long) insert, (unsigned long long) find,
+             (unsigned long long) del);
+  TEST_CHECK(failed == 0);
+
+  chain_free(&table);
+}
+
+/**
+ * bench_hash - Time the open-addressing Hash table
+ * @param nelem Size requested from mutt_hash_new()
+ * @param keys  Keys to use
+ * @param num   Number of keys
+ */
+static void bench_hash(size_t nelem, char **keys, int num)
+{
+  int failed = 0;
+
+  struct Hash *table = mutt_hash_new(nelem, MUTT_HASH_STRDUP_KEYS);
+
+  uint64_t start = mutt_date_epoch_ms();
+  for (int i = 0; i < num; i++)
+  {
+    if (!mutt_hash_insert(table, keys[i], (void *) (intptr_t) (i + 1)))
+      failed++;
+  }
+  uint64_t insert = mutt_date_epoch_ms() - start;
+
+  start = mutt_date_epoch_ms();
+  for (int i = 0; i < num; i++)
+  {
+    if (mutt_hash_find(table, keys[i]) != (void *) (intptr_t) (i + 1))
+      failed++;
+  }
+  uint64_t find = mutt_date_epoch_ms() - start;
+
+  start = mutt_date_epoch_ms();
+  for (int i = 0; i < num; i += 2)
+    mutt_hash_delete(table, keys[i], NULL);
+  uint64_t del = mutt_date_epoch_ms() - start;
+
+  TEST_CASE_("open addressing, %zu requested: insert %llu ms, find %llu ms, delete %llu ms",
+             nelem, (unsigned long long) insert, (unsigned long long) find,
+             (unsigned long long) del);
+  TEST_CHECK(failed == 0);
+  TEST_CHECK(table->count == (size_t) (num / 2));
+
+  mutt_hash_free(&table);
+}
+
+void bench_mutt_hash(void)
+{
+  // Insert, look up and delete many keys in the old and new tables, first
+  // sized for the keys, like the thread hash, then a fixed size, like the
+  // label hash.  The timings are shown with `test/neomutt-bench -v`.
+
+  static const size_t sizes[] = { BENCH_KEYS * 2, 1031 };
+
+  char **keys = bench_keys(BENCH_KEYS);
+
+  for (size_t i = 0; i < mutt_array_size(sizes); i++)
+  {
+    bench_chain(sizes[i], keys, BENCH_KEYS);
+    bench_hash(sizes[i], keys, BENCH_KEYS);
+  }
+
+  for (int i = 0; i < BENCH_KEYS; i++)
+    FREE(&keys[i]);
+  FREE(&keys);
+}
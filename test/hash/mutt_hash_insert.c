@@ -44,4 +44,11 @@ void test_mutt_hash_insert(void)
     TEST_CHECK(mutt_hash_insert(hash, "apple", NULL) != NULL);
     mutt_hash_free(&hash);
   }
+
+  {
+    struct Hash *hash = mutt_hash_new(10, MUTT_HASH_STRDUP_KEYS);
+    TEST_CHECK(mutt_hash_insert(hash, "", "banana") != NULL);
+    TEST_CHECK(mutt_hash_find(hash, "") != NULL);
+    mutt_hash_free(&hash);
+  }
 }
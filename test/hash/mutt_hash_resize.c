@@ -0,0 +1,97 @@
+/**
+ * @file
+ * Test code for growing the Hash table
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdint.h>
+#include <stdio.h>
+#include "mutt/lib.h"
+
+#define RESIZE_KEYS 2000
+
+/**
+ * resize_key - Generate a Message-ID-like key
+ * @param buf    Buffer for the result
+ * @param buflen Length of the buffer
+ * @param i      Number of the key
+ */
+static void resize_key(char *buf, size_t buflen, int i)
+{
+  snprintf(buf, buflen, "<20200101%06d.GA%05d@example%d.com>", i, i % 97, i % 13);
+}
+
+void test_mutt_hash_resize(void)
+{
+  // A table grows as keys are added, and keeps them all through deletions
+
+  char key[128];
+
+  struct Hash *table = mutt_hash_new(16, MUTT_HASH_STRDUP_KEYS);
+  TEST_CHECK(table != NULL);
+
+  int failed = 0;
+  for (int i = 0; i < RESIZE_KEYS; i++)
+  {
+    resize_key(key, sizeof(key), i);
+    if (!mutt_hash_insert(table, key, (void *) (intptr_t) (i + 1)))
+      failed++;
+  }
+  TEST_CHECK(failed == 0);
+  TEST_CHECK(table->count == RESIZE_KEYS);
+  TEST_CHECK((table->count * 4) <= (table->nelem * 3));
+
+  for (int i = 0; i < RESIZE_KEYS; i++)
+  {
+    resize_key(key, sizeof(key), i);
+    if (mutt_hash_find(table, key) != (void *) (intptr_t) (i + 1))
+      failed++;
+  }
+  TEST_CHECK(failed == 0);
+  TEST_CHECK(mutt_hash_find(table, "<missing@example.com>") == NULL);
+
+  resize_key(key, sizeof(key), 42);
+  TEST_CHECK(mutt_hash_insert(table, key, NULL) == NULL);
+
+  for (int i = 0; i < RESIZE_KEYS; i += 2)
+  {
+    resize_key(key, sizeof(key), i);
+    mutt_hash_delete(table, key, NULL);
+  }
+  TEST_CHECK(table->count == (RESIZE_KEYS / 2));
+
+  for (int i = 0; i < RESIZE_KEYS; i++)
+  {
+    resize_key(key, sizeof(key), i);
+    void *expected = (i % 2) ? (void *) (intptr_t) (i + 1) : NULL;
+    if (mutt_hash_find(table, key) != expected)
+      failed++;
+  }
+  TEST_CHECK(failed == 0);
+
+  struct HashWalkState state = { 0 };
+  size_t walked = 0;
+  while (mutt_hash_walk(table, &state))
+    walked++;
+  TEST_CHECK(walked == (RESIZE_KEYS / 2));
+
+  mutt_hash_free(&table);
+  TEST_CHECK(table == NULL);
+}
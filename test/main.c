@@ -65,6 +65,16 @@
   NEOMUTT_TEST_ITEM(test_mutt_addrlist_to_local)                               \
   NEOMUTT_TEST_ITEM(test_mutt_addrlist_write)                                  \
                                                                                \
+  /* arena */                                                                  \
+  NEOMUTT_TEST_ITEM(test_mutt_arena_calloc)                                    \
+  NEOMUTT_TEST_ITEM(test_mutt_arena_current)                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_arena_free)                                      \
+  NEOMUTT_TEST_ITEM(test_mutt_arena_intern)                                    \
+  NEOMUTT_TEST_ITEM(test_mutt_arena_new)                                       \
+  NEOMUTT_TEST_ITEM(test_mutt_arena_owns)                                      \
+  NEOMUTT_TEST_ITEM(test_mutt_arena_strndup)                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_arena_swap)                                      \
+                                                                               \
   /* attach */                                                                 \
   NEOMUTT_TEST_ITEM(test_mutt_actx_add_attach)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_actx_add_body)                                   \
@@ -182,6 +192,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_autocrypthdr_free)                               \
   NEOMUTT_TEST_ITEM(test_mutt_env_cmp_strict)                                  \
   NEOMUTT_TEST_ITEM(test_mutt_env_free)                                        \
+  NEOMUTT_TEST_ITEM(test_mutt_env_load)                                        \
   NEOMUTT_TEST_ITEM(test_mutt_env_merge)                                       \
   NEOMUTT_TEST_ITEM(test_mutt_env_new)                                         \
   NEOMUTT_TEST_ITEM(test_mutt_env_to_intl)                                     \
@@ -273,6 +284,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_hash_int_insert)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_hash_int_new)                                    \
   NEOMUTT_TEST_ITEM(test_mutt_hash_new)                                        \
+  NEOMUTT_TEST_ITEM(test_mutt_hash_resize)                                     \
   NEOMUTT_TEST_ITEM(test_mutt_hash_set_destructor)                             \
   NEOMUTT_TEST_ITEM(test_mutt_hash_typed_insert)                               \
   NEOMUTT_TEST_ITEM(test_mutt_hash_walk)                                       \
@@ -429,6 +441,7 @@
                                                                                \
   /* pattern */                                                                \
   NEOMUTT_TEST_ITEM(test_mutt_pattern_comp)                                    \
+  NEOMUTT_TEST_ITEM(test_mutt_pattern_literal)                                 \
                                                                                \
   /* regex */                                                                  \
   NEOMUTT_TEST_ITEM(test_mutt_regex_capture)                                   \
@@ -528,6 +541,10 @@
   NEOMUTT_TEST_ITEM(test_mutt_str_sysexit)                                     \
   NEOMUTT_TEST_ITEM(test_mutt_str_word_casecmp)                                \
                                                                                \
+  /* strpool */                                                                \
+  NEOMUTT_TEST_ITEM(test_mutt_strpool_get)                                     \
+  NEOMUTT_TEST_ITEM(test_mutt_strpool_getn)                                    \
+                                                                               \
   /* tags */                                                                   \
   NEOMUTT_TEST_ITEM(test_driver_tags_free)                                     \
   NEOMUTT_TEST_ITEM(test_driver_tags_get)                                      \
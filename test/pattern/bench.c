@@ -0,0 +1,130 @@
+/**
+ * @file
+ * Benchmark for literal and regex Patterns
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdio.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "pattern.h"
+
+#define BENCH_EMAILS 20000
+#define BENCH_ROUNDS 10
+
+static const char *BenchWords[] = {
+  "Re:", "meeting", "Apple", "quarterly", "report", "banana", "draft",
+  "Invoice", "schedule", "lunch", "review", "Project", "update", "notes",
+};
+
+/**
+ * bench_count - Count the Emails matching a Pattern
+ * @param str    Pattern to compile
+ * @param emails Emails to match
+ * @param name   Buffer for the test case name
+ * @param namelen Length of the buffer
+ * @retval num Number of matches in each round
+ */
+static int bench_count(const char *str, struct Email **emails, char *name, size_t namelen)
+{
+  struct Buffer err = mutt_buffer_make(256);
+  struct PatternList *pat = mutt_pattern_comp(str, MUTT_PC_NO_FLAGS, &err);
+  mutt_buffer_dealloc(&err);
+  if (!TEST_CHECK(pat != NULL))
+    return -1;
+
+  int count = 0;
+  uint64_t start = mutt_date_epoch_ms();
+  for (int r = 0; r < BENCH_ROUNDS; r++)
+  {
+    count = 0;
+    for (int i = 0; i < BENCH_EMAILS; i++)
+    {
+      if (mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, NULL,
+                            emails[i], NULL) > 0)
+      {
+        count++;
+      }
+    }
+  }
+  snprintf(name, namelen, "%s (%s): %llu ms", str,
+           SLIST_FIRST(pat)->is_literal ? "literal" : "regex",
+           (unsigned long long) (mutt_date_epoch_ms() - start));
+
+  mutt_pattern_free(&pat);
+  return count;
+}
+
+void bench_mutt_pattern(void)
+{
+  // Match plain words against many subjects, as literals and as regexes,
+  // first in ASCII subjects, then with an accented word in each subject.
+  // The timings are shown with `test/neomutt-bench -v`.
+
+  static const char *pairs[][2] = {
+    { "~s banana", "~s banan[a]" },
+    { "~s Apple", "~s Appl[e]" },
+    { "~s project", "~s projec[t]" },
+    { "~s quarterly", "~s quarterl[y]" },
+    { "~s meeting", "~s meetin[g]" },
+    { "~s invoice", "~s invoic[e]" },
+  };
+
+  char name[256];
+  struct Email **emails = mutt_mem_calloc(BENCH_EMAILS, sizeof(struct Email *));
+  const int num_words = mutt_array_size(BenchWords);
+
+  for (int i = 0; i < BENCH_EMAILS; i++)
+  {
+    emails[i] = email_new();
+    emails[i]->env = mutt_env_new();
+  }
+
+  for (int accented = 0; accented < 2; accented++)
+  {
+    for (int i = 0; i < BENCH_EMAILS; i++)
+    {
+      char subject[256] = { 0 };
+      for (int w = 0; w < 8; w++)
+      {
+        mutt_str_strcat(subject, sizeof(subject), BenchWords[(i * 7 + w * (i % 5 + 1)) % num_words]);
+        mutt_str_strcat(subject, sizeof(subject), " ");
+      }
+      if (accented)
+        mutt_str_strcat(subject, sizeof(subject), "caf\xc3\xa9");
+      mutt_str_replace(&emails[i]->env->subject, subject);
+    }
+
+    for (size_t p = 0; p < mutt_array_size(pairs); p++)
+    {
+      int lit = bench_count(pairs[p][0], emails, name, sizeof(name));
+      TEST_CASE_("%s%s", accented ? "accented, " : "", name);
+      int rx = bench_count(pairs[p][1], emails, name, sizeof(name));
+      TEST_CASE_("%s%s", accented ? "accented, " : "", name);
+      TEST_CHECK(lit > 0);
+      TEST_CHECK(lit == rx);
+      TEST_MSG("Literal: %d, Regex: %d", lit, rx);
+    }
+  }
+
+  for (int i = 0; i < BENCH_EMAILS; i++)
+    email_free(&emails[i]);
+  FREE(&emails);
+}
@@ -783,5 +783,84 @@ void test_mutt_pattern_comp(void)
     mutt_pattern_free(&pat);
   }
 
+  { /* cheap patterns are evaluated first */
+    char *s = "=s foo ~F";
+
+    mutt_buffer_reset(&err);
+    struct PatternList *pat = mutt_pattern_comp(s, 0, &err);
+
+    if (!TEST_CHECK(pat != NULL))
+    {
+      TEST_MSG("Expected: pat != NULL");
+      TEST_MSG("Actual  : pat == NULL");
+    }
+
+    struct PatternList expected;
+
+    struct Pattern e[3] = { /* root */
+                            { .op = MUTT_PAT_AND,
+                              .pat_not = false,
+                              .all_addr = false,
+                              .string_match = false,
+                              .group_match = false,
+                              .ign_case = false,
+                              .is_alias = false,
+                              .is_multi = false,
+                              .min = 0,
+                              .max = 0,
+                              .p.str = NULL },
+                            /* root->child */
+                            { .op = MUTT_FLAG,
+                              .pat_not = false,
+                              .all_addr = false,
+                              .string_match = false,
+                              .group_match = false,
+                              .ign_case = false,
+                              .is_alias = false,
+                              .is_multi = false,
+                              .min = 0,
+                              .max = 0,
+                              .p.str = NULL },
+                            /* root->child->next */
+                            { .op = MUTT_PAT_SUBJECT,
+                              .pat_not = false,
+                              .all_addr = false,
+                              .string_match = true,
+                              .group_match = false,
+                              .ign_case = true,
+                              .is_alias = false,
+                              .is_multi = false,
+                              .min = 0,
+                              .max = 0,
+                              .p.str = "foo" }
+    };
+
+    SLIST_INIT(&expected);
+    SLIST_INSERT_HEAD(&expected, &e[0], entries);
+    struct PatternList child;
+    SLIST_INIT(&child);
+    e[0].child = &child;
+    SLIST_INSERT_HEAD(e[0].child, &e[1], entries);
+    SLIST_INSERT_AFTER(&e[1], &e[2], entries);
+
+    if (!TEST_CHECK(!cmp_pattern(pat, &expected)))
+    {
+      char s2[1024];
+      canonical_pattern(s2, &expected, 0);
+      TEST_MSG("Expected:\n%s", s2);
+      canonical_pattern(s2, pat, 0);
+      TEST_MSG("Actual:\n%s", s2);
+    }
+
+    char *msg = "";
+    if (!TEST_CHECK(!strcmp(err.data, msg)))
+    {
+      TEST_MSG("Expected: %s", msg);
+      TEST_MSG("Actual  : %s", err.data);
+    }
+
+    mutt_pattern_free(&pat);
+  }
+
   mutt_buffer_dealloc(&err);
 }
@@ -36,8 +36,12 @@ struct Mailbox;
 struct Message;
 struct Pattern;
 struct Progress;
+struct SearchIndex;
+struct SearchScan;
 struct State;
 
+bool C_SearchIndex = false;
+
 bool g_addr_is_user = false;
 int g_body_parts = 1;
 bool g_is_mail_list = false;
@@ -140,6 +144,31 @@ const char *myvar_get(const char *var)
   return g_myvar;
 }
 
+struct SearchIndex *search_index_new(void)
+{
+  return NULL;
+}
+
+bool search_index_may_match(struct SearchIndex *si, struct Mailbox *m, struct Email *e,
+                            int op, const char *literal, bool icase)
+{
+  return true;
+}
+
+struct SearchScan *search_index_scan_begin(struct SearchIndex *si, struct Mailbox *m,
+                                           struct Email *e, int op)
+{
+  return NULL;
+}
+
+void search_index_scan_text(struct SearchScan *ss, const char *text)
+{
+}
+
+void search_index_scan_end(struct SearchIndex *si, struct SearchScan **ptr, bool complete)
+{
+}
+
 struct Email *mutt_get_virt_email(struct Mailbox *m, int vnum)
 {
   if (!m || !m->emails || !m->v2r)
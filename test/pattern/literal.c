@@ -0,0 +1,160 @@
+/**
+ * @file
+ * Test code for matching plain words as literals
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdbool.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "pattern.h"
+
+#define TEST_EMAILS 200
+
+static const char *TestWords[] = {
+  "Re:", "meeting", "Apple", "quarterly", "report", "banana", "draft",
+  "Invoice", "schedule", "lunch", "review", "Project", "update", "notes",
+};
+
+/**
+ * count_matches - Count the Emails matching a Pattern
+ * @param str     Pattern to compile
+ * @param emails  Emails to match
+ * @param literal Set to true if the Pattern is matched as a literal
+ * @retval num Number of matches
+ */
+static int count_matches(const char *str, struct Email **emails, bool *literal)
+{
+  struct Buffer err = mutt_buffer_make(256);
+  struct PatternList *pat = mutt_pattern_comp(str, MUTT_PC_NO_FLAGS, &err);
+  mutt_buffer_dealloc(&err);
+  if (!TEST_CHECK(pat != NULL))
+    return -1;
+
+  int count = 0;
+  for (int i = 0; i < TEST_EMAILS; i++)
+  {
+    if (mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, NULL,
+                          emails[i], NULL) > 0)
+    {
+      count++;
+    }
+  }
+  *literal = SLIST_FIRST(pat)->is_literal;
+
+  mutt_pattern_free(&pat);
+  return count;
+}
+
+void test_mutt_pattern_literal(void)
+{
+  // Plain words are matched as literals, with the same results as a regex
+
+  static const char *pairs[][2] = {
+    { "~s banana", "~s banan[a]" },
+    { "~s Apple", "~s Appl[e]" },
+    { "~s project", "~s projec[t]" },
+    { "~s quarterly", "~s quarterl[y]" },
+  };
+
+  struct Email **emails = mutt_mem_calloc(TEST_EMAILS, sizeof(struct Email *));
+  const int num_words = mutt_array_size(TestWords);
+
+  for (int i = 0; i < TEST_EMAILS; i++)
+  {
+    char subject[256] = { 0 };
+    for (int w = 0; w < 8; w++)
+    {
+      mutt_str_strcat(subject, sizeof(subject), TestWords[(i * 7 + w * (i % 5 + 1)) % num_words]);
+      mutt_str_strcat(subject, sizeof(subject), " ");
+    }
+    emails[i] = email_new();
+    emails[i]->env = mutt_env_new();
+    emails[i]->env->subject = mutt_str_strdup(subject);
+  }
+
+  for (size_t p = 0; p < mutt_array_size(pairs); p++)
+  {
+    TEST_CASE(pairs[p][0]);
+    bool lit_literal = false;
+    bool rx_literal = true;
+    int lit = count_matches(pairs[p][0], emails, &lit_literal);
+    int rx = count_matches(pairs[p][1], emails, &rx_literal);
+    TEST_CHECK(lit_literal);
+    TEST_CHECK(!rx_literal);
+    TEST_CHECK(lit > 0);
+    TEST_CHECK(lit == rx);
+    TEST_MSG("Literal: %d, Regex: %d", lit, rx);
+  }
+
+  // Only ASCII patterns are literals when the case is ignored
+  static const char *types[][2] = {
+    { "~s kiwi", "literal" },
+    { "~s Kiwi", "literal" },
+    { "~s café", "regex" },
+    { "~s Café", "literal" },
+  };
+  for (size_t p = 0; p < mutt_array_size(types); p++)
+  {
+    struct Buffer err = mutt_buffer_make(256);
+    struct PatternList *pat = mutt_pattern_comp(types[p][0], MUTT_PC_NO_FLAGS, &err);
+    mutt_buffer_dealloc(&err);
+    TEST_CASE(types[p][0]);
+    if (!TEST_CHECK(pat != NULL))
+      continue;
+    const char *type = SLIST_FIRST(pat)->is_literal ? "literal" : "regex";
+    TEST_CHECK(mutt_str_strcmp(type, types[p][1]) == 0);
+    TEST_MSG("Expected: %s", types[p][1]);
+    TEST_MSG("Actual  : %s", type);
+    mutt_pattern_free(&pat);
+  }
+
+  // Non-ASCII text is left to the regex, which may fold some characters to
+  // ASCII letters, e.g. the Kelvin sign to 'k'
+  static const char *subjects[] = {
+    "kiwi tart", "KIWI TART", "\xe2\x84\xaaiwi tart", "caf\xc3\xa9 kiwi", "tart",
+  };
+  for (int i = 0; i < TEST_EMAILS; i++)
+  {
+    FREE(&emails[i]->env->subject);
+    emails[i]->env->subject = mutt_str_strdup(subjects[i % mutt_array_size(subjects)]);
+  }
+
+  static const char *folded[][2] = {
+    { "~s kiwi", "~s kiw[i]" },
+    { "~s tart", "~s tar[t]" },
+  };
+  for (size_t p = 0; p < mutt_array_size(folded); p++)
+  {
+    TEST_CASE(folded[p][0]);
+    bool lit_literal = false;
+    bool rx_literal = true;
+    int lit = count_matches(folded[p][0], emails, &lit_literal);
+    int rx = count_matches(folded[p][1], emails, &rx_literal);
+    TEST_CHECK(lit_literal);
+    TEST_CHECK(lit > 0);
+    TEST_CHECK(lit == rx);
+    TEST_MSG("Literal: %d, Regex: %d", lit, rx);
+  }
+
+  for (int i = 0; i < TEST_EMAILS; i++)
+    email_free(&emails[i]);
+  FREE(&emails);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file
+ * Test code for mutt_strpool_get()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_strpool_get(void)
+{
+  // char *mutt_strpool_get(const char *str);
+
+  {
+    TEST_CHECK(mutt_strpool_get(NULL) == NULL);
+  }
+
+  {
+    TEST_CHECK(mutt_strpool_get("") == NULL);
+  }
+
+  {
+    char *a = mutt_strpool_get("apple@example.com");
+    char *b = mutt_strpool_get("apple@example.com");
+    char *c = mutt_strpool_get("banana@example.com");
+    TEST_CHECK(mutt_str_strcmp(a, "apple@example.com") == 0);
+    TEST_CHECK(mutt_str_strcmp(c, "banana@example.com") == 0);
+    TEST_CHECK(a == b);
+    TEST_CHECK(a != c);
+
+    // Pooling a pooled string just adds a reference
+    char *d = mutt_strpool_get(a);
+    TEST_CHECK(d == a);
+
+    FREE(&a);
+    FREE(&b);
+    TEST_CHECK(a == NULL);
+    TEST_CHECK(mutt_str_strcmp(d, "apple@example.com") == 0);
+    FREE(&d);
+    FREE(&c);
+  }
+
+  {
+    // Replacing a pooled string moves it to the heap
+    char *a = mutt_strpool_get("cherry");
+    char *b = mutt_strpool_get("cherry");
+    mutt_str_replace(&a, "damson");
+    TEST_CHECK(mutt_str_strcmp(a, "damson") == 0);
+    TEST_CHECK(mutt_str_strcmp(b, "cherry") == 0);
+    mutt_mem_realloc(&b, 64);
+    TEST_CHECK(mutt_str_strcmp(b, "cherry") == 0);
+    FREE(&a);
+    FREE(&b);
+  }
+}
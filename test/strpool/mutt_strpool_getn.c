@@ -0,0 +1,63 @@
+/**
+ * @file
+ * Test code for mutt_strpool_getn()
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <string.h>
+#include "mutt/lib.h"
+
+void test_mutt_strpool_getn(void)
+{
+  // char *mutt_strpool_getn(const char *str, size_t len);
+
+  {
+    TEST_CHECK(mutt_strpool_getn(NULL, 10) == NULL);
+  }
+
+  {
+    // An empty string gives NULL, the same as mutt_strpool_get("")
+    TEST_CHECK(mutt_strpool_getn("", 0) == NULL);
+    TEST_CHECK(mutt_strpool_getn("apple", 0) == NULL);
+    TEST_CHECK(mutt_strpool_getn("", 0) == mutt_strpool_get(""));
+  }
+
+  {
+    char *a = mutt_strpool_getn("apple banana", 5);
+    char *b = mutt_strpool_get("apple");
+    TEST_CHECK(mutt_str_strcmp(a, "apple") == 0);
+    TEST_CHECK(a == b);
+    FREE(&a);
+    FREE(&b);
+  }
+
+  {
+    // Long strings aren't pooled
+    char buf[1024];
+    memset(buf, 'x', sizeof(buf));
+    char *a = mutt_strpool_getn(buf, sizeof(buf));
+    char *b = mutt_strpool_getn(buf, sizeof(buf));
+    TEST_CHECK(a != b);
+    TEST_CHECK(mutt_str_strlen(a) == sizeof(buf));
+    TEST_CHECK(mutt_arena_owns(a) == 0);
+    FREE(&a);
+    FREE(&b);
+  }
+}
@@ -0,0 +1,180 @@
+/**
+ * @file
+ * Benchmark for sorting threads
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdint.h>
+#include <stdio.h>
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "context.h"
+#include "globals.h"
+#include "mutt_thread.h"
+#include "options.h"
+#include "sort.h"
+
+#define BENCH_EMAILS 1000000
+#define BENCH_THREAD 10
+
+static const char *BenchNames[] = {
+  "Alice Smith", "bob", "Carol Jones", "Dave", "Eve Brown", "frank", "Grace Hall",
+};
+
+/**
+ * bench_rand - Generate a repeatable pseudo-random number
+ * @param seed Generator state
+ * @retval num Next number
+ */
+static unsigned int bench_rand(uint64_t *seed)
+{
+  *seed = (*seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+  return (unsigned int) (*seed >> 33);
+}
+
+/**
+ * bench_address - Create an Address
+ * @param al   AddressList to add to
+ * @param seed Generator state
+ */
+static void bench_address(struct AddressList *al, uint64_t *seed)
+{
+  char buf[128];
+  const unsigned int n = bench_rand(seed) % 1000;
+  struct Address *a = mutt_addr_new();
+  a->personal = mutt_str_strdup(BenchNames[n % mutt_array_size(BenchNames)]);
+  snprintf(buf, sizeof(buf), "user%u@example.com", n);
+  a->mailbox = mutt_str_strdup(buf);
+  mutt_addrlist_append(al, a);
+}
+
+/**
+ * bench_mailbox - Create a Mailbox of threaded Emails
+ * @param num Number of Emails
+ * @retval ptr New Mailbox
+ *
+ * Each thread has up to #BENCH_THREAD Emails, each replying to an earlier
+ * Email of the same thread.
+ */
+static struct Mailbox *bench_mailbox(int num)
+{
+  char buf[128];
+  uint64_t seed = 42;
+
+  struct Mailbox *m = mailbox_new();
+  m->verbose = false;
+  m->email_max = num;
+  m->emails = mutt_mem_calloc(num, sizeof(struct Email *));
+  m->v2r = mutt_mem_calloc(num, sizeof(int));
+
+  for (int i = 0; i < num; i++)
+  {
+    struct Email *e = email_new();
+    e->index = i;
+    e->env = mutt_env_new();
+    e->content = mutt_body_new();
+    e->content->length = bench_rand(&seed) % 100000;
+    e->date_sent = 1577836800 + (bench_rand(&seed) % 31536000);
+    e->received = e->date_sent + (bench_rand(&seed) % 3600);
+
+    snprintf(buf, sizeof(buf), "<%d.bench@example.com>", i);
+    e->env->message_id = mutt_str_strdup(buf);
+
+    const int root = i - (i % BENCH_THREAD);
+    if (i == root)
+    {
+      snprintf(buf, sizeof(buf), "Topic %u", bench_rand(&seed) % 50000);
+    }
+    else
+    {
+      const int parent = root + (bench_rand(&seed) % (i - root));
+      snprintf(buf, sizeof(buf), "<%d.bench@example.com>", parent);
+      mutt_list_insert_head(&e->env->references, mutt_str_strdup(buf));
+      snprintf(buf, sizeof(buf), "Re: %s", m->emails[root]->env->real_subj);
+    }
+    e->env->subject = mutt_str_strdup(buf);
+    e->env->real_subj = e->env->subject + ((i == root) ? 0 : 4);
+
+    bench_address(&e->env->from, &seed);
+    bench_address(&e->env->to, &seed);
+
+    m->emails[i] = e;
+    m->msg_count++;
+  }
+
+  return m;
+}
+
+/**
+ * bench_sort - Time threading and resorting a Mailbox
+ * @param ctx Mailbox
+ * @param aux Value of $sort_aux
+ * @param name Name of $sort_aux
+ */
+static void bench_sort(struct Context *ctx, short aux, const char *name)
+{
+  C_Sort = SORT_THREADS;
+  C_SortAux = aux;
+
+  uint64_t start = mutt_date_epoch_ms();
+  mutt_sort_headers(ctx, true);
+  uint64_t thread = mutt_date_epoch_ms() - start;
+
+  // Changing $sort_aux only resorts the siblings
+  OptSortSubthreads = true;
+  start = mutt_date_epoch_ms();
+  mutt_sort_headers(ctx, false);
+  uint64_t resort = mutt_date_epoch_ms() - start;
+
+  TEST_CASE_("threads, $sort_aux=%s: thread %llu ms, resort %llu ms", name,
+             (unsigned long long) thread, (unsigned long long) resort);
+  TEST_CHECK(ctx->tree != NULL);
+  TEST_CHECK(ctx->mailbox->vcount == ctx->mailbox->msg_count);
+}
+
+void bench_mutt_sort_threads(void)
+{
+  // Thread a large Mailbox and resort its siblings by each $sort_aux that
+  // gets a sort key.  The timings are shown with `test/neomutt-bench -v`.
+
+  static const struct Mapping methods[] = {
+    { "date", SORT_DATE },         { "date-received", SORT_RECEIVED },
+    { "size", SORT_SIZE },         { "subject", SORT_SUBJECT },
+    { "from", SORT_FROM },         { "to", SORT_TO },
+    { "reverse-date", SORT_DATE | SORT_REVERSE },
+  };
+
+  struct Mailbox *m = bench_mailbox(BENCH_EMAILS);
+  struct Context ctx = { 0 };
+  ctx.mailbox = m;
+
+  for (size_t i = 0; i < mutt_array_size(methods); i++)
+  {
+    bench_sort(&ctx, methods[i].value, methods[i].name);
+    mutt_clear_threads(&ctx);
+  }
+
+  for (int i = 0; i < m->msg_count; i++)
+    email_free(&m->emails[i]);
+  m->msg_count = 0;
+  mailbox_free(&m);
+}
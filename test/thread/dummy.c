@@ -0,0 +1,41 @@
+/**
+ * @file
+ * Stubs for the threading benchmark
+ *
+ * @authors
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+struct Address;
+struct Email;
+struct Mailbox;
+
+struct Address *alias_reverse_lookup(const struct Address *addr)
+{
+  return NULL;
+}
+
+void mutt_score_message(struct Mailbox *m, struct Email *e, bool upd_mbox)
+{
+}
+
+int nntp_compare_order(const void *a, const void *b)
+{
+  return 0;
+}
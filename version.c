@@ -299,6 +299,11 @@ static struct CompileOptions comp_opts[] = {
 #ifndef HAVE_PCRE2
   { "regex", 1 },
 #endif
+#ifdef USE_PTHREAD
+  { "pthread", 1 },
+#else
+  { "pthread", 0 },
+#endif
 #ifdef USE_SASL
   { "sasl", 1 },
 #else